@@ -1,15 +1,35 @@
 #include "Application.hpp"
 
+#include <pthread.h>
+#include <signal.h>
+
 #include <cstdio>
 
+#include <atomic>
+#include <chrono>
 #include <fstream>
 #include <filesystem>
+#include <functional>
+#include <iostream>
+#include <thread>
 
 #include <spdlog/spdlog.h>
 #include <opencv2/opencv.hpp>
 #include <nlohmann/json.hpp>
 
+#include "BatchProcessor.hpp"
+#include "DetectionServer.hpp"
+#include "DetectorsCache.hpp"
+#include "decoding.hpp"
 #include "PepsiDetector.hpp"
+#include "ShmRing.hpp"
+#include "StreamProcessor.hpp"
+#include "TrackingDetector.hpp"
+#include "drawing.hpp"
+#include "imglog.hpp"
+#include "results.hpp"
+#include "stats.hpp"
+#include "trace.hpp"
 
 namespace fs = std::filesystem;
 
@@ -28,14 +48,6 @@ cv::Mat read_image(const std::string& src_file, int flags)
 	return img;
 }
 
-void draw_logos(cv::Mat& dst, const Logos& logos)
-{
-	for(const auto& logo : logos)
-	{
-		cv::rectangle(dst, logo, cv::Scalar{0, 255, 0});
-	}
-}
-
 void write_image(const std::string& dst_file, const cv::Mat& img)
 {
 	assert(!dst_file.empty());
@@ -74,6 +86,186 @@ std::string get_config_file_path(const std::string& src_file)
 	return config_file_path.string();
 }
 
+/**
+ * @brief Writes results of single image as JSON line, same as in batch mode. Path "-" denotes stdout
+ */
+void write_results(const std::string& output_file, const std::string& src_file,
+                   const Detections& detections, bool parts)
+{
+	auto json = nlohmann::json{
+		{"file", src_file},
+		{"logos", format_logos(detections)},
+	};
+
+	if(parts)
+	{
+		json["parts"] = format_parts(detections);
+	}
+
+	if(output_file == "-")
+	{
+		std::cout << json.dump() << std::endl;
+		return;
+	}
+
+	auto ofs = std::ofstream(output_file);
+	if(!(ofs << json.dump() << '\n'))
+	{
+		throw std::runtime_error("Could not write results file");
+	}
+}
+
+double to_milliseconds(StageTime time)
+{
+	return std::chrono::duration<double, std::milli>(time).count();
+}
+
+void log_blobs_funnel(const char* color, const BlobsFunnel& funnel)
+{
+	spdlog::info(" {} blobs: {} found, {} after area filter, {} after hu filter",
+	             color, funnel.found, funnel.after_area_filter, funnel.after_hu_filter);
+}
+
+void log_cascade_exits(const CascadeExits& exits)
+{
+	spdlog::info(" Stopped early {} times after blue, {} times after red blobs", exits.after_blue, exits.after_red);
+}
+
+void log_part_windows(const PartWindows& windows)
+{
+	if(windows.runs > 0)
+	{
+		const auto coverage = (windows.frame_pixels > 0)
+			? (100.0 * windows.pixels / windows.frame_pixels)
+			: 0.0;
+		spdlog::info(" Second part looked for in {} windows ({:.1f}% of frames), {} whole frame fallbacks",
+		             windows.windows, coverage, windows.fallbacks);
+	}
+}
+
+void log_precheck(const PrecheckStats& precheck)
+{
+	if(precheck.runs > 0)
+	{
+		spdlog::info(" Precheck rejected {} of {} images", precheck.rejections, precheck.runs);
+	}
+}
+
+void log_coarse_passes(const CoarsePasses& coarse)
+{
+	if(coarse.runs > 0)
+	{
+		spdlog::info(" Coarse passes took {:.3f} ms, found {} candidate regions in {} runs",
+		             to_milliseconds(coarse.time), coarse.regions, coarse.runs);
+	}
+}
+
+void log_detection_stats(const DetectionStats& stats)
+{
+	spdlog::info("Detection took {:.3f} ms:", to_milliseconds(stats.total_time));
+	for(auto i = 0; i < StagesMax; ++i)
+	{
+		const auto stage = static_cast<Stage>(i);
+		spdlog::info(" {:<12} {:8.3f} ms", get_stage_name(stage), to_milliseconds(stats.stage_time(stage)));
+	}
+
+	log_blobs_funnel("Blue", stats.blue_blobs);
+	log_blobs_funnel("Red", stats.red_blobs);
+	spdlog::info(" {} pairs tested, {} logos found", stats.pairs_tested, stats.logos_found);
+	log_cascade_exits(stats.cascade_exits);
+	log_part_windows(stats.part_windows);
+	log_precheck(stats.precheck);
+	log_coarse_passes(stats.coarse);
+}
+
+void log_cache_stats(const ResultCache* cache)
+{
+	if(cache)
+	{
+		const auto stats = cache->stats();
+		spdlog::info("Results cache: {} hits ({} from disk), {} misses, {} entries in memory",
+		             stats.hits, stats.disk_hits, stats.misses, stats.entries);
+	}
+}
+
+void log_time_summary(const char* name, const TimeSummary& summary)
+{
+	spdlog::info(" {:<12} min {:8.3f} ms, mean {:8.3f} ms, p99 {:8.3f} ms", name,
+	             to_milliseconds(summary.min), to_milliseconds(summary.mean), to_milliseconds(summary.p99));
+}
+
+void log_aggregated_stats(const DetectionStatsAggregator& aggregator)
+{
+	spdlog::info("Detection statistics of {} frames:", aggregator.count());
+	for(auto i = 0; i < StagesMax; ++i)
+	{
+		const auto stage = static_cast<Stage>(i);
+		log_time_summary(get_stage_name(stage), aggregator.summarize_stage(stage));
+	}
+	log_time_summary("total", aggregator.summarize_total());
+
+	const auto sum = aggregator.sum();
+	log_blobs_funnel("Blue", sum.blue_blobs);
+	log_blobs_funnel("Red", sum.red_blobs);
+	spdlog::info(" {} pairs tested, {} logos found", sum.pairs_tested, sum.logos_found);
+	log_cascade_exits(sum.cascade_exits);
+	log_part_windows(sum.part_windows);
+	log_precheck(sum.precheck);
+	log_coarse_passes(sum.coarse);
+}
+
+/**
+ * @brief Calls given callback on SIGINT or SIGTERM
+ * Signals are awaited on dedicated thread, so callback is not limited like signal handlers are.
+ */
+class StopSignalWatcher
+{
+public:
+	explicit StopSignalWatcher(std::function<void()> on_stop)
+		:	m_finished{false}
+	{
+		sigemptyset(&m_signals);
+		sigaddset(&m_signals, SIGINT);
+		sigaddset(&m_signals, SIGTERM);
+
+		// Threads started later inherit the mask, so signals are delivered only by sigwait.
+		//  Threads started earlier must have blocked them already (main does so for modes using watcher)
+		pthread_sigmask(SIG_BLOCK, &m_signals, nullptr);
+
+		m_thread = std::thread(
+			[this, on_stop = std::move(on_stop)]()
+			{
+				auto signal = 0;
+				sigwait(&m_signals, &signal);
+				if(!m_finished.exchange(true))
+				{
+					spdlog::info("Received signal {}", signal);
+					on_stop();
+				}
+			});
+	}
+
+	~StopSignalWatcher()
+	{
+		if(!m_finished.exchange(true))
+		{
+			// Wakes the thread, if it has not received any signal yet
+			pthread_kill(m_thread.native_handle(), SIGTERM);
+		}
+
+		// Signals stay blocked, so one more pending signal is not delivered with default action
+		m_thread.join();
+	}
+
+	StopSignalWatcher(const StopSignalWatcher&) = delete;
+	StopSignalWatcher& operator=(const StopSignalWatcher&) = delete;
+
+private:
+	sigset_t m_signals;
+	std::atomic<bool> m_finished;
+	std::thread m_thread;
+};
+
 } // namespace
 
 Application::Application(Options options)
@@ -84,18 +276,55 @@ Application::Application(Options options)
 
 int Application::exec()
 {
-    spdlog::info("Reading input image...");
-    const auto src_img = read_image(m_options.src_file, cv::IMREAD_COLOR);
+	if(!m_options.video_src.empty())
+	{
+		return exec_stream();
+	}
+
+	if(!m_options.batch_inputs.empty() || !m_options.manifest_file.empty())
+	{
+		return exec_batch();
+	}
+
+	if(!m_options.serve.empty())
+	{
+		return exec_serve();
+	}
+
+	if(!m_options.shm.empty())
+	{
+		return exec_shm();
+	}
+
+	return exec_image();
+}
+
+PepsiDetector::Config Application::load_config(const std::string& src_file) const
+{
+	return make_config(locate_config(src_file));
+}
 
+std::string Application::locate_config(const std::string& src_file) const
+{
 	auto config_file = m_options.config_file;
 	if(config_file.empty())
 	{
 		spdlog::info("Locating config file...");
-		config_file = get_config_file_path(m_options.src_file);
+		config_file = get_config_file_path(src_file);
+	}
+
+	if(fs::exists(config_file) && fs::is_regular_file(config_file))
+	{
+		return config_file;
 	}
 
-	const auto config = [this, &config_file]() {
-		if(fs::exists(config_file) && fs::is_regular_file(config_file))
+	return std::string();
+}
+
+PepsiDetector::Config Application::make_config(const std::string& config_file) const
+{
+	auto config = [&config_file]() {
+		if(!config_file.empty())
 		{
 			spdlog::info("Reading config file...");
 			return read_config(config_file);
@@ -105,33 +334,297 @@ int Application::exec()
 		return PepsiDetector::Config{};
 	}();
 
+	if(m_options.pyramid)
+	{
+		config.pyramid = true;
+	}
+
+	if(!m_options.precheck.empty())
+	{
+		config.precheck = parse_precheck_mode(m_options.precheck);
+	}
+
+	if(m_options.reduce > 1)
+	{
+		// Images are decoded downsampled, so sizes and distances have to match them
+		config = config.scaled(1.0 / m_options.reduce);
+	}
+
+	return config;
+}
+
+std::unique_ptr<ResultCache> Application::make_result_cache() const
+{
+	if(m_options.cache_size == 0 && m_options.cache_dir.empty())
+	{
+		return nullptr;
+	}
+
+	auto cache_options = ResultCache::Options{};
+	if(m_options.cache_size > 0)
+	{
+		cache_options.capacity = m_options.cache_size;
+	}
+	cache_options.directory = m_options.cache_dir;
+	return std::make_unique<ResultCache>(cache_options);
+}
+
+int Application::exec_image()
+{
+    spdlog::info("Reading input image...");
+    auto src_img = [this]() {
+        const auto span = trace::Span{"read"};
+        return read_image(m_options.src_file, get_decode_flags(m_options.reduce));
+    }();
+
+	const auto config = load_config(m_options.src_file);
+
 	spdlog::info("Creating pepsi detector...");
     auto detector = PepsiDetector{config};
 
     spdlog::info("Finding pepsi logos...");
-    const auto logos = detector.find_logos(src_img);
+    auto stats = DetectionStats{};
+    const auto detections = [this, &detector, &src_img, &stats]() {
+        const auto span = trace::Span{"detect"};
+        return m_options.stats
+            ? detector.find_detections(src_img, stats)
+            : detector.find_detections(src_img);
+    }();
 
-    spdlog::info("Found {} pepsi logos:", logos.size());
-    for(const auto& logo : logos)
+    // Logos are reported in full resolution coordinates, but drawn on decoded image
+    const auto scaled = scale_detections(detections, m_options.reduce);
+    spdlog::info("Found {} pepsi logos:", scaled.size());
+    for(const auto& detection : scaled)
     {
+    	const auto& logo = detection.logo;
     	spdlog::info(" ({}, {}, {}, {})", logo.x, logo.y, logo.width, logo.height);
     }
 
+    if(m_options.stats)
+    {
+    	log_detection_stats(stats);
+    }
+
+    if(!m_options.output_file.empty())
+    {
+        spdlog::info("Writing results...");
+        write_results(m_options.output_file, m_options.src_file, scaled, m_options.parts);
+
+        if(m_options.dst_file.empty())
+        {
+            // Only results were requested, so image is neither drawn nor encoded
+            spdlog::info("Finished");
+            return 0;
+        }
+    }
+
+    // Input image is not needed anymore, so logos are drawn on it in place
     spdlog::info("Drawing logos on output image...");
-    auto dst_img = src_img.clone();
-    draw_logos(dst_img, logos);
+    {
+        const auto span = trace::Span{"draw"};
+        draw_logos(src_img, to_logos(detections));
+    }
 
     if(m_options.dst_file.empty())
     {
-	    cv::imshow("Output image", dst_img);
+	    cv::imshow("Output image", src_img);
 	    cv::waitKey(0);
     }
     else
     {
 	    spdlog::info("Writing output image...");
-	    write_image(m_options.dst_file, dst_img);
+	    const auto span = trace::Span{"write"};
+	    write_image(m_options.dst_file, src_img);
     }
 
     spdlog::info("Finished");
     return 0;
 }
+
+int Application::exec_stream()
+{
+	const auto config = load_config(m_options.video_src);
+
+	spdlog::info("Creating pepsi detector...");
+	const auto detector = PepsiDetector{config};
+
+	auto tracking_config = TrackingDetector::Config{};
+	tracking_config.keyframe_interval = m_options.keyframe_interval;
+	auto tracker = TrackingDetector{detector, tracking_config};
+
+	auto processed_pixels = std::size_t{0};
+	auto total_pixels = std::size_t{0};
+	auto aggregator = DetectionStatsAggregator{};
+
+	auto stream_options = StreamProcessor::Options{};
+	stream_options.src = m_options.video_src;
+	stream_options.dst = m_options.dst_file;
+	stream_options.queue_size = m_options.queue_size;
+
+	auto processor = StreamProcessor{stream_options,
+		[this, &detector, &tracker, &processed_pixels, &total_pixels, &aggregator](const cv::Mat& frame)
+		{
+			imglog::begin_frame();
+
+			if(!m_options.track)
+			{
+				if(!m_options.stats)
+				{
+					return detector.find_logos(frame);
+				}
+
+				auto stats = DetectionStats{};
+				auto logos = detector.find_logos(frame, stats);
+				aggregator.add(stats);
+				return logos;
+			}
+
+			auto logos = tracker.find_logos(frame);
+			const auto& stats = tracker.last_frame_stats();
+			processed_pixels += stats.processed_pixels;
+			total_pixels += stats.total_pixels;
+			return logos;
+		}};
+
+	spdlog::info("Processing video stream...");
+	const auto stats = processor.run();
+
+	spdlog::info("Processed {} frames in {:.2f} s ({:.1f} fps)",
+	             stats.frames, stats.seconds, stats.fps);
+	if(m_options.track && total_pixels > 0)
+	{
+		spdlog::info("Tracking processed {:.1f}% of pixels",
+		             (100.0 * processed_pixels) / total_pixels);
+	}
+
+	if(aggregator.count() > 0)
+	{
+		log_aggregated_stats(aggregator);
+	}
+
+	spdlog::info("Finished");
+	return 0;
+}
+
+int Application::exec_batch()
+{
+	auto batch_options = BatchProcessor::Options{};
+	batch_options.inputs = m_options.batch_inputs;
+	batch_options.manifest = m_options.manifest_file;
+	batch_options.dst_dir = m_options.dst_file;
+	batch_options.output_file = m_options.output_file;
+	batch_options.format = m_options.output_format;
+	batch_options.workers = m_options.workers;
+	batch_options.read_ahead = m_options.read_ahead;
+	batch_options.reduce = m_options.reduce;
+	batch_options.parts = m_options.parts;
+	batch_options.annotators = m_options.annotators;
+
+	const auto results_cache = make_result_cache();
+	auto processor = BatchProcessor{batch_options,
+		[this](const std::string& src_file) { return locate_config(src_file); },
+		[this](const std::string& config_file) { return PepsiDetector{make_config(config_file)}; },
+		results_cache.get()};
+
+	spdlog::info("Processing images with {} workers...", batch_options.workers);
+	const auto stats = processor.run();
+
+	spdlog::info("Processed {} images in {:.2f} s ({:.1f} images/s), {} failed, {} logos found",
+	             stats.files, stats.seconds, stats.files_per_second, stats.failed, stats.logos);
+	log_cache_stats(results_cache.get());
+	return (stats.failed == 0) ? 0 : -1;
+}
+
+int Application::exec_serve()
+{
+	auto detectors = DetectorsCache{
+		[this](const std::string& src_file) { return locate_config(src_file); },
+		[this](const std::string& config_file) { return PepsiDetector{make_config(config_file)}; }};
+
+	auto server_options = DetectionServer::Options{};
+	server_options.workers = m_options.workers;
+	server_options.queue_size = m_options.read_ahead;
+	server_options.default_config = m_options.config_file;
+	server_options.reduce = m_options.reduce;
+
+	// Default detector is created upfront, so invalid config is reported before serving
+	spdlog::info("Creating pepsi detector...");
+	detectors.get_for_config(server_options.default_config);
+
+	const auto results_cache = make_result_cache();
+	auto server = DetectionServer{server_options, detectors, results_cache.get()};
+	if(m_options.serve == "-")
+	{
+		spdlog::info("Serving requests from stdin with {} workers...", server_options.workers);
+		server.serve_stream(std::cin, std::cout);
+	}
+	else
+	{
+		spdlog::info("Serving requests with {} workers...", server_options.workers);
+		const auto watcher = StopSignalWatcher{[&server]() { server.stop(); }};
+		server.serve_socket(m_options.serve);
+	}
+
+	log_cache_stats(results_cache.get());
+	spdlog::info("Finished");
+	return 0;
+}
+
+int Application::exec_shm()
+{
+	const auto config = make_config(m_options.config_file);
+
+	spdlog::info("Creating pepsi detector...");
+	const auto detector = PepsiDetector{config};
+
+	spdlog::info("Attaching to shared memory {}...", m_options.shm);
+	auto ring = ShmRing{m_options.shm};
+	const auto watcher = StopSignalWatcher{[&ring]() { ring.stop(); }};
+
+	auto frames = std::size_t{0};
+	auto aggregator = DetectionStatsAggregator{};
+	const auto start = std::chrono::steady_clock::now();
+	const auto elapsed_seconds = [&start]() {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	};
+
+	spdlog::info("Processing frames from {} slots of {}x{}...",
+	             ring.slots(), ring.frame_size().width, ring.frame_size().height);
+	while(const auto frame = ring.wait_frame())
+	{
+		imglog::begin_frame();
+
+		// Frame refers to slot memory, so it is detected in place, without copying
+		auto logos = Logos();
+		if(m_options.stats)
+		{
+			auto stats = DetectionStats{};
+			logos = detector.find_logos(frame->img, stats);
+			aggregator.add(stats);
+		}
+		else
+		{
+			logos = detector.find_logos(frame->img);
+		}
+
+		ring.publish_result(logos);
+
+		++frames;
+		if(frames % 100 == 0)
+		{
+			spdlog::info("Processed {} frames ({:.1f} fps)", frames, frames / elapsed_seconds());
+		}
+	}
+
+	const auto seconds = elapsed_seconds();
+	spdlog::info("Processed {} frames in {:.2f} s ({:.1f} fps)",
+	             frames, seconds, (seconds > 0.0) ? (frames / seconds) : 0.0);
+
+	if(aggregator.count() > 0)
+	{
+		log_aggregated_stats(aggregator);
+	}
+
+	spdlog::info("Finished");
+	return 0;
+}
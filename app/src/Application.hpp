@@ -1,6 +1,13 @@
 #pragma once
 
+#include <cstddef>
+
+#include <memory>
 #include <string>
+#include <vector>
+
+#include "PepsiDetector.hpp"
+#include "ResultCache.hpp"
 
 class Application
 {
@@ -10,6 +17,29 @@ public:
 		std::string src_file;
 		std::string dst_file;
 		std::string config_file;
+		bool pyramid = false;
+		std::string precheck; // If not empty, overrides precheck mode from config
+		int reduce = 1; // Images are decoded downsampled by this factor
+		bool stats = false;
+		std::string video_src;
+		std::size_t queue_size = 4;
+		bool track = false;
+		int keyframe_interval = 30;
+		std::string dump_dir;
+		int dump_every = 1;
+		std::string trace_file;
+		std::vector<std::string> batch_inputs;
+		std::string manifest_file;
+		std::string output_file;
+		std::string output_format = "ndjson";
+		bool parts = false;
+		std::size_t annotators = 2;
+		std::size_t workers = 1;
+		std::size_t read_ahead = 16;
+		std::string serve; // Socket path, or "-" for stdin
+		std::string shm; // Name of shared memory rings to attach to
+		std::size_t cache_size = 0; // Results of that many images are cached in memory, 0 disables cache
+		std::string cache_dir; // If not empty, cached results are stored there too
 	};
 
 	Application(Options options);
@@ -17,5 +47,23 @@ public:
 	int exec();
 
 private:
+	int exec_image();
+
+	int exec_stream();
+
+	int exec_batch();
+
+	int exec_serve();
+
+	int exec_shm();
+
+	PepsiDetector::Config load_config(const std::string& src_file) const;
+
+	std::string locate_config(const std::string& src_file) const;
+
+	PepsiDetector::Config make_config(const std::string& config_file) const;
+
+	std::unique_ptr<ResultCache> make_result_cache() const;
+
 	Options m_options;
 };
@@ -0,0 +1,508 @@
+#include "BatchProcessor.hpp"
+
+#include <fnmatch.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <thread>
+
+#include <spdlog/spdlog.h>
+#include <opencv2/opencv.hpp>
+#include <nlohmann/json.hpp>
+
+#include "BoundedQueue.hpp"
+#include "DetectorsCache.hpp"
+#include "decoding.hpp"
+#include "drawing.hpp"
+#include "frame.hpp"
+#include "hash.hpp"
+#include "imglog.hpp"
+#include "results.hpp"
+#include "trace.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct BatchFile
+{
+	fs::path path;
+	fs::path name; // Relative path of annotated image in output directory
+};
+
+struct BatchImage
+{
+	BatchFile file;
+	cv::Mat img; // Empty, if cached detections are not annotated
+	double read_ms = 0.0;
+	std::string error;
+	std::optional<ResultCache::Key> key;
+	std::optional<Detections> cached; // In coordinates of decoded image
+};
+
+struct BatchResult
+{
+	fs::path path;
+	Detections detections; // In full resolution coordinates
+	double read_ms = 0.0;
+	double detect_ms = 0.0;
+	std::string error;
+	bool cached = false;
+};
+
+struct BatchAnnotation
+{
+	BatchResult result;
+	cv::Mat img;
+	Logos logos; // In coordinates of decoded image
+	fs::path dst_path;
+};
+
+using FilesQueue = BoundedQueue<BatchFile>;
+using ImagesQueue = BoundedQueue<BatchImage>;
+using AnnotationsQueue = BoundedQueue<BatchAnnotation>;
+using ResultsQueue = BoundedQueue<BatchResult>;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsed_milliseconds(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+bool is_glob(const std::string& input)
+{
+	return (input.find_first_of("*?[") != std::string::npos);
+}
+
+template<typename Callback>
+void list_directory(const fs::path& directory, Callback callback)
+{
+	for(const auto& entry : fs::recursive_directory_iterator(directory))
+	{
+		if(entry.is_regular_file() && is_image_file(entry.path()))
+		{
+			callback(BatchFile{entry.path(), fs::relative(entry.path(), directory)});
+		}
+	}
+}
+
+/**
+ * @brief Lists files matching given pattern. Only file name part may contain wildcards
+ */
+template<typename Callback>
+void list_glob(const fs::path& pattern, Callback callback)
+{
+	auto directory = pattern.parent_path();
+	if(directory.empty())
+	{
+		directory = ".";
+	}
+
+	if(is_glob(directory.string()))
+	{
+		throw std::runtime_error("Wildcards are supported only in file names: " + pattern.string());
+	}
+
+	const auto file_pattern = pattern.filename().string();
+	for(const auto& entry : fs::directory_iterator(directory))
+	{
+		const auto file_name = entry.path().filename().string();
+		if(entry.is_regular_file() && fnmatch(file_pattern.c_str(), file_name.c_str(), 0) == 0)
+		{
+			callback(BatchFile{entry.path(), file_name});
+		}
+	}
+}
+
+template<typename Callback>
+void list_manifest(const std::string& manifest, Callback callback)
+{
+	auto ifs = std::ifstream(manifest);
+	if(!ifs)
+	{
+		throw std::runtime_error("Could not open manifest file");
+	}
+
+	for(auto line = std::string(); std::getline(ifs, line); )
+	{
+		if(!line.empty() && line.back() == '\r')
+		{
+			line.pop_back();
+		}
+
+		if(!line.empty())
+		{
+			const auto path = fs::path{line};
+			callback(BatchFile{path, path.filename()});
+		}
+	}
+}
+
+template<typename Callback>
+void list_files(const BatchProcessor::Options& options, Callback callback)
+{
+	for(const auto& input : options.inputs)
+	{
+		if(is_glob(input))
+		{
+			list_glob(input, callback);
+		}
+		else if(fs::is_directory(input))
+		{
+			list_directory(input, callback);
+		}
+		else
+		{
+			const auto path = fs::path{input};
+			callback(BatchFile{path, path.filename()});
+		}
+	}
+
+	if(!options.manifest.empty())
+	{
+		list_manifest(options.manifest, callback);
+	}
+}
+
+std::string format_ndjson(const BatchResult& result, bool parts)
+{
+	auto json = nlohmann::json{
+		{"file", result.path.string()},
+		{"logos", format_logos(result.detections)},
+		{"read_ms", result.read_ms},
+		{"detect_ms", result.detect_ms},
+	};
+
+	if(parts)
+	{
+		json["parts"] = format_parts(result.detections);
+	}
+
+	if(result.cached)
+	{
+		json["cached"] = true;
+	}
+
+	if(!result.error.empty())
+	{
+		json["error"] = result.error;
+	}
+
+	return json.dump();
+}
+
+std::string quote_csv(const std::string& value)
+{
+	auto quoted = std::string("\"");
+	for(const auto c : value)
+	{
+		quoted += c;
+		if(c == '"')
+		{
+			quoted += c;
+		}
+	}
+
+	return quoted + '"';
+}
+
+std::string format_csv(const BatchResult& result)
+{
+	// Logos are joined into single field, as "x y width height;..."
+	auto logos = std::string();
+	for(const auto& detection : result.detections)
+	{
+		const auto& logo = detection.logo;
+		if(!logos.empty())
+		{
+			logos += ';';
+		}
+
+		logos += std::to_string(logo.x) + ' ' + std::to_string(logo.y) + ' '
+			+ std::to_string(logo.width) + ' ' + std::to_string(logo.height);
+	}
+
+	char timings[64];
+	std::snprintf(timings, sizeof(timings), "%.3f,%.3f", result.read_ms, result.detect_ms);
+
+	return quote_csv(result.path.string()) + ',' + std::to_string(result.detections.size()) + ','
+		+ quote_csv(logos) + ',' + timings + ',' + quote_csv(result.error);
+}
+
+void write_header(std::ostream& os, const std::string& format)
+{
+	if(format == "csv")
+	{
+		os << "file,logos_count,logos,read_ms,detect_ms,error\n";
+	}
+}
+
+} // namespace
+
+BatchProcessor::BatchProcessor(Options options, LocateConfig locate_config, MakeDetector make_detector,
+                               ResultCache* results)
+	:	m_options(std::move(options))
+	,	m_locate_config(std::move(locate_config))
+	,	m_make_detector(std::move(make_detector))
+	,	m_results(results)
+{
+	CV_Assert(m_options.workers > 0);
+	CV_Assert(m_options.readers > 0);
+	CV_Assert(m_options.read_ahead > 0);
+	CV_Assert(m_options.annotators > 0);
+	CV_Assert(m_options.reduce == 1 || m_options.reduce == 2 || m_options.reduce == 4 || m_options.reduce == 8);
+	CV_Assert(m_options.format == "ndjson" || m_options.format == "csv");
+}
+
+BatchProcessor::Stats BatchProcessor::run()
+{
+	const auto to_stdout = (m_options.output_file.empty() || m_options.output_file == "-");
+	auto output_file = std::ofstream();
+	if(!to_stdout)
+	{
+		output_file.open(m_options.output_file);
+		if(!output_file)
+		{
+			throw std::runtime_error("Could not open output file");
+		}
+	}
+
+	auto& os = to_stdout ? std::cout : output_file;
+	write_header(os, m_options.format);
+
+	auto detectors = DetectorsCache{m_locate_config, m_make_detector};
+	const auto decode_flags = get_decode_flags(m_options.reduce);
+
+	auto files = FilesQueue(m_options.read_ahead);
+	auto images = ImagesQueue(m_options.read_ahead);
+	auto annotations = AnnotationsQueue(m_options.read_ahead);
+	auto results = ResultsQueue(m_options.read_ahead);
+	const auto annotate = !m_options.dst_dir.empty();
+
+	auto list_error = std::exception_ptr();
+	auto lister = std::thread(
+		[this, &files, &list_error]()
+		{
+			trace::set_thread_name("list");
+			try
+			{
+				list_files(m_options, [&files](BatchFile file) { files.push(std::move(file)); });
+			}
+			catch(...)
+			{
+				list_error = std::current_exception();
+			}
+
+			files.close();
+		});
+
+	auto readers_left = std::atomic<std::size_t>(m_options.readers);
+	auto readers = std::vector<std::thread>();
+	for(auto i = std::size_t{0}; i < m_options.readers; ++i)
+	{
+		readers.emplace_back(
+			[this, &files, &images, &readers_left, &detectors, decode_flags, annotate]()
+			{
+				trace::set_thread_name("read");
+				while(auto file = files.pop())
+				{
+					auto image = BatchImage{std::move(*file), cv::Mat(), 0.0, {}, {}, {}};
+					const auto start = Clock::now();
+					try
+					{
+						const auto span = trace::Span{"read"};
+						if(m_results)
+						{
+							// File bytes are hashed before decoding, so cached images are decoded only to be annotated
+							const auto path = image.file.path.string();
+							const auto bytes = read_file_bytes(path);
+							image.key = ResultCache::make_key(hash_bytes(bytes.data(), bytes.size()),
+							                                  *detectors.get_for_image(path), m_options.reduce);
+							image.cached = m_results->find(*image.key);
+							if(!image.cached || annotate)
+							{
+								image.img = decode_image_bytes(bytes, decode_flags);
+							}
+						}
+						else
+						{
+							image.img = cv::imread(image.file.path.string(), decode_flags);
+							if(image.img.empty())
+							{
+								image.error = "Could not read image file";
+							}
+						}
+					}
+					catch(std::exception& ex)
+					{
+						image.error = ex.what();
+					}
+
+					image.read_ms = elapsed_milliseconds(start);
+					images.push(std::move(image));
+				}
+
+				if(--readers_left == 0)
+				{
+					images.close();
+				}
+			});
+	}
+
+	auto workers_left = std::atomic<std::size_t>(m_options.workers);
+	auto workers = std::vector<std::thread>();
+	for(auto i = std::size_t{0}; i < m_options.workers; ++i)
+	{
+		workers.emplace_back(
+			[this, &images, &annotations, &results, &workers_left, &detectors, annotate]()
+			{
+				trace::set_thread_name("detect");
+				while(auto image = images.pop())
+				{
+					auto result = BatchResult{image->file.path, {}, image->read_ms, 0.0, image->error};
+					auto detections = Detections();
+					if(result.error.empty() && image->cached)
+					{
+						detections = std::move(*image->cached);
+						result.detections = scale_detections(detections, m_options.reduce);
+						result.cached = true;
+					}
+					else if(result.error.empty())
+					{
+						try
+						{
+							const auto detector = detectors.get_for_image(image->file.path.string());
+
+							// Each image is a frame of its own for sampling and naming of dumped stages
+							imglog::begin_frame();
+
+							const auto start = Clock::now();
+							{
+								const auto span = trace::Span{"detect"};
+								detections = detector->find_detections(image->img);
+							}
+							result.detect_ms = elapsed_milliseconds(start);
+							result.detections = scale_detections(detections, m_options.reduce);
+
+							if(image->key)
+							{
+								m_results->insert(*image->key, detections);
+							}
+						}
+						catch(std::exception& ex)
+						{
+							result.error = ex.what();
+						}
+					}
+
+					if(annotate && result.error.empty())
+					{
+						const auto dst_path = (fs::path{m_options.dst_dir} / image->file.name);
+						annotations.push(BatchAnnotation{std::move(result), std::move(image->img), to_logos(detections), dst_path});
+					}
+					else
+					{
+						results.push(std::move(result));
+					}
+				}
+
+				if(--workers_left == 0)
+				{
+					// Annotators pass remaining results on, before they close results queue
+					annotations.close();
+					if(!annotate)
+					{
+						results.close();
+					}
+				}
+			});
+	}
+
+	const auto annotators_count = (annotate ? m_options.annotators : std::size_t{0});
+	auto annotators_left = std::atomic<std::size_t>(annotators_count);
+	auto annotators = std::vector<std::thread>();
+	for(auto i = std::size_t{0}; i < annotators_count; ++i)
+	{
+		annotators.emplace_back(
+			[&annotations, &results, &annotators_left]()
+			{
+				trace::set_thread_name("annotate");
+				while(auto annotation = annotations.pop())
+				{
+					auto& result = annotation->result;
+					try
+					{
+						const auto span = trace::Span{"write"};
+						fs::create_directories(annotation->dst_path.parent_path());
+						draw_logos(annotation->img, annotation->logos);
+						if(!cv::imwrite(annotation->dst_path.string(), annotation->img))
+						{
+							result.error = "Could not write image file";
+						}
+					}
+					catch(std::exception& ex)
+					{
+						result.error = ex.what();
+					}
+
+					results.push(std::move(result));
+				}
+
+				if(--annotators_left == 0)
+				{
+					results.close();
+				}
+			});
+	}
+
+	const auto format = [this](const BatchResult& result) {
+		return (m_options.format == "csv") ? format_csv(result) : format_ndjson(result, m_options.parts);
+	};
+	const auto start = Clock::now();
+	auto stats = Stats{};
+
+	// Results are written on the calling thread, as they complete
+	while(auto result = results.pop())
+	{
+		os << format(*result) << '\n';
+
+		++stats.files;
+		stats.logos += result->detections.size();
+		if(!result->error.empty())
+		{
+			++stats.failed;
+		}
+	}
+
+	lister.join();
+	for(auto& thread : readers)
+	{
+		thread.join();
+	}
+	for(auto& thread : workers)
+	{
+		thread.join();
+	}
+	for(auto& thread : annotators)
+	{
+		thread.join();
+	}
+
+	os.flush();
+	if(list_error)
+	{
+		std::rethrow_exception(list_error);
+	}
+
+	stats.seconds = (elapsed_milliseconds(start) / 1000.0);
+	stats.files_per_second = (stats.seconds > 0.0) ? (stats.files / stats.seconds) : 0.0;
+	return stats;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+
+#include <string>
+#include <vector>
+
+#include "DetectorsCache.hpp"
+#include "ResultCache.hpp"
+
+/**
+ * @brief Runs logo detection over many image files
+ * Files are listed, decoded (read ahead by several readers) and processed by a pool
+ *  of workers concurrently. Results are written as NDJSON or CSV lines, in order of completion.
+ *  Detectors are created once per configuration file and shared by all workers.
+ *  Annotated images are drawn and encoded only on request, by separate threads,
+ *  so workers may proceed with detection meanwhile.
+ */
+class BatchProcessor
+{
+public:
+	struct Options
+	{
+		std::vector<std::string> inputs; // Files, directories (searched recursively) or globs
+		std::string manifest; // File with paths of images, one per line
+		std::string dst_dir; // If not empty, annotated images are written there
+		std::string output_file; // If empty, results are written to stdout
+		std::string format = "ndjson";
+		std::size_t workers = 1;
+		std::size_t readers = 2;
+		std::size_t read_ahead = 16;
+		std::size_t annotators = 2; // Threads drawing and encoding annotated images
+		bool parts = false; // If set, NDJSON results contain parts of each logo
+		int reduce = 1; // Images are decoded downsampled by this factor, logos are mapped back
+	};
+
+	struct Stats
+	{
+		std::size_t files = 0;
+		std::size_t failed = 0;
+		std::size_t logos = 0;
+		double seconds = 0.0;
+		double files_per_second = 0.0;
+	};
+
+	using LocateConfig = DetectorsCache::LocateConfig;
+	using MakeDetector = DetectorsCache::MakeDetector;
+
+	/**
+	 * @brief Creates processor of images and, if results cache is given, skips detection of images seen before
+	 */
+	BatchProcessor(Options options, LocateConfig locate_config, MakeDetector make_detector,
+	               ResultCache* results = nullptr);
+
+	Stats run();
+
+private:
+	Options m_options;
+	LocateConfig m_locate_config;
+	MakeDetector m_make_detector;
+	ResultCache* m_results;
+};
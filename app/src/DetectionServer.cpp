@@ -0,0 +1,380 @@
+#include "DetectionServer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+#include <opencv2/opencv.hpp>
+#include <nlohmann/json.hpp>
+
+#include "BoundedQueue.hpp"
+#include "UnixSocket.hpp"
+#include "base64.hpp"
+#include "decoding.hpp"
+#include "frame.hpp"
+#include "hash.hpp"
+#include "imglog.hpp"
+#include "results.hpp"
+#include "trace.hpp"
+
+namespace {
+
+struct Request
+{
+	std::shared_ptr<LineConnection> connection; // Empty in stream mode
+	std::string line;
+};
+
+using RequestsQueue = BoundedQueue<Request>;
+
+struct ConnectionReader
+{
+	std::thread thread;
+	std::shared_ptr<std::atomic<bool>> finished;
+};
+
+/**
+ * @brief Reads image data of the request into given buffer
+ * Returns raw pixels (referring to the buffer) or, if buffer holds encoded image, empty image.
+ */
+cv::Mat read_request_image(const nlohmann::json& request, std::string& buffer)
+{
+	if(request.count("path") > 0)
+	{
+		buffer = read_file_bytes(request.at("path").get<std::string>());
+		return cv::Mat();
+	}
+
+	if(request.count("image") > 0)
+	{
+		buffer = decode_base64(request.at("image").get<std::string>());
+		return cv::Mat();
+	}
+
+	if(request.count("raw") > 0)
+	{
+		buffer = decode_base64(request.at("raw").get<std::string>());
+		const auto size = cv::Size{request.at("width").get<int>(), request.at("height").get<int>()};
+		const auto row_size = (3 * static_cast<std::size_t>(size.width));
+		const auto stride = request.value("stride", row_size);
+		if(size.width <= 0 || size.height <= 0 || stride < row_size || buffer.size() < row_size)
+		{
+			throw std::runtime_error("Raw image size does not match its data");
+		}
+
+		// Stride comes from the client, so rows are counted without overflowing their total size
+		const auto rows = static_cast<std::size_t>(size.height);
+		if(stride > buffer.size() || (rows > 1 && stride > (buffer.size() - row_size) / (rows - 1)))
+		{
+			throw std::runtime_error("Raw image size does not match its data");
+		}
+
+		return wrap_bgr_frame(reinterpret_cast<const uchar*>(buffer.data()), size, stride);
+	}
+
+	throw std::runtime_error("Request has no image");
+}
+
+/**
+ * @brief Decodes image read from the request, downsampled by given factor. Decoded pixels may refer to the buffer
+ */
+cv::Mat decode_image(const cv::Mat& raw, const std::string& buffer, int reduce)
+{
+	if(raw.empty())
+	{
+		return decode_image_bytes(buffer, get_decode_flags(reduce));
+	}
+
+	if(reduce == 1)
+	{
+		return raw;
+	}
+
+	// Raw pixels are not decoded, so they are downsampled like the decoder would do
+	auto reduced = cv::Mat();
+	const auto reduced_size = cv::Size{(raw.cols + reduce - 1) / reduce, (raw.rows + reduce - 1) / reduce};
+	cv::resize(raw, reduced, reduced_size, 0.0, 0.0, cv::INTER_AREA);
+	return reduced;
+}
+
+template<typename Respond>
+std::vector<std::thread> start_workers(const DetectionServer& server, std::size_t count,
+                                       RequestsQueue& requests, Respond respond)
+{
+	auto workers = std::vector<std::thread>();
+	for(auto i = std::size_t{0}; i < count; ++i)
+	{
+		workers.emplace_back(
+			[&server, &requests, respond]()
+			{
+				trace::set_thread_name("serve");
+				while(auto request = requests.pop())
+				{
+					respond(*request, server.handle(request->line));
+				}
+			});
+	}
+
+	return workers;
+}
+
+void join_all(std::vector<std::thread>& threads)
+{
+	for(auto& thread : threads)
+	{
+		thread.join();
+	}
+}
+
+/**
+ * @brief Joins readers of connections, which were already closed
+ */
+void join_finished(std::vector<ConnectionReader>& readers)
+{
+	const auto it = std::partition(readers.begin(), readers.end(),
+		[](const auto& reader) { return !(*reader.finished); });
+
+	for(auto finished = it; finished != readers.end(); ++finished)
+	{
+		finished->thread.join();
+	}
+
+	readers.erase(it, readers.end());
+}
+
+} // namespace
+
+DetectionServer::DetectionServer(Options options, DetectorsCache& detectors, ResultCache* results)
+	:	m_options(std::move(options))
+	,	m_detectors(detectors)
+	,	m_results(results)
+	,	m_stopped{false}
+	,	m_listener{nullptr}
+{
+	CV_Assert(m_options.workers > 0);
+	CV_Assert(m_options.queue_size > 0);
+	CV_Assert(m_options.reduce == 1 || m_options.reduce == 2 || m_options.reduce == 4 || m_options.reduce == 8);
+}
+
+std::string DetectionServer::handle(const std::string& request) const
+{
+	auto id = nlohmann::json();
+	try
+	{
+		const auto json = nlohmann::json::parse(request);
+		if(!json.is_object())
+		{
+			throw std::runtime_error("Request is not a JSON object");
+		}
+
+		if(json.count("id") > 0)
+		{
+			id = json.at("id");
+		}
+
+		const auto detector = (json.count("config") > 0)
+			? m_detectors.get_for_config(json.at("config").get<std::string>())
+			: (json.count("path") > 0)
+				? m_detectors.get_for_image(json.at("path").get<std::string>())
+				: m_detectors.get_for_config(m_options.default_config);
+
+		auto buffer = std::string();
+		auto key = std::optional<ResultCache::Key>();
+		auto detections = std::optional<Detections>();
+		auto img = cv::Mat();
+		{
+			const auto span = trace::Span{"read"};
+			const auto raw = read_request_image(json, buffer);
+			if(m_results)
+			{
+				// Encoded images are looked up before decoding, so hits skip the decoder too
+				const auto content_hash = raw.empty() ? hash_bytes(buffer.data(), buffer.size()) : hash_image(raw);
+				key = ResultCache::make_key(content_hash, *detector, m_options.reduce);
+				detections = m_results->find(*key);
+			}
+
+			if(!detections)
+			{
+				img = decode_image(raw, buffer, m_options.reduce);
+			}
+		}
+
+		const auto cached = detections.has_value();
+		const auto start = std::chrono::steady_clock::now();
+		if(!cached)
+		{
+			// Each request is a frame of its own for sampling and naming of dumped stages
+			imglog::begin_frame();
+
+			const auto span = trace::Span{"detect"};
+			detections = detector->find_detections(img);
+			if(key)
+			{
+				m_results->insert(*key, *detections);
+			}
+		}
+		const auto elapsed = (std::chrono::steady_clock::now() - start);
+
+		const auto scaled = scale_detections(*detections, m_options.reduce);
+		auto response = nlohmann::json{
+			{"id", std::move(id)},
+			{"logos", format_logos(scaled)},
+			{"detect_ms", std::chrono::duration<double, std::milli>(elapsed).count()},
+		};
+
+		if(cached)
+		{
+			response["cached"] = true;
+		}
+
+		if(json.value("parts", false))
+		{
+			response["parts"] = format_parts(scaled);
+		}
+
+		return response.dump();
+	}
+	catch(std::exception& ex)
+	{
+		spdlog::debug("[DetectionServer] Request failed: {}", ex.what());
+
+		const auto response = nlohmann::json{
+			{"id", std::move(id)},
+			{"logos", nlohmann::json::array()},
+			{"error", ex.what()},
+		};
+
+		return response.dump();
+	}
+}
+
+void DetectionServer::serve_socket(const std::string& path)
+{
+	auto listener = UnixSocketListener{path};
+	{
+		const auto lock = std::lock_guard<std::mutex>(m_mutex);
+		if(m_stopped)
+		{
+			return;
+		}
+
+		m_listener = &listener;
+	}
+
+	auto requests = RequestsQueue(m_options.queue_size);
+	auto workers = start_workers(*this, m_options.workers, requests,
+		[](const Request& request, const std::string& response)
+		{
+			// Client may be already gone, then its response is dropped
+			request.connection->write_line(response);
+		});
+
+	spdlog::info("Listening on {}...", path);
+	auto readers = std::vector<ConnectionReader>();
+	while(true)
+	{
+		const auto fd = listener.accept();
+		if(fd < 0)
+		{
+			break;
+		}
+
+		auto connection = std::make_shared<LineConnection>(fd);
+		{
+			const auto lock = std::lock_guard<std::mutex>(m_mutex);
+			if(m_stopped)
+			{
+				break;
+			}
+
+			m_connections.remove_if([](const auto& weak_connection) { return weak_connection.expired(); });
+			m_connections.push_back(connection);
+		}
+
+		join_finished(readers);
+		auto finished = std::make_shared<std::atomic<bool>>(false);
+		auto thread = std::thread(
+			[connection = std::move(connection), finished, &requests]()
+			{
+				trace::set_thread_name("connection");
+				while(auto line = connection->read_line())
+				{
+					if(!line->empty() && !requests.push(Request{connection, std::move(*line)}))
+					{
+						break;
+					}
+				}
+
+				*finished = true;
+			});
+
+		readers.push_back(ConnectionReader{std::move(thread), std::move(finished)});
+	}
+
+	spdlog::info("Stopping server...");
+	{
+		const auto lock = std::lock_guard<std::mutex>(m_mutex);
+		m_listener = nullptr;
+	}
+
+	for(auto& reader : readers)
+	{
+		reader.thread.join();
+	}
+
+	requests.close();
+	join_all(workers);
+}
+
+void DetectionServer::serve_stream(std::istream& is, std::ostream& os)
+{
+	auto output_mutex = std::mutex();
+	auto requests = RequestsQueue(m_options.queue_size);
+	auto workers = start_workers(*this, m_options.workers, requests,
+		[&os, &output_mutex](const Request&, const std::string& response)
+		{
+			const auto lock = std::lock_guard<std::mutex>(output_mutex);
+			os << response << '\n';
+			os.flush();
+		});
+
+	for(auto line = std::string(); std::getline(is, line); )
+	{
+		if(!line.empty() && line.back() == '\r')
+		{
+			line.pop_back();
+		}
+
+		if(!line.empty())
+		{
+			requests.push(Request{nullptr, std::move(line)});
+		}
+	}
+
+	requests.close();
+	join_all(workers);
+}
+
+void DetectionServer::stop() noexcept
+{
+	const auto lock = std::lock_guard<std::mutex>(m_mutex);
+	m_stopped = true;
+	if(m_listener)
+	{
+		m_listener->shutdown();
+	}
+
+	for(const auto& weak_connection : m_connections)
+	{
+		if(const auto connection = weak_connection.lock())
+		{
+			connection->shutdown_reading();
+		}
+	}
+}
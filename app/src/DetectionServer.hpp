@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+
+#include <iosfwd>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "DetectorsCache.hpp"
+#include "ResultCache.hpp"
+
+class LineConnection;
+class UnixSocketListener;
+
+/**
+ * @brief Persistent detection server, keeping warm detectors between requests
+ * Requests and responses are JSON objects, one per line. Request carries "id" (echoed
+ *  in response) and one of:
+ *  - "path" to image file (config is located for its directory, as in batch mode),
+ *  - "image" with Base64 of encoded image file (PNG, JPEG, ...),
+ *  - "raw" with Base64 of BGR pixels, with "width", "height" and optional "stride".
+ *  Optional "config" names configuration file to use instead. Response carries "id",
+ *  "logos" (as [x, y, width, height] arrays), "detect_ms" and "error", if request failed.
+ *  If request has "parts" set, response carries also rectangles and areas of logos parts.
+ *  Results found in the cache are marked with "cached" set.
+ *  Requests are handled concurrently by a pool of workers, so responses may come
+ *  in different order than requests.
+ */
+class DetectionServer
+{
+public:
+	struct Options
+	{
+		std::size_t workers = 1;
+		std::size_t queue_size = 64;
+		std::string default_config; // Used for inline images, empty for defaults
+		int reduce = 1; // Images are decoded downsampled by this factor, logos are mapped back
+	};
+
+	/**
+	 * @brief Creates server using given detectors and, if given, reusing results of images seen before
+	 */
+	DetectionServer(Options options, DetectorsCache& detectors, ResultCache* results = nullptr);
+
+	DetectionServer(const DetectionServer&) = delete;
+	DetectionServer& operator=(const DetectionServer&) = delete;
+
+	/**
+	 * @brief Handles single request line and returns response line. May be called from many threads
+	 */
+	std::string handle(const std::string& request) const;
+
+	/**
+	 * @brief Serves clients of Unix domain socket at given path, until stop() is called
+	 */
+	void serve_socket(const std::string& path);
+
+	/**
+	 * @brief Serves requests read from given stream, until its end. Responses are written to output stream
+	 */
+	void serve_stream(std::istream& is, std::ostream& os);
+
+	/**
+	 * @brief Stops serving socket. Requests already read are still answered. May be called from any thread
+	 * Server may not be started again after it was stopped.
+	 */
+	void stop() noexcept;
+
+private:
+	Options m_options;
+	DetectorsCache& m_detectors;
+	ResultCache* m_results;
+
+	std::mutex m_mutex;
+	bool m_stopped;
+	UnixSocketListener* m_listener;
+	std::list<std::weak_ptr<LineConnection>> m_connections;
+};
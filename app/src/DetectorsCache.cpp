@@ -0,0 +1,44 @@
+#include "DetectorsCache.hpp"
+
+#include <filesystem>
+
+#include <spdlog/spdlog.h>
+
+namespace fs = std::filesystem;
+
+DetectorsCache::DetectorsCache(LocateConfig locate_config, MakeDetector make_detector)
+	:	m_locate_config(std::move(locate_config))
+	,	m_make_detector(std::move(make_detector))
+{}
+
+std::shared_ptr<const PepsiDetector> DetectorsCache::get_for_image(const std::string& src_file)
+{
+	const auto directory = fs::path{src_file}.parent_path().string();
+
+	const auto lock = std::lock_guard<std::mutex>(m_mutex);
+	auto& detector = m_by_directory[directory];
+	if(!detector)
+	{
+		detector = get_for_config_locked(m_locate_config(src_file));
+	}
+
+	return detector;
+}
+
+std::shared_ptr<const PepsiDetector> DetectorsCache::get_for_config(const std::string& config_file)
+{
+	const auto lock = std::lock_guard<std::mutex>(m_mutex);
+	return get_for_config_locked(config_file);
+}
+
+std::shared_ptr<const PepsiDetector> DetectorsCache::get_for_config_locked(const std::string& config_file)
+{
+	auto& detector = m_by_config[config_file];
+	if(!detector)
+	{
+		spdlog::debug("[DetectorsCache] Creating detector for config '{}'", config_file);
+		detector = std::make_shared<const PepsiDetector>(m_make_detector(config_file));
+	}
+
+	return detector;
+}
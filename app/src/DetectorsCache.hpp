@@ -0,0 +1,48 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "PepsiDetector.hpp"
+
+/**
+ * @brief Shares detectors between threads, creating each of them once per configuration file
+ */
+class DetectorsCache
+{
+public:
+	/**
+	 * @brief Returns path of configuration file for given image, or empty string for defaults
+	 */
+	using LocateConfig = std::function<std::string(const std::string& src_file)>;
+
+	/**
+	 * @brief Creates detector for given configuration file (empty for defaults)
+	 */
+	using MakeDetector = std::function<PepsiDetector(const std::string& config_file)>;
+
+	DetectorsCache(LocateConfig locate_config, MakeDetector make_detector);
+
+	/**
+	 * @brief Returns detector for given image, with configuration located for its directory
+	 */
+	std::shared_ptr<const PepsiDetector> get_for_image(const std::string& src_file);
+
+	/**
+	 * @brief Returns detector for given configuration file (empty for defaults)
+	 */
+	std::shared_ptr<const PepsiDetector> get_for_config(const std::string& config_file);
+
+private:
+	std::shared_ptr<const PepsiDetector> get_for_config_locked(const std::string& config_file);
+
+	LocateConfig m_locate_config;
+	MakeDetector m_make_detector;
+
+	std::mutex m_mutex;
+	std::map<std::string, std::shared_ptr<const PepsiDetector>> m_by_directory;
+	std::map<std::string, std::shared_ptr<const PepsiDetector>> m_by_config;
+};
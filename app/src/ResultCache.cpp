@@ -0,0 +1,216 @@
+#include "ResultCache.hpp"
+
+#include <unistd.h>
+
+#include <cinttypes>
+#include <cstdio>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <spdlog/spdlog.h>
+#include <nlohmann/json.hpp>
+
+#include "hash.hpp"
+#include "results.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+Rect parse_rect(const nlohmann::json& json)
+{
+	return Rect{json.at(0).get<int>(), json.at(1).get<int>(), json.at(2).get<int>(), json.at(3).get<int>()};
+}
+
+LogoPart parse_part(const nlohmann::json& json)
+{
+	return LogoPart{parse_rect(json.at("rect")), json.at("area").get<BlobArea>()};
+}
+
+/**
+ * @brief Parses detections stored in the same form as results: logos and parts of each of them
+ */
+Detections parse_detections(const nlohmann::json& json)
+{
+	const auto& logos = json.at("logos");
+	const auto& parts = json.at("parts");
+	if(logos.size() != parts.size())
+	{
+		throw std::runtime_error("Numbers of logos and parts differ");
+	}
+
+	auto detections = Detections();
+	detections.reserve(logos.size());
+	for(auto i = std::size_t{0}; i < logos.size(); ++i)
+	{
+		const auto& logo_parts = parts.at(i);
+		detections.push_back(Detection{
+			parse_rect(logos.at(i)),
+			parse_part(logo_parts.at("blue")),
+			parse_part(logo_parts.at("red"))});
+	}
+
+	return detections;
+}
+
+} // namespace
+
+ResultCache::Key ResultCache::make_key(std::uint64_t content_hash, const PepsiDetector& detector, int reduce)
+{
+	// Entries stored on disk outlive binaries, so results of other detection versions are never reused
+	const auto config_hash = hash_combine(detector.config().hash(), static_cast<std::uint64_t>(reduce));
+	return Key{content_hash, hash_combine(config_hash, std::uint64_t{PepsiDetector::DetectionVersion})};
+}
+
+ResultCache::ResultCache(Options options)
+	:	m_options(std::move(options))
+{
+	CV_Assert(m_options.capacity > 0);
+
+	if(!m_options.directory.empty())
+	{
+		fs::create_directories(m_options.directory);
+	}
+}
+
+std::optional<Detections> ResultCache::find(const Key& key)
+{
+	{
+		const auto lock = std::lock_guard<std::mutex>(m_mutex);
+		const auto it = m_index.find(key);
+		if(it != m_index.end())
+		{
+			m_entries.splice(m_entries.begin(), m_entries, it->second);
+			++m_stats.hits;
+			return it->second->second;
+		}
+	}
+
+	// Files are read without holding the lock, so other threads are not held up by disk
+	auto detections = m_options.directory.empty() ? std::nullopt : load_entry(key);
+
+	const auto lock = std::lock_guard<std::mutex>(m_mutex);
+	if(!detections)
+	{
+		++m_stats.misses;
+		return std::nullopt;
+	}
+
+	++m_stats.hits;
+	++m_stats.disk_hits;
+	insert_locked(key, *detections);
+	return detections;
+}
+
+void ResultCache::insert(const Key& key, const Detections& detections)
+{
+	{
+		const auto lock = std::lock_guard<std::mutex>(m_mutex);
+		insert_locked(key, detections);
+	}
+
+	if(!m_options.directory.empty())
+	{
+		store_entry(key, detections);
+	}
+}
+
+ResultCache::Stats ResultCache::stats() const
+{
+	const auto lock = std::lock_guard<std::mutex>(m_mutex);
+	auto stats = m_stats;
+	stats.entries = m_entries.size();
+	return stats;
+}
+
+std::size_t ResultCache::KeyHash::operator()(const Key& key) const noexcept
+{
+	return static_cast<std::size_t>(key.content ^ (key.config * 0x9E3779B97F4A7C15));
+}
+
+bool ResultCache::KeyEqual::operator()(const Key& lhs, const Key& rhs) const noexcept
+{
+	return (lhs.content == rhs.content && lhs.config == rhs.config);
+}
+
+void ResultCache::insert_locked(const Key& key, const Detections& detections)
+{
+	const auto it = m_index.find(key);
+	if(it != m_index.end())
+	{
+		it->second->second = detections;
+		m_entries.splice(m_entries.begin(), m_entries, it->second);
+		return;
+	}
+
+	m_entries.emplace_front(key, detections);
+	m_index.emplace(key, m_entries.begin());
+
+	while(m_entries.size() > m_options.capacity)
+	{
+		m_index.erase(m_entries.back().first);
+		m_entries.pop_back();
+	}
+}
+
+std::string ResultCache::get_entry_path(const Key& key) const
+{
+	char name[64];
+	std::snprintf(name, sizeof(name), "%016" PRIx64 "-%016" PRIx64 ".json", key.content, key.config);
+	return (fs::path{m_options.directory} / name).string();
+}
+
+std::optional<Detections> ResultCache::load_entry(const Key& key) const
+{
+	auto ifs = std::ifstream(get_entry_path(key));
+	if(!ifs)
+	{
+		return std::nullopt;
+	}
+
+	try
+	{
+		nlohmann::json json;
+		ifs >> json;
+		return parse_detections(json);
+	}
+	catch(std::exception& ex)
+	{
+		spdlog::debug("[ResultCache] Skipping invalid entry {}: {}", get_entry_path(key), ex.what());
+		return std::nullopt;
+	}
+}
+
+void ResultCache::store_entry(const Key& key, const Detections& detections) const
+{
+	const auto json = nlohmann::json{
+		{"logos", format_logos(detections)},
+		{"parts", format_parts(detections)},
+	};
+
+	// Entry is written aside and renamed, so readers in other threads or processes never see it partially
+	const auto path = get_entry_path(key);
+	auto temp_path = std::ostringstream();
+	temp_path << path << ".tmp" << ::getpid() << '-' << std::this_thread::get_id();
+
+	auto error = std::error_code();
+	auto ofs = std::ofstream(temp_path.str());
+	if(!(ofs << json.dump() << '\n') || !ofs.flush())
+	{
+		spdlog::warn("[ResultCache] Could not write entry {}", path);
+		ofs.close();
+		fs::remove(temp_path.str(), error);
+		return;
+	}
+
+	ofs.close();
+	fs::rename(temp_path.str(), path, error);
+	if(error)
+	{
+		spdlog::warn("[ResultCache] Could not store entry {}: {}", path, error.message());
+		fs::remove(temp_path.str(), error);
+	}
+}
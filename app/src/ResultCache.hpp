@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "PepsiDetector.hpp"
+
+/**
+ * @brief Caches detections of images seen before, keyed by hash of their content and of the config
+ * Recently used results are kept in memory, up to given capacity. If directory is given,
+ *  results are also stored there (one small JSON file each), so they survive restarts and
+ *  may be shared by processes. Content is hashed from encoded file bytes or from decoded
+ *  pixels, so the same image sent both ways has two entries. May be used from many threads.
+ */
+class ResultCache
+{
+public:
+	struct Options
+	{
+		std::size_t capacity = 4096; // Entries kept in memory
+		std::string directory; // If not empty, entries are stored there too
+	};
+
+	struct Key
+	{
+		std::uint64_t content;
+		std::uint64_t config;
+	};
+
+	struct Stats
+	{
+		std::size_t hits = 0;
+		std::size_t disk_hits = 0; // Hits missing in memory, but found in directory
+		std::size_t misses = 0;
+		std::size_t entries = 0; // In memory
+	};
+
+	/**
+	 * @brief Makes key of content processed by given detector, with images decoded downsampled by given factor
+	 * Key also covers detection version, so results of other versions of the algorithm are never found.
+	 */
+	static Key make_key(std::uint64_t content_hash, const PepsiDetector& detector, int reduce);
+
+	explicit ResultCache(Options options);
+
+	ResultCache(const ResultCache&) = delete;
+	ResultCache& operator=(const ResultCache&) = delete;
+
+	/**
+	 * @brief Returns cached detections, counting hit or miss
+	 */
+	std::optional<Detections> find(const Key& key);
+
+	void insert(const Key& key, const Detections& detections);
+
+	Stats stats() const;
+
+private:
+	struct KeyHash
+	{
+		std::size_t operator()(const Key& key) const noexcept;
+	};
+
+	struct KeyEqual
+	{
+		bool operator()(const Key& lhs, const Key& rhs) const noexcept;
+	};
+
+	using Entry = std::pair<Key, Detections>;
+	using Entries = std::list<Entry>;
+
+	void insert_locked(const Key& key, const Detections& detections);
+
+	std::string get_entry_path(const Key& key) const;
+
+	std::optional<Detections> load_entry(const Key& key) const;
+
+	void store_entry(const Key& key, const Detections& detections) const;
+
+	Options m_options;
+
+	mutable std::mutex m_mutex;
+	Entries m_entries; // From the most recently used
+	std::unordered_map<Key, Entries::iterator, KeyHash, KeyEqual> m_index;
+	Stats m_stats;
+};
@@ -0,0 +1,368 @@
+#include "ShmRing.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include <algorithm>
+#include <chrono>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#include "frame.hpp"
+
+namespace {
+
+constexpr char Magic[8] = {'P', 'L', 'D', 'S', 'H', 'M', '\0', '\0'};
+constexpr auto Version = std::uint32_t{1};
+constexpr auto BytesPerPixel = std::size_t{3};
+constexpr auto PageSize = std::size_t{4096};
+constexpr auto SpinsBeforeSleep = 64;
+constexpr auto PollInterval = std::chrono::microseconds{100};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "Indices shared between processes have to be lock-free");
+
+std::size_t align_up(std::size_t value, std::size_t alignment)
+{
+	return ((value + alignment - 1) / alignment) * alignment;
+}
+
+/**
+ * @brief Spins for a while, then polls with short sleeps until given condition holds or stop is requested
+ */
+template<typename Ready>
+bool wait_until(const std::atomic<bool>& stopped, Ready ready)
+{
+	for(auto spins = 0; !ready(); ++spins)
+	{
+		if(stopped.load(std::memory_order_relaxed))
+		{
+			return false;
+		}
+
+		if(spins < SpinsBeforeSleep)
+		{
+			std::this_thread::yield();
+		}
+		else
+		{
+			std::this_thread::sleep_for(PollInterval);
+		}
+	}
+
+	return true;
+}
+
+} // namespace
+
+/**
+ * @brief Beginning of shared memory, followed by frames infos, results entries and frames slots
+ * Indices only grow, so entry of frame or result N lives at N % slots.
+ *  Each index has its own cache line, as it is written by other process than its neighbours.
+ */
+struct ShmRing::Header
+{
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t slots;
+	std::uint32_t width;
+	std::uint32_t height;
+	std::uint64_t stride;
+	std::uint64_t slot_size;
+	std::uint64_t results_offset;
+	std::uint64_t frames_offset;
+
+	alignas(64) std::atomic<std::uint64_t> frames_head;  // Written by producer
+	alignas(64) std::atomic<std::uint64_t> frames_tail;  // Written by consumer
+	alignas(64) std::atomic<std::uint64_t> results_head; // Written by consumer
+	alignas(64) std::atomic<std::uint64_t> results_tail; // Written by producer
+	alignas(64) std::atomic<std::uint32_t> closed;       // Written by producer
+};
+
+struct ShmRing::FrameInfo
+{
+	std::uint64_t sequence;
+	std::uint32_t width;
+	std::uint32_t height;
+};
+
+struct ShmRing::ResultEntry
+{
+	std::uint64_t sequence;
+	std::uint32_t count;
+	std::uint32_t truncated;
+	std::int32_t logos[MaxLogos][4]; // x, y, width, height
+};
+
+ShmRing::ShmRing(const std::string& name, const Layout& layout)
+	:	m_name(name)
+	,	m_owner{true}
+	,	m_data{nullptr}
+	,	m_length{0}
+	,	m_header{nullptr}
+	,	m_stopped{false}
+{
+	CV_Assert(layout.slots > 0);
+	CV_Assert(layout.frame_size.width > 0 && layout.frame_size.height > 0);
+
+	// Rows are aligned for vectorized kernels, slots for mapping them page by page
+	const auto stride = align_up(layout.frame_size.width * BytesPerPixel, 64);
+	const auto slot_size = align_up(stride * layout.frame_size.height, PageSize);
+	const auto results_offset = align_up(sizeof(Header) + layout.slots * sizeof(FrameInfo), 64);
+	const auto frames_offset = align_up(results_offset + layout.slots * sizeof(ResultEntry), PageSize);
+	const auto length = (frames_offset + layout.slots * slot_size);
+
+	// Object left by crashed producer is replaced, same as stale socket files
+	::shm_unlink(name.c_str());
+	const auto fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+	if(fd < 0)
+	{
+		throw std::system_error(errno, std::generic_category(), "Could not create shared memory " + name);
+	}
+
+	if(::ftruncate(fd, static_cast<off_t>(length)) != 0)
+	{
+		const auto error = errno;
+		::close(fd);
+		::shm_unlink(name.c_str());
+		throw std::system_error(error, std::generic_category(), "Could not resize shared memory " + name);
+	}
+
+	try
+	{
+		map(fd, length);
+	}
+	catch(...)
+	{
+		::shm_unlink(name.c_str());
+		throw;
+	}
+
+	// Memory of new object is zeroed, but atomics still have to be constructed
+	m_header = new(m_data) Header{};
+	std::memcpy(m_header->magic, Magic, sizeof(Magic));
+	m_header->slots = static_cast<std::uint32_t>(layout.slots);
+	m_header->width = static_cast<std::uint32_t>(layout.frame_size.width);
+	m_header->height = static_cast<std::uint32_t>(layout.frame_size.height);
+	m_header->stride = stride;
+	m_header->slot_size = slot_size;
+	m_header->results_offset = results_offset;
+	m_header->frames_offset = frames_offset;
+	m_header->version = Version;
+}
+
+ShmRing::ShmRing(const std::string& name)
+	:	m_name(name)
+	,	m_owner{false}
+	,	m_data{nullptr}
+	,	m_length{0}
+	,	m_header{nullptr}
+	,	m_stopped{false}
+{
+	const auto fd = ::shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+	if(fd < 0)
+	{
+		throw std::system_error(errno, std::generic_category(), "Could not open shared memory " + name);
+	}
+
+	struct stat status;
+	if(::fstat(fd, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(Header)))
+	{
+		::close(fd);
+		throw std::runtime_error("Shared memory too short: " + name);
+	}
+
+	map(fd, static_cast<std::size_t>(status.st_size));
+	m_header = reinterpret_cast<Header*>(m_data);
+
+	// Header is written by other process, so sizes are checked by division, without overflowing
+	const auto& header = *m_header;
+	const auto valid = (std::memcmp(header.magic, Magic, sizeof(Magic)) == 0
+		&& header.version == Version
+		&& header.slots > 0
+		&& header.stride >= header.width * BytesPerPixel
+		&& (header.height == 0 || header.stride <= header.slot_size / header.height)
+		&& header.results_offset >= sizeof(Header) + header.slots * sizeof(FrameInfo)
+		&& header.frames_offset >= header.results_offset
+		&& header.slots <= (header.frames_offset - header.results_offset) / sizeof(ResultEntry)
+		&& header.frames_offset <= m_length
+		&& (header.slot_size == 0 || header.slots <= (m_length - header.frames_offset) / header.slot_size));
+	if(!valid)
+	{
+		::munmap(m_data, m_length);
+		throw std::runtime_error("Invalid shared memory rings: " + name);
+	}
+}
+
+ShmRing::~ShmRing()
+{
+	::munmap(m_data, m_length);
+	if(m_owner)
+	{
+		::shm_unlink(m_name.c_str());
+	}
+}
+
+cv::Size ShmRing::frame_size() const noexcept
+{
+	return cv::Size{static_cast<int>(m_header->width), static_cast<int>(m_header->height)};
+}
+
+std::size_t ShmRing::slots() const noexcept
+{
+	return static_cast<std::size_t>(m_header->slots);
+}
+
+std::optional<std::uint64_t> ShmRing::try_push_frame(const cv::Mat& bgr)
+{
+	CV_Assert(bgr.type() == CV_8UC3);
+	CV_Assert(bgr.cols <= static_cast<int>(m_header->width) && bgr.rows <= static_cast<int>(m_header->height));
+
+	const auto head = m_header->frames_head.load(std::memory_order_relaxed);
+	const auto tail = m_header->frames_tail.load(std::memory_order_acquire);
+	if(head - tail >= m_header->slots)
+	{
+		return std::nullopt;
+	}
+
+	auto* const slot = frame_slot(head);
+	const auto row_size = (bgr.cols * BytesPerPixel);
+	for(auto y = 0; y < bgr.rows; ++y)
+	{
+		std::memcpy(slot + y * m_header->stride, bgr.ptr(y), row_size);
+	}
+
+	auto& info = frame_info(head);
+	info.sequence = head;
+	info.width = static_cast<std::uint32_t>(bgr.cols);
+	info.height = static_cast<std::uint32_t>(bgr.rows);
+
+	m_header->frames_head.store(head + 1, std::memory_order_release);
+	return head;
+}
+
+std::optional<ShmRing::Result> ShmRing::try_pop_result()
+{
+	const auto tail = m_header->results_tail.load(std::memory_order_relaxed);
+	const auto head = m_header->results_head.load(std::memory_order_acquire);
+	if(tail == head)
+	{
+		return std::nullopt;
+	}
+
+	const auto& entry = result_entry(tail);
+	auto result = Result{entry.sequence, Logos(), (entry.truncated != 0)};
+	const auto count = std::min<std::size_t>(entry.count, MaxLogos);
+	result.logos.reserve(count);
+	for(auto i = std::size_t{0}; i < count; ++i)
+	{
+		const auto* const logo = entry.logos[i];
+		result.logos.emplace_back(logo[0], logo[1], logo[2], logo[3]);
+	}
+
+	m_header->results_tail.store(tail + 1, std::memory_order_release);
+	return result;
+}
+
+void ShmRing::close() noexcept
+{
+	m_header->closed.store(1, std::memory_order_release);
+}
+
+std::optional<ShmRing::Frame> ShmRing::wait_frame()
+{
+	const auto tail = m_header->frames_tail.load(std::memory_order_relaxed);
+	auto head = tail;
+	const auto ready = wait_until(m_stopped,
+		[this, tail, &head]()
+		{
+			// Closed flag is read before head, so frames pushed before closing are not missed
+			const auto closed = (m_header->closed.load(std::memory_order_acquire) != 0);
+			head = m_header->frames_head.load(std::memory_order_acquire);
+			return (head != tail || closed);
+		});
+
+	if(!ready || head == tail)
+	{
+		return std::nullopt;
+	}
+
+	const auto& info = frame_info(tail);
+	CV_Assert(info.width <= m_header->width && info.height <= m_header->height);
+	const auto size = cv::Size{static_cast<int>(info.width), static_cast<int>(info.height)};
+	return Frame{info.sequence, wrap_bgr_frame(frame_slot(tail), size, m_header->stride)};
+}
+
+void ShmRing::publish_result(const Logos& logos)
+{
+	const auto head = m_header->results_head.load(std::memory_order_relaxed);
+	const auto has_free_slot = wait_until(m_stopped,
+		[this, head]()
+		{
+			return (head - m_header->results_tail.load(std::memory_order_acquire) < m_header->slots);
+		});
+
+	if(!has_free_slot)
+	{
+		return;
+	}
+
+	const auto frame = m_header->frames_tail.load(std::memory_order_relaxed);
+	auto& entry = result_entry(head);
+	entry.sequence = frame_info(frame).sequence;
+	entry.count = static_cast<std::uint32_t>(std::min(logos.size(), MaxLogos));
+	entry.truncated = (logos.size() > MaxLogos) ? 1 : 0;
+	for(auto i = std::size_t{0}; i < entry.count; ++i)
+	{
+		const auto& logo = logos[i];
+		entry.logos[i][0] = logo.x;
+		entry.logos[i][1] = logo.y;
+		entry.logos[i][2] = logo.width;
+		entry.logos[i][3] = logo.height;
+	}
+
+	m_header->results_head.store(head + 1, std::memory_order_release);
+	m_header->frames_tail.store(frame + 1, std::memory_order_release);
+}
+
+void ShmRing::stop() noexcept
+{
+	m_stopped.store(true, std::memory_order_relaxed);
+}
+
+void ShmRing::map(int fd, std::size_t length)
+{
+	auto* const data = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if(data == MAP_FAILED)
+	{
+		throw std::system_error(errno, std::generic_category(), "Could not map shared memory " + m_name);
+	}
+
+	m_data = static_cast<unsigned char*>(data);
+	m_length = length;
+}
+
+ShmRing::FrameInfo& ShmRing::frame_info(std::uint64_t index) const noexcept
+{
+	auto* const infos = reinterpret_cast<FrameInfo*>(m_data + sizeof(Header));
+	return infos[index % m_header->slots];
+}
+
+ShmRing::ResultEntry& ShmRing::result_entry(std::uint64_t index) const noexcept
+{
+	auto* const entries = reinterpret_cast<ResultEntry*>(m_data + m_header->results_offset);
+	return entries[index % m_header->slots];
+}
+
+unsigned char* ShmRing::frame_slot(std::uint64_t index) const noexcept
+{
+	return (m_data + m_header->frames_offset + (index % m_header->slots) * m_header->slot_size);
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+#include <optional>
+#include <string>
+
+#include <opencv2/opencv.hpp>
+
+#include "LogoDetector.hpp"
+
+/**
+ * @brief Rings of frames and results in POSIX shared memory, for camera producers on the same host
+ * Producer copies frames into fixed-size slots, consumer detects logos directly in slot memory
+ *  and publishes them to the ring of results. Both rings have single producer and single consumer,
+ *  so their head and tail indices are advanced by atomic stores, without locks or syscalls.
+ *  Frame slot is released only after result of the frame is published.
+ */
+class ShmRing
+{
+public:
+	static constexpr auto MaxLogos = std::size_t{64};
+
+	struct Layout
+	{
+		std::size_t slots = 8;
+		cv::Size frame_size; // Maximal size of frames
+	};
+
+	struct Frame
+	{
+		std::uint64_t sequence;
+		cv::Mat img; // Refers to slot memory, valid until result is published
+	};
+
+	struct Result
+	{
+		std::uint64_t sequence;
+		Logos logos;
+		bool truncated; // More than MaxLogos logos were found
+	};
+
+	/**
+	 * @brief Creates shared memory object with given name (e.g. "/logos"), as producer
+	 * Existing object with the same name is replaced. Object is unlinked, when its creator is destroyed.
+	 */
+	ShmRing(const std::string& name, const Layout& layout);
+
+	/**
+	 * @brief Attaches to shared memory object created by other process, as consumer
+	 */
+	explicit ShmRing(const std::string& name);
+
+	~ShmRing();
+
+	ShmRing(const ShmRing&) = delete;
+	ShmRing& operator=(const ShmRing&) = delete;
+
+	cv::Size frame_size() const noexcept;
+
+	std::size_t slots() const noexcept;
+
+	/**
+	 * @brief Copies frame into free slot. Returns its sequence number, or nothing if all slots are taken
+	 */
+	std::optional<std::uint64_t> try_push_frame(const cv::Mat& bgr);
+
+	std::optional<Result> try_pop_result();
+
+	/**
+	 * @brief Marks end of stream. Consumer finishes, when it processes all frames pushed before
+	 */
+	void close() noexcept;
+
+	/**
+	 * @brief Waits for the oldest unprocessed frame
+	 * Returns nothing, when stream is closed and all its frames are processed, or when stopped.
+	 */
+	std::optional<Frame> wait_frame();
+
+	/**
+	 * @brief Publishes result of the frame returned by wait_frame() and releases its slot
+	 * Waits for free slot in the ring of results.
+	 */
+	void publish_result(const Logos& logos);
+
+	/**
+	 * @brief Wakes up waiting consumer, making it finish. May be called from any thread
+	 */
+	void stop() noexcept;
+
+private:
+	struct Header;
+	struct FrameInfo;
+	struct ResultEntry;
+
+	void map(int fd, std::size_t length);
+
+	FrameInfo& frame_info(std::uint64_t index) const noexcept;
+	ResultEntry& result_entry(std::uint64_t index) const noexcept;
+	unsigned char* frame_slot(std::uint64_t index) const noexcept;
+
+	std::string m_name;
+	bool m_owner;
+	unsigned char* m_data;
+	std::size_t m_length;
+	Header* m_header;
+	std::atomic<bool> m_stopped;
+};
@@ -0,0 +1,301 @@
+#include "StreamProcessor.hpp"
+
+#include <cctype>
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <thread>
+
+#include <spdlog/spdlog.h>
+
+#include "BoundedQueue.hpp"
+#include "drawing.hpp"
+#include "rawframes.hpp"
+#include "trace.hpp"
+
+namespace {
+
+struct Frame
+{
+	std::size_t index;
+	cv::Mat img;
+	Logos logos;
+	bool mapped = false; // Refers to read-only memory of raw frames file
+};
+
+using FrameQueue = BoundedQueue<Frame>;
+
+constexpr auto EscapeKey = 27;
+constexpr auto DefaultFps = 25.0;
+constexpr auto FpsReportInterval = std::size_t{100};
+
+bool is_camera_index(const std::string& src)
+{
+	return (!src.empty()
+		&& std::all_of(src.begin(), src.end(),
+		               [](unsigned char c) { return std::isdigit(c); }));
+}
+
+void open_capture(cv::VideoCapture& capture, const std::string& src)
+{
+	assert(!src.empty());
+
+	if(is_camera_index(src))
+	{
+		capture.open(std::stoi(src));
+	}
+	else
+	{
+		// Video file, image sequence pattern (e.g. "img_%02d.jpg") or device path
+		capture.open(src);
+	}
+
+	if(!capture.isOpened())
+	{
+		throw std::runtime_error("Could not open video source");
+	}
+}
+
+bool is_raw_frames_file(const std::string& src)
+{
+	return (std::filesystem::path{src}.extension() == ".frames");
+}
+
+/**
+ * @brief Reads next frame from the capture or, if given, from raw frames file, without copying it
+ */
+bool read_frame(cv::VideoCapture& capture, const RawFramesFile* raw_frames, std::size_t index, cv::Mat& img)
+{
+	if(raw_frames)
+	{
+		if(index >= raw_frames->size())
+		{
+			return false;
+		}
+
+		img = raw_frames->frame(index);
+		return true;
+	}
+
+	return (capture.read(img) && !img.empty());
+}
+
+double get_capture_fps(const cv::VideoCapture& capture)
+{
+	const auto fps = capture.get(cv::CAP_PROP_FPS);
+	return (fps > 0.0) ? fps : DefaultFps;
+}
+
+void write_frame(cv::VideoWriter& writer, const std::string& dst_file, double fps,
+                 cv::Size& size, const cv::Mat& img)
+{
+	if(!writer.isOpened())
+	{
+		size = img.size();
+		const auto fourcc = cv::VideoWriter::fourcc('M', 'J', 'P', 'G');
+		if(!writer.open(dst_file, fourcc, fps, size))
+		{
+			throw std::runtime_error("Could not open output video file");
+		}
+	}
+
+	if(img.size() != size)
+	{
+		// Image sequences may contain frames of different sizes
+		auto resized = cv::Mat();
+		cv::resize(img, resized, size);
+		writer.write(resized);
+	}
+	else
+	{
+		writer.write(img);
+	}
+}
+
+/**
+ * @brief Pops frame from the queue, recording time spent waiting for it
+ */
+std::optional<Frame> pop_frame(FrameQueue& queue)
+{
+	const auto span = trace::Span{"pop"};
+	return queue.pop();
+}
+
+/**
+ * @brief Pushes frame to the queue, recording time spent waiting for free space
+ */
+bool push_frame(FrameQueue& queue, Frame frame)
+{
+	const auto span = trace::Span{"push"};
+	return queue.push(std::move(frame));
+}
+
+/**
+ * @brief Runs given stage body, closing its queues when it finishes or fails
+ */
+template<typename Body>
+std::thread start_stage(const char* name, std::exception_ptr& error,
+                        FrameQueue& input, FrameQueue& output, Body body)
+{
+	return std::thread(
+		[name, &error, &input, &output, body = std::move(body)]() mutable
+		{
+			spdlog::debug("[StreamProcessor] Stage '{}' started", name);
+			trace::set_thread_name(name);
+			try
+			{
+				body();
+			}
+			catch(...)
+			{
+				error = std::current_exception();
+				input.close();
+			}
+
+			output.close();
+			spdlog::debug("[StreamProcessor] Stage '{}' finished", name);
+		});
+}
+
+} // namespace
+
+StreamProcessor::StreamProcessor(Options options, Detect detect)
+	:	m_options(std::move(options))
+	,	m_detect(std::move(detect))
+{}
+
+StreamProcessor::Stats StreamProcessor::run()
+{
+	spdlog::info("Opening video source...");
+	auto capture = cv::VideoCapture();
+	auto raw_frames = std::unique_ptr<RawFramesFile>();
+	if(is_raw_frames_file(m_options.src))
+	{
+		raw_frames = std::make_unique<RawFramesFile>(m_options.src);
+	}
+	else
+	{
+		open_capture(capture, m_options.src);
+	}
+
+	const auto fps = raw_frames ? DefaultFps : get_capture_fps(capture);
+
+	auto decoded = FrameQueue(m_options.queue_size);
+	auto detected = FrameQueue(m_options.queue_size);
+
+	auto decode_error = std::exception_ptr();
+	auto detect_error = std::exception_ptr();
+
+	auto decoder = start_stage("decode", decode_error, decoded, decoded,
+		[&capture, &raw_frames, &decoded]()
+		{
+			for(auto index = std::size_t{0}; ; ++index)
+			{
+				auto img = cv::Mat();
+				{
+					const auto span = trace::Span{"read"};
+					if(!read_frame(capture, raw_frames.get(), index, img))
+					{
+						break;
+					}
+				}
+
+				if(!push_frame(decoded, Frame{index, std::move(img), {}, (raw_frames != nullptr)}))
+				{
+					break;
+				}
+			}
+		});
+
+	auto detector = start_stage("detect", detect_error, decoded, detected,
+		[this, &decoded, &detected]()
+		{
+			while(auto frame = pop_frame(decoded))
+			{
+				{
+					const auto span = trace::Span{"detect"};
+					frame->logos = m_detect(frame->img);
+				}
+
+				if(!push_frame(detected, std::move(*frame)))
+				{
+					break;
+				}
+			}
+		});
+
+	// Annotation and encoding is done on the calling thread, as HighGUI requires it
+	auto writer = cv::VideoWriter();
+	auto writer_size = cv::Size();
+	auto stats = Stats{};
+	auto sink_error = std::exception_ptr();
+
+	const auto start = std::chrono::steady_clock::now();
+	const auto elapsed_seconds = [&start]() {
+		const auto elapsed = (std::chrono::steady_clock::now() - start);
+		return std::chrono::duration<double>(elapsed).count();
+	};
+
+	try
+	{
+		while(auto frame = pop_frame(detected))
+		{
+			{
+				const auto span = trace::Span{"draw"};
+				if(frame->mapped)
+				{
+					frame->img = frame->img.clone();
+				}
+
+				draw_logos(frame->img, frame->logos);
+			}
+
+			const auto span = trace::Span{"write"};
+			if(m_options.dst.empty())
+			{
+				cv::imshow("Output stream", frame->img);
+				if(cv::waitKey(1) == EscapeKey)
+				{
+					break;
+				}
+			}
+			else
+			{
+				write_frame(writer, m_options.dst, fps, writer_size, frame->img);
+			}
+
+			++stats.frames;
+			if(stats.frames % FpsReportInterval == 0)
+			{
+				spdlog::info("Processed {} frames ({:.1f} fps)",
+				             stats.frames, stats.frames / elapsed_seconds());
+			}
+		}
+	}
+	catch(...)
+	{
+		sink_error = std::current_exception();
+	}
+
+	// Unblock upstream stages, if sink finished before the end of stream
+	decoded.close();
+	detected.close();
+	decoder.join();
+	detector.join();
+
+	for(const auto& error : {sink_error, detect_error, decode_error})
+	{
+		if(error)
+		{
+			std::rethrow_exception(error);
+		}
+	}
+
+	stats.seconds = elapsed_seconds();
+	stats.fps = (stats.seconds > 0.0) ? (stats.frames / stats.seconds) : 0.0;
+	return stats;
+}
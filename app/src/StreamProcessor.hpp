@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+
+#include <functional>
+#include <string>
+
+#include <opencv2/opencv.hpp>
+
+#include "LogoDetector.hpp"
+
+/**
+ * @brief Runs logo detection over a video stream
+ * Decoding, detection and annotation/encoding are run as separate pipeline
+ *  stages, connected with bounded queues, so they may overlap in time.
+ *  Raw frames files (".frames") are memory-mapped and detected without decoding or copying.
+ */
+class StreamProcessor
+{
+public:
+	struct Options
+	{
+		std::string src;
+		std::string dst;
+		std::size_t queue_size = 4;
+	};
+
+	struct Stats
+	{
+		std::size_t frames = 0;
+		double seconds = 0.0;
+		double fps = 0.0;
+	};
+
+	using Detect = std::function<Logos(const cv::Mat&)>;
+
+	StreamProcessor(Options options, Detect detect);
+
+	Stats run();
+
+private:
+	Options m_options;
+	Detect m_detect;
+};
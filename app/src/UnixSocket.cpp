@@ -0,0 +1,187 @@
+#include "UnixSocket.hpp"
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include <stdexcept>
+#include <system_error>
+
+namespace {
+
+constexpr auto ReadChunkSize = std::size_t{64 * 1024};
+constexpr auto MaxLineSize = std::size_t{256 * 1024 * 1024};
+constexpr auto ListenBacklog = 64;
+
+sockaddr_un make_address(const std::string& path)
+{
+	auto address = sockaddr_un{};
+	if(path.size() >= sizeof(address.sun_path))
+	{
+		throw std::runtime_error("Socket path too long: " + path);
+	}
+
+	address.sun_family = AF_UNIX;
+	std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+	return address;
+}
+
+int open_socket()
+{
+	const auto fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if(fd < 0)
+	{
+		throw std::system_error(errno, std::generic_category(), "Could not create socket");
+	}
+
+	return fd;
+}
+
+} // namespace
+
+LineConnection::LineConnection(int fd) noexcept
+	:	m_fd{fd}
+{}
+
+LineConnection::~LineConnection()
+{
+	::close(m_fd);
+}
+
+std::optional<std::string> LineConnection::read_line()
+{
+	auto scanned = std::size_t{0};
+	while(true)
+	{
+		const auto end = m_buffer.find('\n', scanned);
+		if(end != std::string::npos)
+		{
+			auto line = m_buffer.substr(0, end);
+			m_buffer.erase(0, end + 1);
+			return line;
+		}
+
+		scanned = m_buffer.size();
+		if(scanned > MaxLineSize)
+		{
+			m_buffer.clear();
+			return std::nullopt;
+		}
+
+		m_buffer.resize(scanned + ReadChunkSize);
+		const auto received = ::recv(m_fd, &m_buffer[scanned], ReadChunkSize, 0);
+		if(received < 0 && errno == EINTR)
+		{
+			m_buffer.resize(scanned);
+			continue;
+		}
+
+		if(received <= 0)
+		{
+			// Incomplete last line is dropped, same as on errors
+			m_buffer.clear();
+			return std::nullopt;
+		}
+
+		m_buffer.resize(scanned + static_cast<std::size_t>(received));
+	}
+}
+
+bool LineConnection::write_line(const std::string& line)
+{
+	const auto lock = std::lock_guard<std::mutex>(m_write_mutex);
+
+	const auto message = (line + '\n');
+	auto sent = std::size_t{0};
+	while(sent < message.size())
+	{
+		// Closed peer is reported as error, instead of SIGPIPE
+		const auto result = ::send(m_fd, message.data() + sent, message.size() - sent, MSG_NOSIGNAL);
+		if(result < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if(result <= 0)
+		{
+			return false;
+		}
+
+		sent += static_cast<std::size_t>(result);
+	}
+
+	return true;
+}
+
+void LineConnection::shutdown_reading() noexcept
+{
+	::shutdown(m_fd, SHUT_RD);
+}
+
+UnixSocketListener::UnixSocketListener(const std::string& path)
+	:	m_path(path)
+	,	m_fd{open_socket()}
+{
+	const auto address = make_address(path);
+
+	// Socket file left by previous, not cleanly stopped server would fail binding.
+	//  Other files are kept, so a mistyped path fails binding instead of deleting them
+	struct stat status;
+	if(::lstat(path.c_str(), &status) == 0 && S_ISSOCK(status.st_mode))
+	{
+		::unlink(path.c_str());
+	}
+	if(::bind(m_fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0
+		|| ::listen(m_fd, ListenBacklog) != 0)
+	{
+		const auto error = errno;
+		::close(m_fd);
+		throw std::system_error(error, std::generic_category(), "Could not listen on socket " + path);
+	}
+}
+
+UnixSocketListener::~UnixSocketListener()
+{
+	::close(m_fd);
+	::unlink(m_path.c_str());
+}
+
+int UnixSocketListener::accept()
+{
+	while(true)
+	{
+		const auto fd = ::accept4(m_fd, nullptr, nullptr, SOCK_CLOEXEC);
+		if(fd >= 0)
+		{
+			return fd;
+		}
+
+		if(errno != EINTR && errno != ECONNABORTED)
+		{
+			return -1;
+		}
+	}
+}
+
+void UnixSocketListener::shutdown() noexcept
+{
+	::shutdown(m_fd, SHUT_RDWR);
+}
+
+int connect_unix_socket(const std::string& path)
+{
+	const auto address = make_address(path);
+	const auto fd = open_socket();
+	if(::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+	{
+		const auto error = errno;
+		::close(fd);
+		throw std::system_error(error, std::generic_category(), "Could not connect to socket " + path);
+	}
+
+	return fd;
+}
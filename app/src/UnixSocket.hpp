@@ -0,0 +1,73 @@
+#pragma once
+
+#include <mutex>
+#include <optional>
+#include <string>
+
+/**
+ * @brief Connected stream socket, exchanging newline-terminated messages
+ * Reading and writing may be done from different threads. Writes are serialized,
+ *  so whole lines are never interleaved.
+ */
+class LineConnection
+{
+public:
+	explicit LineConnection(int fd) noexcept;
+	~LineConnection();
+
+	LineConnection(const LineConnection&) = delete;
+	LineConnection& operator=(const LineConnection&) = delete;
+
+	/**
+	 * @brief Returns next line (without terminator) or nothing, when peer closed connection
+	 * Overlong lines are treated as protocol error, closing the connection.
+	 */
+	std::optional<std::string> read_line();
+
+	/**
+	 * @brief Writes line with terminator. Returns false, if peer closed connection
+	 */
+	bool write_line(const std::string& line);
+
+	/**
+	 * @brief Unblocks pending reads, e.g. when server is stopped. Writing is still possible
+	 */
+	void shutdown_reading() noexcept;
+
+private:
+	int m_fd;
+	std::string m_buffer;
+	std::mutex m_write_mutex;
+};
+
+/**
+ * @brief Listening Unix domain socket. Socket file is removed when listener is destroyed
+ */
+class UnixSocketListener
+{
+public:
+	explicit UnixSocketListener(const std::string& path);
+	~UnixSocketListener();
+
+	UnixSocketListener(const UnixSocketListener&) = delete;
+	UnixSocketListener& operator=(const UnixSocketListener&) = delete;
+
+	/**
+	 * @brief Waits for next client. Returns descriptor of its socket or -1, when listener was shut down
+	 */
+	int accept();
+
+	/**
+	 * @brief Unblocks pending accept
+	 */
+	void shutdown() noexcept;
+
+private:
+	std::string m_path;
+	int m_fd;
+};
+
+/**
+ * @brief Connects to Unix domain socket at given path. Returns descriptor of connected socket
+ */
+int connect_unix_socket(const std::string& path);
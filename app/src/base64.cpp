@@ -0,0 +1,92 @@
+#include "base64.hpp"
+
+#include <array>
+#include <stdexcept>
+
+namespace {
+
+constexpr auto Alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+constexpr auto InvalidDigit = -1;
+
+std::array<int, 256> make_digits_table()
+{
+	auto digits = std::array<int, 256>();
+	digits.fill(InvalidDigit);
+	for(auto i = 0; i < 64; ++i)
+	{
+		digits[static_cast<unsigned char>(Alphabet[i])] = i;
+	}
+
+	return digits;
+}
+
+} // namespace
+
+std::string encode_base64(const std::string& data)
+{
+	auto text = std::string();
+	text.reserve(((data.size() + 2) / 3) * 4);
+
+	auto i = std::size_t{0};
+	for(; i + 2 < data.size(); i += 3)
+	{
+		const auto bits = (static_cast<unsigned char>(data[i]) << 16)
+			| (static_cast<unsigned char>(data[i + 1]) << 8)
+			| static_cast<unsigned char>(data[i + 2]);
+		text += Alphabet[(bits >> 18) & 63];
+		text += Alphabet[(bits >> 12) & 63];
+		text += Alphabet[(bits >> 6) & 63];
+		text += Alphabet[bits & 63];
+	}
+
+	const auto left = (data.size() - i);
+	if(left > 0)
+	{
+		auto bits = (static_cast<unsigned char>(data[i]) << 16);
+		if(left == 2)
+		{
+			bits |= (static_cast<unsigned char>(data[i + 1]) << 8);
+		}
+
+		text += Alphabet[(bits >> 18) & 63];
+		text += Alphabet[(bits >> 12) & 63];
+		text += (left == 2) ? Alphabet[(bits >> 6) & 63] : '=';
+		text += '=';
+	}
+
+	return text;
+}
+
+std::string decode_base64(const std::string& text)
+{
+	static const auto digits = make_digits_table();
+
+	auto data = std::string();
+	data.reserve((text.size() / 4) * 3);
+
+	auto bits = 0u;
+	auto bits_count = 0;
+	for(const auto c : text)
+	{
+		if(c == '=')
+		{
+			break;
+		}
+
+		const auto digit = digits[static_cast<unsigned char>(c)];
+		if(digit == InvalidDigit)
+		{
+			throw std::runtime_error("Invalid Base64 character");
+		}
+
+		bits = ((bits << 6) | static_cast<unsigned>(digit));
+		bits_count += 6;
+		if(bits_count >= 8)
+		{
+			bits_count -= 8;
+			data += static_cast<char>((bits >> bits_count) & 0xFF);
+		}
+	}
+
+	return data;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <string>
+
+/**
+ * @brief Encodes binary data with standard Base64 alphabet, with padding
+ */
+std::string encode_base64(const std::string& data);
+
+/**
+ * @brief Decodes Base64 text (padding is optional). Throws on invalid characters
+ */
+std::string decode_base64(const std::string& text);
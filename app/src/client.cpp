@@ -0,0 +1,149 @@
+#include <cstdio>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include <CLI/CLI.hpp>
+
+#include "UnixSocket.hpp"
+#include "base64.hpp"
+
+namespace {
+
+std::string read_file(const std::string& path)
+{
+	auto ifs = std::ifstream(path, std::ios::binary);
+	if(!ifs)
+	{
+		throw std::runtime_error("Could not open image file: " + path);
+	}
+
+	return std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+}
+
+std::string make_request(std::size_t id, const std::string& src_file, bool send_inline,
+                         const std::string& config_file)
+{
+	auto request = nlohmann::json{{"id", id}};
+	if(send_inline)
+	{
+		request["image"] = encode_base64(read_file(src_file));
+	}
+	else
+	{
+		request["path"] = src_file;
+	}
+
+	if(!config_file.empty())
+	{
+		request["config"] = config_file;
+	}
+
+	return request.dump();
+}
+
+} // namespace
+
+/**
+ * Sends images to running detection server (see `find_logos --serve`) and prints its responses.
+ * All requests are sent over single connection without waiting for responses, so the server
+ *  may handle them concurrently.
+ */
+int main(int argc, char** argv)
+{
+	CLI::App cli{"Sends images to detection server and prints found logos"};
+
+	auto src_files = std::vector<std::string>();
+	cli.add_option("src", src_files, "Paths to input images")
+		->required()
+		->check(CLI::ExistingFile);
+
+	auto socket_path = std::string();
+	cli.add_option("--socket", socket_path, "Path to Unix domain socket of the server")
+		->required();
+
+	auto send_inline = false;
+	cli.add_flag("--inline", send_inline,
+	             "Sends contents of image files, instead of their paths (e.g. when server runs in other file system)");
+
+	auto config_file = std::string();
+	cli.add_option("--cfg", config_file, "Path for configuration JSON file, as seen by the server");
+
+	CLI11_PARSE(cli, argc, argv);
+
+	try
+	{
+		auto connection = LineConnection{connect_unix_socket(socket_path)};
+
+		// Requests are sent on separate thread, so full socket buffers may not block both sides
+		auto send_error = std::string();
+		auto sender = std::thread(
+			[&connection, &src_files, send_inline, &config_file, &send_error]()
+			{
+				try
+				{
+					for(auto i = std::size_t{0}; i < src_files.size(); ++i)
+					{
+						if(!connection.write_line(make_request(i, src_files[i], send_inline, config_file)))
+						{
+							send_error = "Server closed connection";
+							break;
+						}
+					}
+				}
+				catch(std::exception& ex)
+				{
+					send_error = ex.what();
+				}
+
+				if(!send_error.empty())
+				{
+					// Responses to the requests, which were not sent, would never come
+					connection.shutdown_reading();
+				}
+			});
+
+		auto failed = std::size_t{0};
+		auto received = std::size_t{0};
+		for(; received < src_files.size(); ++received)
+		{
+			const auto line = connection.read_line();
+			if(!line)
+			{
+				break;
+			}
+
+			const auto response = nlohmann::json::parse(*line);
+			const auto id = response.at("id").get<std::size_t>();
+			if(response.count("error") > 0)
+			{
+				++failed;
+			}
+
+			printf("%s: %s\n", src_files.at(id).c_str(), line->c_str());
+		}
+
+		sender.join();
+		if(!send_error.empty())
+		{
+			throw std::runtime_error(send_error);
+		}
+
+		if(received < src_files.size())
+		{
+			throw std::runtime_error("Server closed connection before all responses were received");
+		}
+
+		return (failed == 0) ? 0 : -1;
+	}
+	catch(std::exception& ex)
+	{
+		printf("Error: %s\n", ex.what());
+		return -1;
+	}
+}
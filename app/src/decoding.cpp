@@ -0,0 +1,52 @@
+#include "decoding.hpp"
+
+#include <fstream>
+#include <stdexcept>
+
+int get_decode_flags(int reduce)
+{
+	switch(reduce)
+	{
+		case 1: return cv::IMREAD_COLOR;
+		case 2: return cv::IMREAD_REDUCED_COLOR_2;
+		case 4: return cv::IMREAD_REDUCED_COLOR_4;
+		case 8: return cv::IMREAD_REDUCED_COLOR_8;
+	}
+
+	throw std::invalid_argument("Unsupported decoding reduction factor");
+}
+
+std::string read_file_bytes(const std::string& path)
+{
+	auto ifs = std::ifstream(path, std::ios::binary | std::ios::ate);
+	if(!ifs)
+	{
+		throw std::runtime_error("Could not open image file");
+	}
+
+	auto bytes = std::string(static_cast<std::size_t>(ifs.tellg()), '\0');
+	ifs.seekg(0);
+	if(!ifs.read(&bytes[0], static_cast<std::streamsize>(bytes.size())))
+	{
+		throw std::runtime_error("Could not read image file");
+	}
+
+	return bytes;
+}
+
+cv::Mat decode_image_bytes(const std::string& bytes, int flags)
+{
+	if(bytes.empty())
+	{
+		throw std::runtime_error("Could not decode image");
+	}
+
+	const auto encoded = cv::Mat(1, static_cast<int>(bytes.size()), CV_8UC1, const_cast<char*>(bytes.data()));
+	auto img = cv::imdecode(encoded, flags);
+	if(img.empty())
+	{
+		throw std::runtime_error("Could not decode image");
+	}
+
+	return img;
+}
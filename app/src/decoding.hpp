@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief Returns flags of cv::imread and cv::imdecode, decoding colour image downsampled by given factor
+ * JPEG decoder skips work for reduced sizes, so decoding at 1/2, 1/4 or 1/8 is much faster.
+ *
+ * @param reduce one of 1, 2, 4 or 8
+ */
+int get_decode_flags(int reduce);
+
+/**
+ * @brief Reads whole file into memory, e.g. to hash its bytes before decoding
+ */
+std::string read_file_bytes(const std::string& path);
+
+/**
+ * @brief Decodes image from encoded file bytes (PNG, JPEG, ...) with given flags. Throws, if bytes are not an image
+ */
+cv::Mat decode_image_bytes(const std::string& bytes, int flags);
@@ -1,5 +1,11 @@
+#include <pthread.h>
+#include <signal.h>
+
 #include <cstdio>
 
+#include <algorithm>
+#include <thread>
+
 #include "PepsiDetector.hpp"
 
 #include <spdlog/spdlog.h>
@@ -9,18 +15,73 @@
 
 #include "Application.hpp"
 #include "imglog.hpp"
+#include "trace.hpp"
 
 int main(int argc, char** argv)
 {
     CLI::App cli{"Finds logo of PEPSI drink in images and marks them"};
 
     auto app_options = Application::Options{};
+    app_options.workers = std::max(1u, std::thread::hardware_concurrency());
     cli.add_option("--src,src", app_options.src_file,
                    "Path to existing input file")
-        ->required()
         ->check(CLI::ExistingFile);
+    cli.add_flag("--pyramid", app_options.pyramid,
+                 "Finds candidate regions on downsampled image first, then detects logos only inside them");
+    cli.add_set("--precheck", app_options.precheck, {"off", "estimate", "guarantee"},
+                "Rejects images without enough blue or red pixels on a sparse grid before detection. 'guarantee' never changes results, 'estimate' is cheaper, but may miss small logos");
+    cli.add_set("--reduce", app_options.reduce, {1, 2, 4, 8},
+                "Decodes images downsampled by given factor, with config scaled to match. Logos are reported in full resolution coordinates", true);
+    cli.add_flag("--stats", app_options.stats,
+                 "Prints time spent in each detection stage and numbers of blobs left after each filter");
+    cli.add_option("--video", app_options.video_src,
+                   "Video file, image sequence pattern (e.g. img_%d.jpg), raw frames file (.frames) or camera index to process as a stream");
+    cli.add_option("--queue-size", app_options.queue_size,
+                   "Capacity of queues between stream pipeline stages", true)
+        ->check(CLI::Range(1, 1024));
+    cli.add_flag("--track", app_options.track,
+                 "In stream mode, searches for logos only around logos from previous frame, except keyframes");
+    cli.add_option("--keyframe-interval", app_options.keyframe_interval,
+                   "In tracking mode, number of frames between full frame detections", true)
+        ->check(CLI::Range(1, 10000));
+    cli.add_option("--batch", app_options.batch_inputs,
+                   "Image files, directories (searched recursively) or globs (e.g. 'images/*.jpg') to process in batch mode");
+    cli.add_option("--manifest", app_options.manifest_file,
+                   "File with paths of images to process in batch mode, one per line")
+        ->check(CLI::ExistingFile);
+    cli.add_option("--workers", app_options.workers,
+                   "In batch and server modes, number of threads detecting logos", true)
+        ->check(CLI::Range(1, 1024));
+    cli.add_option("--read-ahead", app_options.read_ahead,
+                   "In batch mode, number of images decoded ahead of detection (pending requests in server mode)", true)
+        ->check(CLI::Range(1, 4096));
+    cli.add_set("--format", app_options.output_format, {"ndjson", "csv"},
+                "In batch mode, format of results lines", true);
+    cli.add_option("--output", app_options.output_file,
+                   "Path for results file (JSON or CSV lines), or '-' for stdout. In batch mode, results are written to stdout if ommited. For single image, only results are written, unless --dst is given too");
+    cli.add_flag("--parts", app_options.parts,
+                 "Adds rectangles and areas of blue and red parts of each logo to JSON results");
+    cli.add_option("--annotators", app_options.annotators,
+                   "In batch mode, number of threads drawing and encoding annotated images", true)
+        ->check(CLI::Range(1, 1024));
+    cli.add_option("--cache", app_options.cache_size,
+                   "In batch and server modes, caches results of given number of images in memory, keyed by hash of their content and of the config")
+        ->check(CLI::Range(0, 100000000));
+    cli.add_option("--cache-dir", app_options.cache_dir,
+                   "In batch and server modes, stores cached results in given directory too, so they are reused by later runs");
+    cli.add_option("--serve", app_options.serve,
+                   "Runs as detection server, accepting JSON requests on Unix domain socket at given path (or on stdin, if '-')");
+    cli.add_option("--shm", app_options.shm,
+                   "Detects logos in frames from shared memory rings with given name (e.g. /pepsi_logos), created by camera producer");
+    cli.add_option("--dump-dir", app_options.dump_dir,
+                   "Writes images of detection stages to given directory, on a background thread");
+    cli.add_option("--dump-every", app_options.dump_every,
+                   "In stream mode, dumps stages images only of every Nth frame", true)
+        ->check(CLI::Range(1, 1000000));
+    cli.add_option("--trace", app_options.trace_file,
+                   "Writes spans of all processing steps to given file, in Chrome Trace Event format");
     cli.add_option("--dst,dst", app_options.dst_file,
-                   "Path for output file. If ommited, displays image in a window");
+                   "Path for output file (directory in batch mode). If ommited, displays image in a window (does not draw anything in batch mode)");
     cli.add_option("--cfg,cfg", app_options.config_file,
                    "Path for configuration JSON file. If ommited, searches for them in image directory");
 
@@ -30,21 +91,78 @@ int main(int argc, char** argv)
 
     CLI11_PARSE(cli, argc, argv);
 
+    const auto batch_mode = (!app_options.batch_inputs.empty() || !app_options.manifest_file.empty());
+    if(app_options.src_file.empty() && app_options.video_src.empty() && !batch_mode
+        && app_options.serve.empty() && app_options.shm.empty())
+    {
+        printf("Error: one of --src, --video, --batch, --manifest, --serve or --shm must be given\n");
+        return -1;
+    }
+
+    if(app_options.reduce > 1 && (!app_options.video_src.empty() || !app_options.shm.empty()))
+    {
+        printf("Error: --reduce is supported only for image files, not for --video or --shm\n");
+        return -1;
+    }
+
+    if((batch_mode && app_options.output_file.empty()) || app_options.output_file == "-" || app_options.serve == "-")
+    {
+        // Results are written to stdout, so diagnostic messages go elsewhere
+        spdlog::set_default_logger(spdlog::stderr_color_mt("stderr"));
+    }
+
     if(verbose)
     {
         spdlog::set_level(spdlog::level::debug);
-        imglog::enable();
     }
     else
     {
         spdlog::set_level(spdlog::level::info);
-        imglog::disable();
+    }
+
+    if(!app_options.serve.empty() || !app_options.shm.empty())
+    {
+        // Stop signals are awaited by watcher thread. They are blocked before any thread (e.g. dump writer)
+        //  is started, as threads inherit the mask and signal delivered to them would kill the process
+        auto stop_signals = sigset_t{};
+        sigemptyset(&stop_signals);
+        sigaddset(&stop_signals, SIGINT);
+        sigaddset(&stop_signals, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &stop_signals, nullptr);
     }
 
     try
     {
+        if(!app_options.dump_dir.empty())
+        {
+            auto dump_options = imglog::DumpOptions{};
+            dump_options.directory = app_options.dump_dir;
+            dump_options.every_nth_frame = app_options.dump_every;
+            imglog::enable_dump(dump_options);
+        }
+        else if(verbose)
+        {
+            imglog::enable();
+        }
+
+        if(!app_options.trace_file.empty())
+        {
+            trace::set_thread_name("main");
+            trace::enable();
+        }
+
         auto app = Application{app_options};
-        return app.exec();
+        const auto result = app.exec();
+
+        if(!app_options.trace_file.empty())
+        {
+            trace::disable();
+            trace::write(app_options.trace_file);
+        }
+
+        // Waits for pending images to be written
+        imglog::disable();
+        return result;
     }
     catch(std::exception& ex)
     {
@@ -0,0 +1,127 @@
+#include <cstdio>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include <CLI/CLI.hpp>
+
+namespace {
+
+std::vector<cv::Mat> read_images(const std::vector<std::string>& src_files)
+{
+	auto images = std::vector<cv::Mat>();
+	images.reserve(src_files.size());
+
+	for(const auto& src_file : src_files)
+	{
+		auto img = cv::imread(src_file, cv::IMREAD_COLOR);
+		if(img.empty())
+		{
+			throw std::runtime_error("Image input file invalid: " + src_file);
+		}
+
+		images.push_back(std::move(img));
+	}
+
+	return images;
+}
+
+cv::Size get_max_size(const std::vector<cv::Mat>& images)
+{
+	auto size = cv::Size{0, 0};
+	for(const auto& img : images)
+	{
+		size.width = std::max(size.width, img.cols);
+		size.height = std::max(size.height, img.rows);
+	}
+
+	return size;
+}
+
+/**
+ * @brief Returns horizontal offset of the image, moving it back and forth
+ */
+int get_offset(int frame, int amplitude)
+{
+	if(amplitude == 0)
+	{
+		return 0;
+	}
+
+	const auto period = (4 * amplitude);
+	const auto phase = (frame % period);
+	return (phase < 2*amplitude) ? phase : (period - phase);
+}
+
+} // namespace
+
+/**
+ * Generates test video clip from still images, so stream mode may be tested without a camera.
+ * Images are not rescaled (it would change shapes of logos), but they are pasted
+ *  into the common canvas and slowly moved horizontally, to simulate camera motion.
+ */
+int main(int argc, char** argv)
+{
+	CLI::App cli{"Generates test video clip from still images"};
+
+	auto src_files = std::vector<std::string>();
+	cli.add_option("src", src_files, "Paths to input images")
+		->required()
+		->check(CLI::ExistingFile);
+
+	auto dst_file = std::string();
+	cli.add_option("--dst", dst_file, "Path to output video file (MJPG in AVI container)")
+		->required();
+
+	auto frames_per_image = 25;
+	cli.add_option("--frames", frames_per_image, "Number of frames per each image", true)
+		->check(CLI::Range(1, 10000));
+
+	auto amplitude = 8;
+	cli.add_option("--motion", amplitude, "Amplitude of simulated motion in pixels", true)
+		->check(CLI::Range(0, 256));
+
+	auto fps = 25.0;
+	cli.add_option("--fps", fps, "Frame rate of output video", true);
+
+	CLI11_PARSE(cli, argc, argv);
+
+	try
+	{
+		const auto images = read_images(src_files);
+		const auto max_size = get_max_size(images);
+		const auto canvas_size = cv::Size{max_size.width + 2*amplitude, max_size.height};
+
+		const auto fourcc = cv::VideoWriter::fourcc('M', 'J', 'P', 'G');
+		auto writer = cv::VideoWriter(dst_file, fourcc, fps, canvas_size);
+		if(!writer.isOpened())
+		{
+			throw std::runtime_error("Could not open output video file");
+		}
+
+		auto frame = 0;
+		for(const auto& img : images)
+		{
+			const auto y = ((canvas_size.height - img.rows) / 2);
+			const auto x0 = ((max_size.width - img.cols) / 2);
+			for(auto i = 0; i < frames_per_image; ++i, ++frame)
+			{
+				auto canvas = cv::Mat(canvas_size, CV_8UC3, cv::Scalar{0, 0, 0});
+				const auto x = (x0 + get_offset(frame, amplitude));
+				img.copyTo(canvas(cv::Rect{x, y, img.cols, img.rows}));
+				writer.write(canvas);
+			}
+		}
+
+		printf("Written %d frames of size %dx%d\n", frame, canvas_size.width, canvas_size.height);
+		return 0;
+	}
+	catch(std::exception& ex)
+	{
+		printf("Error: %s\n", ex.what());
+		return -1;
+	}
+}
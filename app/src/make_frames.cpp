@@ -0,0 +1,57 @@
+#include <cstdio>
+
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include <CLI/CLI.hpp>
+
+#include "rawframes.hpp"
+
+/**
+ * Converts still images (e.g. JPEGs from assets) into raw frames container, so they may be
+ *  replayed and benchmarked without decoding. Frames are named after paths of source images.
+ */
+int main(int argc, char** argv)
+{
+	CLI::App cli{"Converts images into raw frames container"};
+
+	auto src_files = std::vector<std::string>();
+	cli.add_option("src", src_files, "Paths to input images")
+		->required()
+		->check(CLI::ExistingFile);
+
+	auto dst_file = std::string();
+	cli.add_option("--dst", dst_file, "Path to output raw frames file")
+		->required();
+
+	CLI11_PARSE(cli, argc, argv);
+
+	try
+	{
+		auto frames = std::vector<RawFrame>();
+		frames.reserve(src_files.size());
+
+		for(const auto& src_file : src_files)
+		{
+			auto img = cv::imread(src_file, cv::IMREAD_COLOR);
+			if(img.empty())
+			{
+				throw std::runtime_error("Image input file invalid: " + src_file);
+			}
+
+			frames.push_back(RawFrame{src_file, std::move(img)});
+		}
+
+		write_raw_frames(dst_file, frames);
+
+		printf("Written %zu frames\n", frames.size());
+		return 0;
+	}
+	catch(std::exception& ex)
+	{
+		printf("Error: %s\n", ex.what());
+		return -1;
+	}
+}
@@ -0,0 +1,60 @@
+#include "results.hpp"
+
+#include "points.hpp"
+
+namespace {
+
+nlohmann::json format_rect(const Rect& rect)
+{
+	return nlohmann::json::array({rect.x, rect.y, rect.width, rect.height});
+}
+
+nlohmann::json format_part(const LogoPart& part)
+{
+	return nlohmann::json{
+		{"rect", format_rect(part.rect)},
+		{"area", part.area},
+	};
+}
+
+} // namespace
+
+nlohmann::json format_logos(const Detections& detections)
+{
+	auto json = nlohmann::json::array();
+	for(const auto& detection : detections)
+	{
+		json.push_back(format_rect(detection.logo));
+	}
+
+	return json;
+}
+
+nlohmann::json format_parts(const Detections& detections)
+{
+	auto json = nlohmann::json::array();
+	for(const auto& detection : detections)
+	{
+		json.push_back({
+			{"blue", format_part(detection.blue)},
+			{"red", format_part(detection.red)},
+		});
+	}
+
+	return json;
+}
+
+Detections scale_detections(Detections detections, int factor)
+{
+	for(auto& detection : detections)
+	{
+		detection.logo = scale_rect(detection.logo, factor);
+		for(auto* part : {&detection.blue, &detection.red})
+		{
+			part->rect = scale_rect(part->rect, factor);
+			part->area *= (factor * factor);
+		}
+	}
+
+	return detections;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include "PepsiDetector.hpp"
+
+/**
+ * @brief Formats logos as array of [x, y, width, height] arrays
+ */
+nlohmann::json format_logos(const Detections& detections);
+
+/**
+ * @brief Formats parts of each logo, as {"blue": {"rect": [x, y, width, height], "area": pixels}, "red": {...}}
+ */
+nlohmann::json format_parts(const Detections& detections);
+
+/**
+ * @brief Maps detections from image downsampled by factor to full resolution
+ */
+Detections scale_detections(Detections detections, int factor);
@@ -0,0 +1,179 @@
+#include <cinttypes>
+#include <cstdio>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include <CLI/CLI.hpp>
+
+#include "ShmRing.hpp"
+#include "rawframes.hpp"
+
+namespace {
+
+constexpr auto PollInterval = std::chrono::microseconds{100};
+
+std::vector<cv::Mat> read_frames(const std::vector<std::string>& src_files)
+{
+	auto frames = std::vector<cv::Mat>();
+	for(const auto& src_file : src_files)
+	{
+		if(std::filesystem::path{src_file}.extension() == ".frames")
+		{
+			// Frames are copied out, as the file is closed before streaming
+			const auto raw_frames = RawFramesFile{src_file};
+			for(auto i = std::size_t{0}; i < raw_frames.size(); ++i)
+			{
+				frames.push_back(raw_frames.frame(i).clone());
+			}
+
+			continue;
+		}
+
+		auto img = cv::imread(src_file, cv::IMREAD_COLOR);
+		if(img.empty())
+		{
+			throw std::runtime_error("Image input file invalid: " + src_file);
+		}
+
+		frames.push_back(std::move(img));
+	}
+
+	return frames;
+}
+
+cv::Size get_max_size(const std::vector<cv::Mat>& frames)
+{
+	auto size = cv::Size{0, 0};
+	for(const auto& frame : frames)
+	{
+		size.width = std::max(size.width, frame.cols);
+		size.height = std::max(size.height, frame.rows);
+	}
+
+	return size;
+}
+
+void print_result(const ShmRing::Result& result)
+{
+	printf("Frame %" PRIu64 ": %zu logos%s", result.sequence, result.logos.size(),
+	       result.truncated ? " (truncated)" : "");
+	for(const auto& logo : result.logos)
+	{
+		printf(" [%d, %d, %d, %d]", logo.x, logo.y, logo.width, logo.height);
+	}
+
+	printf("\n");
+}
+
+} // namespace
+
+/**
+ * Feeds frames into shared memory rings, as a camera capture process would, and prints results
+ *  published by "find_logos --shm". Frames are read from images or raw frames files upfront,
+ *  and streamed in a loop. When all slots are taken, producer waits, unless dropping is enabled.
+ */
+int main(int argc, char** argv)
+{
+	CLI::App cli{"Streams frames to logo detector through shared memory"};
+
+	auto src_files = std::vector<std::string>();
+	cli.add_option("src", src_files, "Paths to input images or raw frames files (.frames)")
+		->required()
+		->check(CLI::ExistingFile);
+
+	auto name = std::string("/pepsi_logos");
+	cli.add_option("--shm", name, "Name of shared memory object", true);
+
+	auto slots = std::size_t{8};
+	cli.add_option("--slots", slots, "Number of frame slots in the ring", true)
+		->check(CLI::Range(1, 1024));
+
+	auto repeat = 1;
+	cli.add_option("--repeat", repeat, "Number of times frames are streamed", true)
+		->check(CLI::Range(1, 1000000));
+
+	auto drop = false;
+	cli.add_flag("--drop", drop, "Drops frames when all slots are taken, instead of waiting for detector");
+
+	auto quiet = false;
+	cli.add_flag("-q,--quiet", quiet, "Prints only summary, not results of each frame");
+
+	CLI11_PARSE(cli, argc, argv);
+
+	try
+	{
+		const auto frames = read_frames(src_files);
+		if(frames.empty())
+		{
+			throw std::runtime_error("No frames to stream");
+		}
+
+		auto layout = ShmRing::Layout{};
+		layout.slots = slots;
+		layout.frame_size = get_max_size(frames);
+		auto ring = ShmRing{name, layout};
+
+		printf("Created %s with %zu slots of %dx%d frames, waiting for detector...\n",
+		       name.c_str(), slots, layout.frame_size.width, layout.frame_size.height);
+
+		auto dropped = std::size_t{0};
+		auto received = std::size_t{0};
+		const auto drain_results = [&ring, &received, quiet]()
+		{
+			while(const auto result = ring.try_pop_result())
+			{
+				++received;
+				if(!quiet)
+				{
+					print_result(*result);
+				}
+			}
+		};
+
+		const auto start = std::chrono::steady_clock::now();
+		for(auto i = 0; i < repeat; ++i)
+		{
+			for(const auto& frame : frames)
+			{
+				while(!ring.try_push_frame(frame))
+				{
+					drain_results();
+					if(drop)
+					{
+						++dropped;
+						break;
+					}
+
+					std::this_thread::sleep_for(PollInterval);
+				}
+
+				drain_results();
+			}
+		}
+
+		const auto pushed = (repeat * frames.size() - dropped);
+		ring.close();
+		while(received < pushed)
+		{
+			drain_results();
+			std::this_thread::sleep_for(PollInterval);
+		}
+
+		const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		printf("Streamed %zu frames in %.2f s (%.1f fps), %zu dropped\n",
+		       pushed, seconds, pushed / seconds, dropped);
+		return 0;
+	}
+	catch(std::exception& ex)
+	{
+		printf("Error: %s\n", ex.what());
+		return -1;
+	}
+}
@@ -0,0 +1,183 @@
+#include <catch2/catch.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+#include <nlohmann/json.hpp>
+
+#include "BatchProcessor.hpp"
+#include "PepsiDetector.hpp"
+#include "test_support.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const auto CONFIG_FILE = std::string("assets/camera/config.json");
+
+std::vector<std::string> read_lines(const std::string& path)
+{
+    auto ifs = std::ifstream(path);
+    auto lines = std::vector<std::string>();
+    for(auto line = std::string(); std::getline(ifs, line); )
+    {
+        lines.push_back(line);
+    }
+
+    return lines;
+}
+
+nlohmann::json find_expected_logos(const fs::path& src_file)
+{
+    const auto detector = PepsiDetector{read_config(CONFIG_FILE)};
+
+    auto json = nlohmann::json::array();
+    for(const auto& logo : detector.find_logos(cv::imread(src_file.string(), cv::IMREAD_COLOR)))
+    {
+        json.push_back({logo.x, logo.y, logo.width, logo.height});
+    }
+
+    return json;
+}
+
+BatchProcessor make_processor(BatchProcessor::Options options)
+{
+    return BatchProcessor{std::move(options),
+        [](const std::string&) { return CONFIG_FILE; },
+        [](const std::string& config_file) { return PepsiDetector{read_config(config_file)}; }};
+}
+
+} //
+
+SCENARIO("Batch processor writes single result line per input image", "[BatchProcessor]")
+{
+    const auto directory = (fs::temp_directory_path() / "batch_processor_test");
+    fs::remove_all(directory);
+    fs::create_directories(directory / "inputs" / "nested");
+
+    GIVEN("Directory with images, one of them broken, and other files")
+    {
+        const auto inputs = (directory / "inputs");
+        fs::copy_file("assets/camera/0.jpg", inputs / "0.jpg");
+        fs::copy_file("assets/camera/1.jpg", inputs / "1.jpg");
+        fs::copy_file("assets/camera/2.jpg", inputs / "nested" / "2.jpg");
+        std::ofstream(inputs / "broken.jpg") << "not an image";
+        std::ofstream(inputs / "notes.txt") << "not listed";
+
+        const auto images = std::vector<fs::path>{
+            inputs / "0.jpg",
+            inputs / "1.jpg",
+            inputs / "nested" / "2.jpg",
+        };
+
+        auto options = BatchProcessor::Options{};
+        options.output_file = (directory / "results.ndjson").string();
+        options.workers = 3;
+        options.readers = 2;
+        options.read_ahead = 1;
+
+        WHEN("Processing the directory into NDJSON with annotated images")
+        {
+            options.inputs = {inputs.string()};
+            options.dst_dir = (directory / "annotated").string();
+            const auto stats = make_processor(options).run();
+
+            auto results = std::map<std::string, nlohmann::json>();
+            for(const auto& line : read_lines(options.output_file))
+            {
+                const auto result = nlohmann::json::parse(line);
+                REQUIRE(results.emplace(result.at("file").get<std::string>(), result).second);
+            }
+
+            THEN("Each image file should have exactly one result, with the same logos as found separately")
+            {
+                REQUIRE(results.size() == images.size() + 1);
+                REQUIRE(stats.files == results.size());
+                for(const auto& image : images)
+                {
+                    const auto& result = results.at(image.string());
+                    REQUIRE(result.count("error") == 0);
+                    REQUIRE(result.at("logos") == find_expected_logos(image));
+                }
+            }
+
+            THEN("Broken image should have error row without logos")
+            {
+                const auto& result = results.at((inputs / "broken.jpg").string());
+                REQUIRE(result.count("error") == 1);
+                REQUIRE(result.at("logos").empty());
+                REQUIRE(stats.failed == 1);
+            }
+
+            THEN("Annotated images should be written at paths relative to the directory")
+            {
+                REQUIRE(fs::is_regular_file(directory / "annotated" / "0.jpg"));
+                REQUIRE(fs::is_regular_file(directory / "annotated" / "1.jpg"));
+                REQUIRE(fs::is_regular_file(directory / "annotated" / "nested" / "2.jpg"));
+                REQUIRE(!fs::exists(directory / "annotated" / "broken.jpg"));
+            }
+        }
+
+        WHEN("Processing glob and manifest into CSV")
+        {
+            const auto manifest = (directory / "manifest.txt");
+            std::ofstream(manifest) << (inputs / "nested" / "2.jpg").string() << "\r\n\n"
+                                    << (inputs / "missing.jpg").string() << '\n';
+
+            options.inputs = {(inputs / "[0b]*.jpg").string()};
+            options.manifest = manifest.string();
+            options.format = "csv";
+            options.output_file = (directory / "results.csv").string();
+            const auto stats = make_processor(options).run();
+
+            auto lines = read_lines(options.output_file);
+
+            THEN("Header and one row per matching or listed file should be written")
+            {
+                REQUIRE(lines.size() == 5);
+                REQUIRE(lines.front() == "file,logos_count,logos,read_ms,detect_ms,error");
+
+                auto rows = std::map<std::string, std::string>();
+                for(auto i = std::size_t{1}; i < lines.size(); ++i)
+                {
+                    const auto file_end = lines[i].find("\",");
+                    REQUIRE(file_end != std::string::npos);
+                    REQUIRE(rows.emplace(lines[i].substr(1, file_end - 1), lines[i]).second);
+                }
+
+                REQUIRE(rows.count((inputs / "0.jpg").string()) == 1);
+                REQUIRE(rows.count((inputs / "broken.jpg").string()) == 1);
+                REQUIRE(rows.count((inputs / "nested" / "2.jpg").string()) == 1);
+                REQUIRE(rows.count((inputs / "missing.jpg").string()) == 1);
+
+                const auto expected_count = find_expected_logos(inputs / "0.jpg").size();
+                const auto& row = rows.at((inputs / "0.jpg").string());
+                REQUIRE(row.find("\"," + std::to_string(expected_count) + ",") != std::string::npos);
+                REQUIRE(row.substr(row.size() - 3) == ",\"\"");
+
+                REQUIRE(stats.files == 4);
+                REQUIRE(stats.failed == 2);
+            }
+        }
+
+        WHEN("Manifest is missing")
+        {
+            options.inputs = {inputs.string()};
+            options.manifest = (directory / "missing.txt").string();
+
+            THEN("Error should be thrown after results of other inputs are written")
+            {
+                REQUIRE_THROWS_WITH(make_processor(options).run(), "Could not open manifest file");
+                REQUIRE(read_lines(options.output_file).size() == images.size() + 1);
+            }
+        }
+    }
+
+    fs::remove_all(directory);
+}
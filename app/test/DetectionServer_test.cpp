@@ -0,0 +1,383 @@
+#include <catch2/catch.hpp>
+
+#include <unistd.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include <opencv2/opencv.hpp>
+#include <nlohmann/json.hpp>
+
+#include "DetectionServer.hpp"
+#include "DetectorsCache.hpp"
+#include "ResultCache.hpp"
+#include "UnixSocket.hpp"
+#include "base64.hpp"
+#include "test_support.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const auto CONFIG_FILE = std::string("assets/camera/config.json");
+
+DetectorsCache make_detectors_cache()
+{
+    return DetectorsCache{
+        [](const std::string& src_file) { return (fs::path{src_file}.parent_path() / "config.json").string(); },
+        [](const std::string& config_file) {
+            return config_file.empty() ? PepsiDetector{} : PepsiDetector{read_config(config_file)};
+        }};
+}
+
+std::string read_file(const std::string& path)
+{
+    auto ifs = std::ifstream(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+}
+
+nlohmann::json format_logos(const Logos& logos)
+{
+    auto json = nlohmann::json::array();
+    for(const auto& logo : logos)
+    {
+        json.push_back({logo.x, logo.y, logo.width, logo.height});
+    }
+
+    return json;
+}
+
+nlohmann::json find_expected_logos(const std::string& src_file)
+{
+    const auto detector = PepsiDetector{read_config(CONFIG_FILE)};
+    return format_logos(detector.find_logos(cv::imread(src_file, cv::IMREAD_COLOR)));
+}
+
+/**
+ * @brief Serves socket on background thread, stopping the server at the latest when destroyed
+ */
+class ServerThread
+{
+public:
+    ServerThread(DetectionServer& server, const std::string& socket_path)
+        :   m_server(server)
+        ,   m_thread([&server, socket_path]() { server.serve_socket(socket_path); })
+    {}
+
+    ~ServerThread()
+    {
+        stop();
+    }
+
+    void stop()
+    {
+        if(m_thread.joinable())
+        {
+            m_server.stop();
+            m_thread.join();
+        }
+    }
+
+private:
+    DetectionServer& m_server;
+    std::thread m_thread;
+};
+
+} //
+
+SCENARIO("Detection server answers requests with logos", "[DetectionServer]")
+{
+    auto detectors = make_detectors_cache();
+    auto options = DetectionServer::Options{};
+    options.default_config = CONFIG_FILE;
+    const auto server = DetectionServer{options, detectors};
+
+    const auto src_file = std::string("assets/camera/0.jpg");
+    const auto expected_logos = find_expected_logos(src_file);
+    REQUIRE(!expected_logos.empty());
+
+    GIVEN("Request with image path")
+    {
+        const auto request = nlohmann::json{{"id", 7}, {"path", src_file}};
+
+        WHEN("Handling it")
+        {
+            const auto response = nlohmann::json::parse(server.handle(request.dump()));
+
+            THEN("Response should carry request id and logos found by detector")
+            {
+                REQUIRE(response.at("id") == 7);
+                REQUIRE(response.at("logos") == expected_logos);
+                REQUIRE(response.count("error") == 0);
+            }
+        }
+    }
+
+    GIVEN("Request asking for logos parts")
+    {
+        const auto request = nlohmann::json{{"id", 8}, {"path", src_file}, {"parts", true}};
+
+        WHEN("Handling it")
+        {
+            const auto response = nlohmann::json::parse(server.handle(request.dump()));
+
+            THEN("Response should carry blue and red part of each logo")
+            {
+                REQUIRE(response.at("parts").size() == expected_logos.size());
+                for(const auto& part : response.at("parts"))
+                {
+                    REQUIRE(part.at("blue").at("area").get<int>() > 0);
+                    REQUIRE(part.at("red").at("rect").size() == 4);
+                }
+            }
+        }
+    }
+
+    GIVEN("Request with encoded image")
+    {
+        const auto request = nlohmann::json{{"id", "a"}, {"image", encode_base64(read_file(src_file))}};
+
+        WHEN("Handling it")
+        {
+            const auto response = nlohmann::json::parse(server.handle(request.dump()));
+
+            THEN("Logos should be found with default config")
+            {
+                REQUIRE(response.at("id") == "a");
+                REQUIRE(response.at("logos") == expected_logos);
+            }
+        }
+    }
+
+    GIVEN("Request with raw pixels")
+    {
+        const auto img = cv::imread(src_file, cv::IMREAD_COLOR);
+        const auto pixels = std::string(reinterpret_cast<const char*>(img.data), img.total() * img.elemSize());
+        const auto request = nlohmann::json{
+            {"id", 1},
+            {"raw", encode_base64(pixels)},
+            {"width", img.cols},
+            {"height", img.rows},
+            {"config", CONFIG_FILE},
+        };
+
+        WHEN("Handling it")
+        {
+            const auto response = nlohmann::json::parse(server.handle(request.dump()));
+
+            THEN("Logos should be same as for image file")
+            {
+                REQUIRE(response.at("logos") == expected_logos);
+            }
+        }
+    }
+
+    GIVEN("Invalid requests")
+    {
+        const auto requests = std::vector<std::string>{
+            "not a json",
+            R"({"id": 1})",
+            R"({"id": 2, "path": "assets/camera/missing.jpg"})",
+            R"({"id": 3, "raw": "AAAA", "width": 640, "height": 480})",
+            R"({"id": 4, "raw": "AAAA", "width": 1, "height": 2, "stride": -1})",
+            R"({"id": 5, "raw": "AAAA", "width": 1, "height": 3, "stride": 9223372036854775808})",
+        };
+
+        WHEN("Handling them")
+        {
+            THEN("Responses should carry errors")
+            {
+                for(const auto& request : requests)
+                {
+                    const auto response = nlohmann::json::parse(server.handle(request));
+                    REQUIRE(response.count("error") == 1);
+                    REQUIRE(response.at("logos").empty());
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Detection server reuses cached results of repeated images", "[DetectionServer]")
+{
+    auto detectors = make_detectors_cache();
+    auto options = DetectionServer::Options{};
+    options.default_config = CONFIG_FILE;
+    auto results = ResultCache{ResultCache::Options{}};
+    const auto server = DetectionServer{options, detectors, &results};
+
+    const auto src_file = std::string("assets/camera/0.jpg");
+    const auto expected_logos = find_expected_logos(src_file);
+
+    GIVEN("The same image sent twice")
+    {
+        const auto request = nlohmann::json{{"id", 1}, {"image", encode_base64(read_file(src_file))}, {"parts", true}};
+
+        WHEN("Handling both requests")
+        {
+            const auto first = nlohmann::json::parse(server.handle(request.dump()));
+            const auto second = nlohmann::json::parse(server.handle(request.dump()));
+
+            THEN("Second response should come from the cache, with the same logos and parts")
+            {
+                REQUIRE(first.count("cached") == 0);
+                REQUIRE(second.at("cached") == true);
+                REQUIRE(second.at("logos") == expected_logos);
+                REQUIRE(second.at("parts") == first.at("parts"));
+
+                const auto stats = results.stats();
+                REQUIRE(stats.hits == 1);
+                REQUIRE(stats.misses == 1);
+            }
+        }
+    }
+}
+
+SCENARIO("Detection server handles concurrent clients", "[DetectionServer]")
+{
+    auto detectors = make_detectors_cache();
+    auto options = DetectionServer::Options{};
+    options.workers = 4;
+
+    const auto src_files = std::vector<std::string>{
+        "assets/camera/0.jpg",
+        "assets/camera/4.jpg",
+        "assets/camera/9.jpg",
+    };
+
+    auto expected_logos = std::vector<nlohmann::json>();
+    for(const auto& src_file : src_files)
+    {
+        expected_logos.push_back(find_expected_logos(src_file));
+    }
+
+    GIVEN("Server listening on Unix socket")
+    {
+        const auto socket_path = (fs::temp_directory_path()
+            / ("detection_server_test_" + std::to_string(::getpid()) + ".sock")).string();
+
+        auto server = DetectionServer{options, detectors};
+        auto server_thread = ServerThread{server, socket_path};
+
+        // Waits until socket is ready for connections
+        auto fd = -1;
+        for(auto attempt = 0; fd < 0 && attempt < 100; ++attempt)
+        {
+            try
+            {
+                fd = connect_unix_socket(socket_path);
+            }
+            catch(std::exception&)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        }
+        REQUIRE(fd >= 0);
+
+        WHEN("Two clients send pipelined requests")
+        {
+            auto first = LineConnection{fd};
+            auto second = LineConnection{connect_unix_socket(socket_path)};
+
+            for(auto i = std::size_t{0}; i < src_files.size(); ++i)
+            {
+                const auto request = nlohmann::json{{"id", i}, {"path", src_files[i]}};
+                REQUIRE(first.write_line(request.dump()));
+                REQUIRE(second.write_line(request.dump()));
+            }
+
+            auto responses = std::map<std::size_t, nlohmann::json>();
+            for(auto* connection : {&first, &second})
+            {
+                for(auto i = std::size_t{0}; i < src_files.size(); ++i)
+                {
+                    const auto line = connection->read_line();
+                    REQUIRE(line);
+
+                    const auto response = nlohmann::json::parse(*line);
+                    const auto id = response.at("id").get<std::size_t>();
+                    REQUIRE(response.at("logos") == expected_logos.at(id));
+                    responses[id] = response;
+                }
+            }
+
+            server_thread.stop();
+
+            THEN("Every request should be answered")
+            {
+                REQUIRE(responses.size() == src_files.size());
+            }
+
+            THEN("Socket file should be removed after server stops")
+            {
+                REQUIRE(!fs::exists(socket_path));
+            }
+        }
+    }
+}
+
+SCENARIO("Detection server can serve line protocol over streams", "[DetectionServer]")
+{
+    auto detectors = make_detectors_cache();
+    auto options = DetectionServer::Options{};
+    options.workers = 2;
+    auto server = DetectionServer{options, detectors};
+
+    GIVEN("Stream of requests with blank lines")
+    {
+        auto is = std::istringstream(
+            "{\"id\": 1, \"path\": \"assets/camera/0.jpg\"}\n"
+            "\n"
+            "{\"id\": 2, \"path\": \"assets/camera/1.jpg\"}\r\n");
+        auto os = std::ostringstream();
+
+        WHEN("Serving it")
+        {
+            server.serve_stream(is, os);
+
+            THEN("Each request should get single response line")
+            {
+                auto ids = std::set<int>();
+                auto responses = std::istringstream(os.str());
+                for(auto line = std::string(); std::getline(responses, line); )
+                {
+                    const auto response = nlohmann::json::parse(line);
+                    REQUIRE(response.count("error") == 0);
+                    ids.insert(response.at("id").get<int>());
+                }
+
+                REQUIRE(ids == std::set<int>{1, 2});
+            }
+        }
+    }
+}
+
+SCENARIO("Unix socket is not bound over other files", "[UnixSocket]")
+{
+    GIVEN("Regular file at the socket path")
+    {
+        const auto path = (fs::temp_directory_path()
+            / ("unix_socket_test_" + std::to_string(::getpid()) + ".json")).string();
+        {
+            auto ofs = std::ofstream(path);
+            ofs << "{}";
+        }
+
+        WHEN("Listening on it")
+        {
+            THEN("Listening should fail and the file should be kept")
+            {
+                REQUIRE_THROWS(UnixSocketListener{path});
+                REQUIRE(fs::is_regular_file(path));
+            }
+        }
+
+        fs::remove(path);
+    }
+}
@@ -0,0 +1,138 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <filesystem>
+
+#include "ResultCache.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+Detections make_detections(int x)
+{
+    return Detections{
+        Detection{Rect{x, 10, 40, 60}, LogoPart{Rect{x, 10, 40, 30}, 900}, LogoPart{Rect{x, 40, 40, 30}, 1100}},
+    };
+}
+
+bool detections_equal(const Detections& lhs, const Detections& rhs)
+{
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+        [](const auto& a, const auto& b)
+        {
+            return (a.logo == b.logo
+                && a.blue.rect == b.blue.rect && a.blue.area == b.blue.area
+                && a.red.rect == b.red.rect && a.red.area == b.red.area);
+        });
+}
+
+} //
+
+SCENARIO("Results cache keeps recently used entries", "[ResultCache]")
+{
+    GIVEN("Cache for 2 entries")
+    {
+        auto options = ResultCache::Options{};
+        options.capacity = 2;
+        auto cache = ResultCache{options};
+
+        const auto key1 = ResultCache::Key{1, 100};
+        const auto key2 = ResultCache::Key{2, 100};
+        const auto key3 = ResultCache::Key{3, 100};
+
+        WHEN("Looking up missing entry")
+        {
+            THEN("Nothing is found and miss is counted")
+            {
+                REQUIRE_FALSE(cache.find(key1).has_value());
+                REQUIRE(cache.stats().misses == 1);
+                REQUIRE(cache.stats().hits == 0);
+            }
+        }
+
+        WHEN("Inserting entries")
+        {
+            cache.insert(key1, make_detections(1));
+            cache.insert(key2, make_detections(2));
+
+            THEN("They are found and hits are counted")
+            {
+                const auto found = cache.find(key1);
+                REQUIRE(found.has_value());
+                REQUIRE(detections_equal(*found, make_detections(1)));
+                REQUIRE(cache.stats().hits == 1);
+                REQUIRE(cache.stats().entries == 2);
+            }
+
+            THEN("Key with other config hash is not found")
+            {
+                REQUIRE_FALSE(cache.find(ResultCache::Key{1, 200}).has_value());
+            }
+
+            AND_WHEN("Inserting third entry, after using the first one")
+            {
+                cache.find(key1);
+                cache.insert(key3, make_detections(3));
+
+                THEN("Least recently used entry is evicted")
+                {
+                    REQUIRE(cache.find(key1).has_value());
+                    REQUIRE(cache.find(key3).has_value());
+                    REQUIRE_FALSE(cache.find(key2).has_value());
+                    REQUIRE(cache.stats().entries == 2);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Results cache stores entries in directory", "[ResultCache]")
+{
+    const auto directory = (fs::temp_directory_path() / "result_cache_test").string();
+    fs::remove_all(directory);
+
+    auto options = ResultCache::Options{};
+    options.directory = directory;
+    const auto key = ResultCache::Key{0x1234, 0x5678};
+
+    GIVEN("Entry inserted by one cache")
+    {
+        ResultCache{options}.insert(key, make_detections(5));
+
+        WHEN("Looking it up in another cache with the same directory")
+        {
+            auto cache = ResultCache{options};
+            const auto found = cache.find(key);
+
+            THEN("It is loaded from disk and counted as disk hit")
+            {
+                REQUIRE(found.has_value());
+                REQUIRE(detections_equal(*found, make_detections(5)));
+                REQUIRE(cache.stats().disk_hits == 1);
+
+                AND_THEN("Next lookup is served from memory")
+                {
+                    REQUIRE(cache.find(key).has_value());
+                    REQUIRE(cache.stats().hits == 2);
+                    REQUIRE(cache.stats().disk_hits == 1);
+                }
+            }
+        }
+    }
+
+    GIVEN("Empty detections inserted")
+    {
+        ResultCache{options}.insert(key, Detections{});
+
+        THEN("They are found, as empty results are results too")
+        {
+            auto cache = ResultCache{options};
+            const auto found = cache.find(key);
+            REQUIRE(found.has_value());
+            REQUIRE(found->empty());
+        }
+    }
+
+    fs::remove_all(directory);
+}
@@ -0,0 +1,122 @@
+#include <catch2/catch.hpp>
+
+#include <unistd.h>
+
+#include <string>
+#include <thread>
+
+#include <opencv2/opencv.hpp>
+
+#include "ShmRing.hpp"
+#include "core.hpp"
+
+namespace {
+
+std::string make_shm_name()
+{
+    return "/pepsi_logo_detector_test_" + std::to_string(::getpid());
+}
+
+cv::Mat make_frame(cv::Size size, int seed)
+{
+    auto img = cv::Mat(size, CV_8UC3);
+    cv::randu(img, cv::Scalar::all(seed), cv::Scalar::all(seed + 64));
+    return img;
+}
+
+} //
+
+SCENARIO("Frames and results are passed through shared memory rings", "[ShmRing]")
+{
+    GIVEN("Producer ring with 2 slots and consumer attached to it")
+    {
+        auto layout = ShmRing::Layout{};
+        layout.slots = 2;
+        layout.frame_size = cv::Size{64, 48};
+
+        auto producer = ShmRing(make_shm_name(), layout);
+        auto consumer = ShmRing(make_shm_name());
+
+        REQUIRE(consumer.slots() == 2);
+        REQUIRE(consumer.frame_size() == layout.frame_size);
+
+        WHEN("Frames of different sizes are pushed")
+        {
+            const auto first = make_frame(cv::Size{64, 48}, 0);
+            const auto second = make_frame(cv::Size{33, 17}, 100);
+
+            REQUIRE(producer.try_push_frame(first) == std::uint64_t{0});
+            REQUIRE(producer.try_push_frame(second) == std::uint64_t{1});
+
+            THEN("Full ring refuses next frame")
+            {
+                REQUIRE_FALSE(producer.try_push_frame(first).has_value());
+            }
+
+            THEN("Consumer sees them in order, in slot memory")
+            {
+                auto frame = consumer.wait_frame();
+                REQUIRE(frame.has_value());
+                REQUIRE(frame->sequence == 0);
+                REQUIRE(images_equal(frame->img, first));
+
+                consumer.publish_result(Logos{cv::Rect{1, 2, 3, 4}});
+
+                frame = consumer.wait_frame();
+                REQUIRE(frame.has_value());
+                REQUIRE(frame->sequence == 1);
+                REQUIRE(images_equal(frame->img, second));
+
+                consumer.publish_result(Logos{});
+
+                AND_THEN("Producer receives their results and may reuse slots")
+                {
+                    auto result = producer.try_pop_result();
+                    REQUIRE(result.has_value());
+                    REQUIRE(result->sequence == 0);
+                    REQUIRE(result->logos == Logos{cv::Rect{1, 2, 3, 4}});
+                    REQUIRE_FALSE(result->truncated);
+
+                    result = producer.try_pop_result();
+                    REQUIRE(result.has_value());
+                    REQUIRE(result->sequence == 1);
+                    REQUIRE(result->logos.empty());
+
+                    REQUIRE_FALSE(producer.try_pop_result().has_value());
+                    REQUIRE(producer.try_push_frame(first) == std::uint64_t{2});
+                }
+            }
+        }
+
+        WHEN("Stream is closed after pushing a frame")
+        {
+            producer.try_push_frame(make_frame(layout.frame_size, 0));
+            producer.close();
+
+            THEN("Consumer finishes after processing it")
+            {
+                REQUIRE(consumer.wait_frame().has_value());
+                consumer.publish_result(Logos{});
+                REQUIRE_FALSE(consumer.wait_frame().has_value());
+            }
+        }
+
+        WHEN("Consumer waits for frames on other thread and is stopped")
+        {
+            auto received = true;
+            auto waiter = std::thread([&consumer, &received]() { received = consumer.wait_frame().has_value(); });
+            consumer.stop();
+            waiter.join();
+
+            THEN("No frame is returned")
+            {
+                REQUIRE_FALSE(received);
+            }
+        }
+    }
+}
+
+SCENARIO("Attaching to missing shared memory fails", "[ShmRing]")
+{
+    REQUIRE_THROWS(ShmRing(make_shm_name() + "_missing"));
+}
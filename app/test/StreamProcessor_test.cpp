@@ -0,0 +1,169 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "PepsiDetector.hpp"
+#include "StreamProcessor.hpp"
+#include "test_support.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const auto IMAGES_FILES = std::vector<std::string>{
+    "assets/camera/0.jpg",
+    "assets/camera/1.jpg",
+    "assets/camera/2.jpg",
+};
+
+constexpr auto FramesPerImage = 3;
+
+/**
+ * @brief Writes clip of given images, each pasted into common canvas at few offsets, as make_test_clip does
+ */
+void write_clip(const std::string& path, const std::vector<std::string>& src_files)
+{
+    auto images = std::vector<cv::Mat>();
+    auto canvas_size = cv::Size{0, 0};
+    for(const auto& src_file : src_files)
+    {
+        images.push_back(cv::imread(src_file, cv::IMREAD_COLOR));
+        canvas_size.width = std::max(canvas_size.width, images.back().cols + FramesPerImage);
+        canvas_size.height = std::max(canvas_size.height, images.back().rows);
+    }
+
+    auto writer = cv::VideoWriter(path, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), 25.0, canvas_size);
+    REQUIRE(writer.isOpened());
+    for(const auto& img : images)
+    {
+        for(auto x = 0; x < FramesPerImage; ++x)
+        {
+            auto canvas = cv::Mat(canvas_size, CV_8UC3, cv::Scalar{0, 0, 0});
+            img.copyTo(canvas(cv::Rect{x, 0, img.cols, img.rows}));
+            writer.write(canvas);
+        }
+    }
+}
+
+/**
+ * @brief Reads all frames of the clip, as they are decoded by stream processor
+ */
+std::vector<cv::Mat> read_clip(const std::string& path)
+{
+    auto capture = cv::VideoCapture(path);
+    auto frames = std::vector<cv::Mat>();
+    auto frame = cv::Mat();
+    while(capture.read(frame) && !frame.empty())
+    {
+        frames.push_back(frame.clone());
+    }
+
+    return frames;
+}
+
+} //
+
+SCENARIO("Stream processor detects logos in each frame of a clip", "[StreamProcessor]")
+{
+    const auto directory = (fs::temp_directory_path() / "stream_processor_test");
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+
+    const auto detector = PepsiDetector{read_config("assets/camera/config.json")};
+
+    GIVEN("Clip generated from still images")
+    {
+        const auto clip_file = (directory / "clip.avi").string();
+        write_clip(clip_file, IMAGES_FILES);
+
+        const auto frames = read_clip(clip_file);
+        REQUIRE(frames.size() == IMAGES_FILES.size() * FramesPerImage);
+
+        auto options = StreamProcessor::Options{};
+        options.src = clip_file;
+        options.dst = (directory / "annotated.avi").string();
+        options.queue_size = 1;
+
+        WHEN("Processing it")
+        {
+            auto logos_array = std::vector<Logos>();
+            auto processor = StreamProcessor{options,
+                [&detector, &logos_array](const cv::Mat& img) {
+                    logos_array.push_back(detector.find_logos(img));
+                    return logos_array.back();
+                }};
+            const auto stats = processor.run();
+
+            THEN("Logos of each frame should be found in order, same as in separate frames")
+            {
+                REQUIRE(stats.frames == frames.size());
+                REQUIRE(logos_array.size() == frames.size());
+                for(auto i = std::size_t{0}; i < frames.size(); ++i)
+                {
+                    REQUIRE(logos_array[i] == detector.find_logos(frames[i]));
+                }
+            }
+
+            THEN("Each frame should be written to annotated clip")
+            {
+                REQUIRE(read_clip(options.dst).size() == frames.size());
+            }
+        }
+
+        WHEN("Detection fails in the middle of the clip")
+        {
+            auto calls = std::size_t{0};
+            auto processor = StreamProcessor{options,
+                [&calls](const cv::Mat&) -> Logos {
+                    if(++calls == FramesPerImage)
+                    {
+                        throw std::runtime_error("Detection failed");
+                    }
+
+                    return Logos();
+                }};
+
+            THEN("Its error should be thrown after decoding is stopped")
+            {
+                REQUIRE_THROWS_WITH(processor.run(), "Detection failed");
+                REQUIRE(calls == FramesPerImage);
+            }
+        }
+
+        WHEN("Annotated clip can not be written")
+        {
+            options.dst = (directory / "missing" / "annotated.avi").string();
+            auto processor = StreamProcessor{options, [](const cv::Mat&) { return Logos(); }};
+
+            THEN("Writing error should be thrown after decoding and detection are stopped")
+            {
+                REQUIRE_THROWS_WITH(processor.run(), "Could not open output video file");
+            }
+        }
+    }
+
+    GIVEN("Missing video source")
+    {
+        auto options = StreamProcessor::Options{};
+        options.src = (directory / "missing.avi").string();
+        options.dst = (directory / "annotated.avi").string();
+
+        WHEN("Processing it")
+        {
+            auto processor = StreamProcessor{options, [](const cv::Mat&) { return Logos(); }};
+
+            THEN("Error should be thrown")
+            {
+                REQUIRE_THROWS_WITH(processor.run(), "Could not open video source");
+            }
+        }
+    }
+
+    fs::remove_all(directory);
+}
@@ -0,0 +1,52 @@
+#include <catch2/catch.hpp>
+
+#include <string>
+
+#include "base64.hpp"
+
+SCENARIO("Binary data can be encoded with Base64", "[base64]")
+{
+    GIVEN("Data of lengths giving every padding")
+    {
+        WHEN("Encoding it")
+        {
+            THEN("Text should match RFC 4648 test vectors")
+            {
+                REQUIRE(encode_base64("") == "");
+                REQUIRE(encode_base64("f") == "Zg==");
+                REQUIRE(encode_base64("fo") == "Zm8=");
+                REQUIRE(encode_base64("foo") == "Zm9v");
+                REQUIRE(encode_base64("foob") == "Zm9vYg==");
+                REQUIRE(encode_base64("fooba") == "Zm9vYmE=");
+                REQUIRE(encode_base64("foobar") == "Zm9vYmFy");
+            }
+        }
+    }
+
+    GIVEN("Data with all byte values")
+    {
+        auto data = std::string();
+        for(auto i = 0; i < 256; ++i)
+        {
+            data += static_cast<char>(i);
+        }
+
+        WHEN("Encoding and decoding it")
+        {
+            const auto decoded = decode_base64(encode_base64(data));
+
+            THEN("Original data should be restored")
+            {
+                REQUIRE(decoded == data);
+            }
+        }
+    }
+
+    GIVEN("Text with invalid characters")
+    {
+        THEN("Decoding should fail")
+        {
+            REQUIRE_THROWS(decode_base64("Zm9v!"));
+        }
+    }
+}
@@ -0,0 +1,147 @@
+#include "Benchmark.hpp"
+
+#include <cstdio>
+#include <ctime>
+
+#include <opencv2/opencv.hpp>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#ifndef DETECTOR_BUILD_TYPE
+#define DETECTOR_BUILD_TYPE "unknown"
+#endif
+
+namespace {
+
+double to_milliseconds(BenchmarkTime time)
+{
+    return std::chrono::duration<double, std::milli>(time).count();
+}
+
+std::string get_compiler_name()
+{
+#if defined(__clang__)
+    return "clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    return "msvc " + std::to_string(_MSC_VER);
+#else
+    return "unknown";
+#endif
+}
+
+std::string get_current_date()
+{
+    const auto now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+    return date;
+}
+
+} // namespace
+
+double BenchmarkResult::megapixels_per_second() const noexcept
+{
+    const auto seconds = std::chrono::duration<double>(median).count();
+    if(seconds <= 0.0)
+    {
+        return 0.0;
+    }
+
+    return (static_cast<double>(width) * height / 1e6) / seconds;
+}
+
+BenchmarkResult summarize(std::string name, int width, int height, double density,
+                          Measurement measurement)
+{
+    auto& times = measurement.times;
+    CV_Assert(!times.empty());
+
+    std::sort(times.begin(), times.end());
+
+    auto result = BenchmarkResult{};
+    result.name = std::move(name);
+    result.width = width;
+    result.height = height;
+    result.density = density;
+    result.repetitions = static_cast<int>(times.size());
+    result.min = times.front();
+    result.median = times[times.size() / 2];
+    result.mean = std::accumulate(times.begin(), times.end(), BenchmarkTime{0})
+        / static_cast<BenchmarkTime::rep>(times.size());
+    result.allocations = measurement.allocations;
+    return result;
+}
+
+bool pin_to_cpu(int cpu)
+{
+#ifdef __linux__
+    if(cpu < 0 || cpu >= CPU_SETSIZE)
+    {
+        return false;
+    }
+
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+    return (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) == 0);
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+nlohmann::json make_benchmark_context(const BenchmarkOptions& options, int cpu)
+{
+    return nlohmann::json{
+        {"date", get_current_date()},
+        {"compiler", get_compiler_name()},
+        {"build_type", DETECTOR_BUILD_TYPE},
+        {"warmup", options.warmup},
+        {"repetitions", options.repetitions},
+        {"cpu", cpu},
+    };
+}
+
+nlohmann::json to_json(const BenchmarkResult& result)
+{
+    auto json = nlohmann::json{
+        {"name", result.name},
+        {"width", result.width},
+        {"height", result.height},
+        {"repetitions", result.repetitions},
+        {"min_ns", result.min.count()},
+        {"median_ns", result.median.count()},
+        {"mean_ns", result.mean.count()},
+        {"megapixels_per_second", result.megapixels_per_second()},
+        {"allocations", result.allocations.count},
+        {"allocated_bytes", result.allocations.bytes},
+    };
+
+    if(result.density >= 0.0)
+    {
+        json["density"] = result.density;
+    }
+
+    return json;
+}
+
+void print_result(const BenchmarkResult& result)
+{
+    auto name = result.name;
+    if(result.density >= 0.0)
+    {
+        char density[16];
+        std::snprintf(density, sizeof(density), "/%.2f", result.density);
+        name += density;
+    }
+
+    std::printf("%-24s %5dx%-5d min %9.3f ms  median %9.3f ms  mean %9.3f ms  %8.1f MP/s  %6zu allocs %10zu B\n",
+                name.c_str(), result.width, result.height,
+                to_milliseconds(result.min), to_milliseconds(result.median),
+                to_milliseconds(result.mean), result.megapixels_per_second(),
+                result.allocations.count, result.allocations.bytes);
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "alloc_counter.hpp"
+
+using BenchmarkClock = std::chrono::steady_clock;
+using BenchmarkTime = std::chrono::nanoseconds;
+using BenchmarkTimes = std::vector<BenchmarkTime>;
+
+/**
+ * @brief Times of all repetitions and allocations made by the last one
+ */
+struct Measurement
+{
+	BenchmarkTimes times;
+	AllocationStats allocations;
+};
+
+struct BenchmarkOptions
+{
+	int warmup = 2;
+	int repetitions = 10;
+};
+
+/**
+ * @brief Summary of timings of single benchmark case
+ */
+struct BenchmarkResult
+{
+	std::string name;
+	int width = 0;
+	int height = 0;
+	double density = -1.0; // Negative, if the case has no mask
+	int repetitions = 0;
+
+	BenchmarkTime min{};
+	BenchmarkTime median{};
+	BenchmarkTime mean{};
+
+	AllocationStats allocations;
+
+	double megapixels_per_second() const noexcept;
+};
+
+using BenchmarkResults = std::vector<BenchmarkResult>;
+
+BenchmarkResult summarize(std::string name, int width, int height, double density,
+                          Measurement measurement);
+
+/**
+ * @brief Measures given body for configured number of repetitions
+ * Setup is run before each repetition (warm-up ones too) and is not timed.
+ *  It should restore inputs, which are modified by the body.
+ *  Allocations are counted only in the last repetition, when caches of the body are warm.
+ */
+template<typename Setup, typename Body>
+Measurement measure(const BenchmarkOptions& options, Setup setup, Body body)
+{
+	for(auto i = 0; i < options.warmup; ++i)
+	{
+		setup();
+		body();
+	}
+
+	auto measurement = Measurement{};
+	measurement.times.reserve(options.repetitions);
+
+	for(auto i = 0; i < options.repetitions; ++i)
+	{
+		setup();
+
+		const auto allocation_scope = AllocationScope{};
+		const auto start = BenchmarkClock::now();
+		body();
+		measurement.times.push_back(BenchmarkClock::now() - start);
+		measurement.allocations = allocation_scope.stats();
+	}
+
+	return measurement;
+}
+
+template<typename Body>
+Measurement measure(const BenchmarkOptions& options, Body body)
+{
+	return measure(options, []() {}, std::move(body));
+}
+
+/**
+ * @brief Pins calling thread to given CPU. Returns false, if it is not supported or failed
+ */
+bool pin_to_cpu(int cpu);
+
+nlohmann::json make_benchmark_context(const BenchmarkOptions& options, int cpu);
+
+nlohmann::json to_json(const BenchmarkResult& result);
+
+void print_result(const BenchmarkResult& result);
@@ -0,0 +1,194 @@
+#include "PerfCounters.hpp"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+
+#include <algorithm>
+
+namespace {
+
+#ifdef __linux__
+
+struct EventConfig
+{
+    std::uint32_t type;
+    std::uint64_t config;
+};
+
+constexpr std::uint64_t make_cache_config(std::uint64_t cache, std::uint64_t op, std::uint64_t result)
+{
+    return (cache | (op << 8) | (result << 16));
+}
+
+EventConfig get_event_config(PerfEvent event) noexcept
+{
+    switch(event)
+    {
+        case PerfEvent::Cycles:
+            return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES};
+        case PerfEvent::Instructions:
+            return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS};
+        case PerfEvent::L1DataMisses:
+            return {PERF_TYPE_HW_CACHE, make_cache_config(PERF_COUNT_HW_CACHE_L1D,
+                                                          PERF_COUNT_HW_CACHE_OP_READ,
+                                                          PERF_COUNT_HW_CACHE_RESULT_MISS)};
+        case PerfEvent::LastLevelCacheMisses:
+            return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES};
+        case PerfEvent::BranchMisses:
+            return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES};
+    }
+
+    return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES};
+}
+
+int open_event(PerfEvent event) noexcept
+{
+    const auto event_config = get_event_config(event);
+
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = event_config.type;
+    attr.config = event_config.config;
+    // Counting only user space of this thread is allowed with default perf_event_paranoid
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    const auto pid = 0;
+    const auto cpu = -1;
+    const auto group_fd = -1;
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, pid, cpu, group_fd, 0));
+}
+
+#endif
+
+} // namespace
+
+const char* get_perf_event_name(PerfEvent event) noexcept
+{
+    switch(event)
+    {
+        case PerfEvent::Cycles: return "cycles";
+        case PerfEvent::Instructions: return "instructions";
+        case PerfEvent::L1DataMisses: return "l1d_misses";
+        case PerfEvent::LastLevelCacheMisses: return "llc_misses";
+        case PerfEvent::BranchMisses: return "branch_misses";
+    }
+
+    return "unknown";
+}
+
+PerfCounters::PerfCounters()
+{
+    m_fds.fill(-1);
+
+#ifdef __linux__
+    for(auto i = 0; i < PerfEventsMax; ++i)
+    {
+        m_fds[i] = open_event(static_cast<PerfEvent>(i));
+    }
+#endif
+}
+
+PerfCounters::~PerfCounters()
+{
+#ifdef __linux__
+    for(const auto fd : m_fds)
+    {
+        if(fd >= 0)
+        {
+            close(fd);
+        }
+    }
+#endif
+}
+
+bool PerfCounters::available() const noexcept
+{
+    return std::any_of(m_fds.begin(), m_fds.end(), [](int fd) { return fd >= 0; });
+}
+
+bool PerfCounters::available(PerfEvent event) const noexcept
+{
+    return (m_fds[static_cast<std::size_t>(event)] >= 0);
+}
+
+PerfValues PerfCounters::read() const noexcept
+{
+    auto values = PerfValues{};
+
+#ifdef __linux__
+    for(auto i = 0; i < PerfEventsMax; ++i)
+    {
+        if(m_fds[i] >= 0)
+        {
+            auto value = std::uint64_t{0};
+            if(::read(m_fds[i], &value, sizeof(value)) == sizeof(value))
+            {
+                values[i] = value;
+            }
+        }
+    }
+#endif
+
+    return values;
+}
+
+PerfStageObserver::PerfStageObserver(const PerfCounters& counters)
+    :   m_counters(counters)
+{}
+
+void PerfStageObserver::begin_stage(Stage /*stage*/)
+{
+    m_start = m_counters.read();
+}
+
+void PerfStageObserver::end_stage(Stage stage)
+{
+    const auto end = m_counters.read();
+
+    auto& values = m_stages_values[static_cast<std::size_t>(stage)];
+    for(auto i = 0; i < PerfEventsMax; ++i)
+    {
+        values[i] += (end[i] - m_start[i]);
+    }
+}
+
+const PerfValues& PerfStageObserver::stage_values(Stage stage) const noexcept
+{
+    return m_stages_values[static_cast<std::size_t>(stage)];
+}
+
+void PerfStageObserver::reset() noexcept
+{
+    m_stages_values = {};
+}
+
+nlohmann::json to_json(const PerfCounters& counters, const PerfStageObserver& observer, double megapixels)
+{
+    auto json = nlohmann::json::object();
+    for(auto i = 0; i < StagesMax; ++i)
+    {
+        const auto stage = static_cast<Stage>(i);
+        const auto& values = observer.stage_values(stage);
+
+        auto stage_json = nlohmann::json::object();
+        for(auto j = 0; j < PerfEventsMax; ++j)
+        {
+            const auto event = static_cast<PerfEvent>(j);
+            if(counters.available(event))
+            {
+                stage_json[get_perf_event_name(event)] = (values[j] / megapixels);
+            }
+        }
+
+        json[get_stage_name(stage)] = std::move(stage_json);
+    }
+
+    return json;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+
+#include <array>
+
+#include <nlohmann/json.hpp>
+
+#include "stats.hpp"
+
+enum class PerfEvent
+{
+	Cycles,
+	Instructions,
+	L1DataMisses,
+	LastLevelCacheMisses,
+	BranchMisses,
+};
+
+constexpr static auto PerfEventsMax = 5;
+
+const char* get_perf_event_name(PerfEvent event) noexcept;
+
+using PerfValues = std::array<std::uint64_t, PerfEventsMax>;
+
+/**
+ * @brief Hardware performance counters of calling thread, read with perf_event_open
+ * Events, which can not be opened (e.g. in containers or VMs), are not available
+ *  and read as zeros. On other systems than Linux, no event is available.
+ */
+class PerfCounters
+{
+public:
+	PerfCounters();
+	~PerfCounters();
+
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	bool available() const noexcept;
+
+	bool available(PerfEvent event) const noexcept;
+
+	PerfValues read() const noexcept;
+
+private:
+	std::array<int, PerfEventsMax> m_fds;
+};
+
+/**
+ * @brief Accumulates counters of each detection stage
+ */
+class PerfStageObserver
+	:	public StageObserver
+{
+public:
+	explicit PerfStageObserver(const PerfCounters& counters);
+
+	void begin_stage(Stage stage) override;
+
+	void end_stage(Stage stage) override;
+
+	const PerfValues& stage_values(Stage stage) const noexcept;
+
+	void reset() noexcept;
+
+private:
+	const PerfCounters& m_counters;
+	PerfValues m_start{};
+	std::array<PerfValues, StagesMax> m_stages_values{};
+};
+
+/**
+ * @brief Converts values of each stage to JSON, scaled per megapixel of processed image
+ */
+nlohmann::json to_json(const PerfCounters& counters, const PerfStageObserver& observer, double megapixels);
@@ -0,0 +1,151 @@
+#include <cstdio>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <CLI/CLI.hpp>
+#include <nlohmann/json.hpp>
+
+#include "Benchmark.hpp"
+#include "corpus_bench.hpp"
+#include "kernels_bench.hpp"
+#include "test_support.hpp"
+
+namespace {
+
+constexpr auto RegressionExitCode = 1;
+
+void write_json(const std::string& dst_file, const nlohmann::json& json)
+{
+    auto ofs = std::ofstream(dst_file);
+    if(!(ofs << json.dump(4) << '\n'))
+    {
+        throw std::runtime_error("Could not write benchmark results file");
+    }
+}
+
+void add_benchmark_options(CLI::App& cli, BenchmarkOptions& options)
+{
+    cli.add_option("--warmup", options.warmup,
+                   "Number of untimed repetitions before measurement", true)
+        ->check(CLI::Range(0, 1000));
+    cli.add_option("--repetitions", options.repetitions,
+                   "Number of timed repetitions of each case", true)
+        ->check(CLI::Range(1, 100000));
+}
+
+} // namespace
+
+/**
+ * Benchmarks of the detector:
+ *  - "kernels" micro-benchmarks each kernel on synthetic inputs,
+ *  - "corpus" runs whole detection over images in assets and may compare results with baseline.
+ * Results are printed and, if requested, written as JSON, so different builds may be compared.
+ */
+int main(int argc, char** argv)
+{
+    CLI::App cli{"Benchmarks the detector"};
+    cli.require_subcommand(1);
+
+    auto cpu = -1;
+    cli.add_option("--cpu", cpu,
+                   "Pins benchmark to given CPU, to reduce variance of timings");
+
+    auto dst_file = std::string();
+    cli.add_option("--json", dst_file,
+                   "Path for output JSON file with results");
+
+    auto kernels_cli = cli.add_subcommand("kernels", "Benchmarks each kernel on synthetic inputs");
+    auto kernels_options = KernelsBenchOptions{};
+    kernels_options.densities = {0.05, 0.25, 0.5};
+    add_benchmark_options(*kernels_cli, kernels_options.benchmark);
+    kernels_cli->add_option("--sizes", kernels_options.sizes,
+                            "Resolutions to use (vga, hd, fhd, 12mp, 48mp). If ommited, all of them are used");
+    kernels_cli->add_option("--densities", kernels_options.densities,
+                            "Fractions of set pixels in masks used by binary kernels", true);
+    kernels_cli->add_option("--filter", kernels_options.filter,
+                            "Runs only kernels with names containing given string");
+
+    auto corpus_cli = cli.add_subcommand("corpus", "Benchmarks detection on directories of images with config.json");
+    auto corpus_options = CorpusBenchOptions{};
+    corpus_options.directories = {"assets/camera", "assets/net"};
+    add_benchmark_options(*corpus_cli, corpus_options.benchmark);
+    corpus_cli->add_option("--dirs", corpus_options.directories,
+                           "Directories with images and config.json", true)
+        ->check(CLI::ExistingDirectory);
+
+    corpus_cli->add_option("--frames", corpus_options.frames_files,
+                           "Raw frames files (see make_raw_frames) to use instead of directories, skipping decoding")
+        ->check(CLI::ExistingFile);
+
+    corpus_cli->add_flag("--perf", corpus_options.perf,
+                         "Reads hardware performance counters around each detection stage (Linux only)");
+
+    auto baseline_file = std::string();
+    corpus_cli->add_option("--baseline", baseline_file,
+                           "Path to JSON file written earlier with --json. Fails, if results regressed against it")
+        ->check(CLI::ExistingFile);
+
+    auto logos_baseline_file = std::string();
+    corpus_cli->add_option("--logos-baseline", logos_baseline_file,
+                           "Path for output JSON file with found logos only, to be committed as baseline of assets");
+
+    auto max_regression = 10.0;
+    corpus_cli->add_option("--max-regression", max_regression,
+                           "Allowed increase of median latency of each image, in percents", true)
+        ->check(CLI::Range(0.0, 1000.0));
+
+    CLI11_PARSE(cli, argc, argv);
+
+    try
+    {
+        if(cpu >= 0 && !pin_to_cpu(cpu))
+        {
+            std::printf("Warning: could not pin to CPU %d, running unpinned\n", cpu);
+            cpu = -1;
+        }
+
+        auto json = nlohmann::json();
+        auto passed = true;
+
+        if(*kernels_cli)
+        {
+            json["context"] = make_benchmark_context(kernels_options.benchmark, cpu);
+            json["benchmarks"] = nlohmann::json::array();
+            for(const auto& result : run_kernels_benchmarks(kernels_options))
+            {
+                json["benchmarks"].push_back(to_json(result));
+            }
+        }
+        else
+        {
+            const auto results = run_corpus_benchmark(corpus_options);
+            json["context"] = make_benchmark_context(corpus_options.benchmark, cpu);
+            json["benchmarks"] = to_json(results);
+
+            if(!baseline_file.empty())
+            {
+                passed = compare_with_baseline(results, read_json_file(baseline_file), max_regression);
+                std::printf("Comparison with baseline %s\n", passed ? "passed" : "FAILED");
+            }
+
+            if(!logos_baseline_file.empty())
+            {
+                write_json(logos_baseline_file, to_logos_baseline_json(results));
+            }
+        }
+
+        if(!dst_file.empty())
+        {
+            write_json(dst_file, json);
+        }
+
+        return passed ? 0 : RegressionExitCode;
+    }
+    catch(std::exception& ex)
+    {
+        std::printf("Error: %s\n", ex.what());
+        return -1;
+    }
+}
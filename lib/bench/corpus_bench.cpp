@@ -0,0 +1,295 @@
+#include "corpus_bench.hpp"
+
+#include <cstdio>
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <map>
+
+#include <opencv2/opencv.hpp>
+
+#include "frame.hpp"
+#include "PepsiDetector.hpp"
+#include "PerfCounters.hpp"
+#include "rawframes.hpp"
+#include "test_support.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::vector<fs::path> list_images(const fs::path& directory)
+{
+    auto images = std::vector<fs::path>();
+    for(const auto& entry : fs::directory_iterator(directory))
+    {
+        if(entry.is_regular_file() && is_image_file(entry.path()))
+        {
+            images.push_back(entry.path());
+        }
+    }
+
+    // Directory order is unspecified, but results have to be comparable between runs
+    std::sort(images.begin(), images.end());
+    return images;
+}
+
+nlohmann::json to_json(const Logo& logo)
+{
+    return nlohmann::json::array({logo.x, logo.y, logo.width, logo.height});
+}
+
+nlohmann::json to_json(const Logos& logos)
+{
+    auto json = nlohmann::json::array();
+    for(const auto& logo : logos)
+    {
+        json.push_back(to_json(logo));
+    }
+
+    return json;
+}
+
+Logo logo_from_json(const nlohmann::json& json)
+{
+    return Logo{json.at(0).get<int>(), json.at(1).get<int>(),
+                json.at(2).get<int>(), json.at(3).get<int>()};
+}
+
+double to_milliseconds(BenchmarkTime time)
+{
+    return std::chrono::duration<double, std::milli>(time).count();
+}
+
+void add_stages_values(std::array<PerfValues, StagesMax>& sum, const PerfStageObserver& observer)
+{
+    for(auto i = 0; i < StagesMax; ++i)
+    {
+        const auto& values = observer.stage_values(static_cast<Stage>(i));
+        for(auto j = 0; j < PerfEventsMax; ++j)
+        {
+            sum[i][j] += values[j];
+        }
+    }
+}
+
+void print_stages_values(const PerfCounters& counters, const std::array<PerfValues, StagesMax>& sum,
+                         double megapixels)
+{
+    std::printf("Hardware counters per megapixel:\n%-12s", "stage");
+    for(auto j = 0; j < PerfEventsMax; ++j)
+    {
+        std::printf(" %14s", get_perf_event_name(static_cast<PerfEvent>(j)));
+    }
+    std::printf("\n");
+
+    for(auto i = 0; i < StagesMax; ++i)
+    {
+        std::printf("%-12s", get_stage_name(static_cast<Stage>(i)));
+        for(auto j = 0; j < PerfEventsMax; ++j)
+        {
+            if(counters.available(static_cast<PerfEvent>(j)))
+            {
+                std::printf(" %14.0f", sum[i][j] / megapixels);
+            }
+            else
+            {
+                std::printf(" %14s", "n/a");
+            }
+        }
+        std::printf("\n");
+    }
+}
+
+} // namespace
+
+CorpusResults run_corpus_benchmark(const CorpusBenchOptions& options)
+{
+    auto results = CorpusResults();
+    auto total_megapixels = 0.0;
+    auto total_time = BenchmarkTime{0};
+
+    const auto counters = PerfCounters{};
+    auto observer = PerfStageObserver{counters};
+    auto stages_values = std::array<PerfValues, StagesMax>{};
+
+    const auto use_perf = (options.perf && counters.available());
+    if(options.perf && !use_perf)
+    {
+        std::printf("Warning: hardware counters are not available, reporting timings only\n");
+    }
+
+    const auto benchmark_image = [&](const std::string& name, const cv::Mat& img, const PepsiDetector& detector)
+    {
+        auto logos = Logos();
+        auto measurement = measure(options.benchmark, [&]() { logos = detector.find_logos(img); });
+
+        auto result = CorpusImageResult{
+            summarize(name, img.cols, img.rows, -1.0, std::move(measurement)),
+            std::move(logos),
+            nlohmann::json()
+        };
+        print_result(result.timing);
+
+        if(use_perf)
+        {
+            observer.reset();
+            auto stats = DetectionStats{};
+            stats.observer = &observer;
+            detector.find_logos(img, stats);
+
+            result.perf = to_json(counters, observer, img.total() / 1e6);
+            add_stages_values(stages_values, observer);
+        }
+
+        total_megapixels += (img.total() / 1e6);
+        total_time += result.timing.median;
+        results.push_back(std::move(result));
+    };
+
+    if(!options.frames_files.empty())
+    {
+        auto detectors = std::map<fs::path, PepsiDetector>();
+        for(const auto& frames_file : options.frames_files)
+        {
+            const auto frames = RawFramesFile{frames_file};
+            for(auto i = std::size_t{0}; i < frames.size(); ++i)
+            {
+                // Names are same as in directories mode, so results may be compared with either
+                const auto name = fs::path{frames.frame_name(i)};
+                const auto directory = name.parent_path();
+                auto it = detectors.find(directory);
+                if(it == detectors.end())
+                {
+                    it = detectors.emplace(directory, PepsiDetector{read_config(directory / "config.json")}).first;
+                }
+
+                benchmark_image(name.generic_string(), frames.frame(i), it->second);
+            }
+        }
+    }
+    else
+    {
+        for(const auto& directory : options.directories)
+        {
+            const auto detector = PepsiDetector{read_config(fs::path{directory} / "config.json")};
+
+            for(const auto& image_file : list_images(directory))
+            {
+                const auto img = cv::imread(image_file.string(), cv::IMREAD_COLOR);
+                if(img.empty())
+                {
+                    throw std::runtime_error("Could not read image file: " + image_file.string());
+                }
+
+                benchmark_image(image_file.generic_string(), img, detector);
+            }
+        }
+    }
+
+    const auto total_seconds = std::chrono::duration<double>(total_time).count();
+    std::printf("Processed %zu images (%.1f MP) in %.3f ms, throughput %.1f MP/s\n",
+                results.size(), total_megapixels, to_milliseconds(total_time),
+                (total_seconds > 0.0) ? (total_megapixels / total_seconds) : 0.0);
+
+    if(use_perf && total_megapixels > 0.0)
+    {
+        print_stages_values(counters, stages_values, total_megapixels);
+    }
+
+    return results;
+}
+
+nlohmann::json to_json(const CorpusResults& results)
+{
+    auto json = nlohmann::json::array();
+    for(const auto& result : results)
+    {
+        auto result_json = to_json(result.timing);
+        result_json["logos"] = to_json(result.logos);
+
+        if(!result.perf.is_null())
+        {
+            result_json["perf"] = result.perf;
+        }
+
+        json.push_back(std::move(result_json));
+    }
+
+    return json;
+}
+
+nlohmann::json to_logos_baseline_json(const CorpusResults& results)
+{
+    auto json = nlohmann::json::array();
+    for(const auto& result : results)
+    {
+        json.push_back({{"name", result.timing.name}, {"logos", to_json(result.logos)}});
+    }
+
+    return nlohmann::json{{"benchmarks", std::move(json)}};
+}
+
+bool compare_with_baseline(const CorpusResults& results, const nlohmann::json& baseline,
+                           double max_regression_percent)
+{
+    auto baseline_images = std::map<std::string, const nlohmann::json*>();
+    for(const auto& image : baseline.at("benchmarks"))
+    {
+        baseline_images[image.at("name").get<std::string>()] = &image;
+    }
+
+    auto passed = true;
+    for(const auto& result : results)
+    {
+        const auto& name = result.timing.name;
+        const auto it = baseline_images.find(name);
+        if(it == baseline_images.end())
+        {
+            std::printf("NEW        %s: not present in baseline\n", name.c_str());
+            continue;
+        }
+
+        const auto& image = *it->second;
+        baseline_images.erase(it);
+
+        auto baseline_logos = Logos();
+        for(const auto& logo : image.at("logos"))
+        {
+            baseline_logos.push_back(logo_from_json(logo));
+        }
+
+        if(result.logos != baseline_logos)
+        {
+            std::printf("CHANGED    %s: found %zu logos, baseline has %zu, or they differ\n",
+                        name.c_str(), result.logos.size(), baseline_logos.size());
+            passed = false;
+        }
+
+        // Committed baseline has only logos, as timings are specific to the machine
+        if(image.count("median_ns") == 0)
+        {
+            continue;
+        }
+
+        const auto baseline_median = BenchmarkTime{image.at("median_ns").get<BenchmarkTime::rep>()};
+        const auto limit = to_milliseconds(baseline_median) * (1.0 + max_regression_percent / 100.0);
+        const auto median = to_milliseconds(result.timing.median);
+        if(median > limit)
+        {
+            std::printf("REGRESSED  %s: %.3f ms, baseline %.3f ms (%+.1f%%)\n",
+                        name.c_str(), median, to_milliseconds(baseline_median),
+                        100.0 * (median / to_milliseconds(baseline_median) - 1.0));
+            passed = false;
+        }
+    }
+
+    for(const auto& [name, image] : baseline_images)
+    {
+        std::printf("MISSING    %s: present in baseline, but not benchmarked\n", name.c_str());
+        passed = false;
+    }
+
+    return passed;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "Benchmark.hpp"
+#include "LogoDetector.hpp"
+
+struct CorpusBenchOptions
+{
+	BenchmarkOptions benchmark;
+	std::vector<std::string> directories;
+	std::vector<std::string> frames_files; // Used instead of directories, if given
+	bool perf = false;
+};
+
+struct CorpusImageResult
+{
+	BenchmarkResult timing;
+	Logos logos;
+	nlohmann::json perf; // Counters of each stage per megapixel, if requested and available
+};
+
+using CorpusResults = std::vector<CorpusImageResult>;
+
+/**
+ * @brief Runs detection over every image in given directories
+ * Each directory has to contain config.json with detector configuration. If raw frames files
+ *  are given, their memory-mapped frames are used instead, so decoding is skipped entirely.
+ *  Frames are named after their source images, and config.json is read from their directories.
+ *  If requested, hardware counters of each stage are read in one more, untimed call.
+ */
+CorpusResults run_corpus_benchmark(const CorpusBenchOptions& options);
+
+nlohmann::json to_json(const CorpusResults& results);
+
+/**
+ * @brief Returns baseline with logos found in each image, but without timings
+ * Timings are specific to the machine, so only such baseline is committed with assets.
+ */
+nlohmann::json to_logos_baseline_json(const CorpusResults& results);
+
+/**
+ * @brief Compares results with baseline, printing every difference
+ * Returns false, if any image is slower than its baseline by more than given percentage,
+ *  if found logos differ or if some baseline image was not benchmarked.
+ *  Latency is compared only for images, which have it in baseline.
+ */
+bool compare_with_baseline(const CorpusResults& results, const nlohmann::json& baseline,
+                           double max_regression_percent);
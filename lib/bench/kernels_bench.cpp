@@ -0,0 +1,291 @@
+#include "kernels_bench.hpp"
+
+#include <cstdint>
+
+#include <functional>
+#include <vector>
+
+#include "blobs.hpp"
+#include "core.hpp"
+#include "format.hpp"
+#include "moments.hpp"
+#include "morpho.hpp"
+
+namespace {
+
+constexpr auto MaskBlockSize = 8;
+
+const auto BlueRange = ColorRange{cv::Vec3b{100, 100, 20}, cv::Vec3b{132, 255, 255}};
+
+using BenchCase = std::function<BenchmarkResult(const BenchmarkOptions&, cv::Size, double)>;
+
+struct Kernel
+{
+    const char* name;
+    bool uses_mask;
+    BenchCase run;
+};
+
+cv::Mat_<cv::Vec3b> make_random_image(cv::Size size)
+{
+    auto rng = cv::RNG{0x5eed};
+    auto img = cv::Mat_<cv::Vec3b>(size);
+    rng.fill(img, cv::RNG::UNIFORM, cv::Scalar::all(0), cv::Scalar::all(256));
+    return img;
+}
+
+/**
+ * @brief Makes mask with given fraction of set pixels
+ * Pixels are set in square blocks, so the mask resembles thresholded image
+ *  (with many blobs of different shapes) rather than salt and pepper noise.
+ */
+cv::Mat_<uchar> make_random_mask(cv::Size size, double density, std::uint64_t seed = 0xb10b)
+{
+    const auto blocks_size = cv::Size{(size.width + MaskBlockSize - 1) / MaskBlockSize,
+                                      (size.height + MaskBlockSize - 1) / MaskBlockSize};
+
+    auto rng = cv::RNG{seed};
+    auto noise = cv::Mat_<float>(blocks_size);
+    rng.fill(noise, cv::RNG::UNIFORM, cv::Scalar::all(0.0), cv::Scalar::all(1.0));
+
+    auto blocks = cv::Mat_<uchar>(blocks_size);
+    for(auto y = 0; y < blocks.rows; ++y)
+    {
+        const auto noise_row = noise.ptr<float>(y);
+        auto blocks_row = blocks.ptr<uchar>(y);
+        for(auto x = 0; x < blocks.cols; ++x)
+        {
+            blocks_row[x] = (noise_row[x] < density) ? 255 : 0;
+        }
+    }
+
+    auto mask = cv::Mat_<uchar>();
+    cv::resize(blocks, mask, blocks_size * MaskBlockSize, 0, 0, cv::INTER_NEAREST);
+    return mask(cv::Rect{cv::Point{0, 0}, size}).clone();
+}
+
+BenchmarkResult bench_threshold(const BenchmarkOptions& options, cv::Size size, double /*density*/)
+{
+    const auto src = make_random_image(size);
+    auto dst = cv::Mat_<uchar>(size);
+
+    auto measurement = measure(options, [&]() { threshold(src, dst, BlueRange); });
+    return summarize("threshold", size.width, size.height, -1.0, std::move(measurement));
+}
+
+BenchmarkResult bench_bitwise_or(const BenchmarkOptions& options, cv::Size size, double density)
+{
+    const auto src1 = make_random_mask(size, density);
+    const auto src2 = make_random_mask(size, density, 0xb10c);
+    auto dst = cv::Mat_<uchar>(size);
+
+    auto measurement = measure(options, [&]() { bitwise_or(src1, src2, dst); });
+    return summarize("bitwise_or", size.width, size.height, density, std::move(measurement));
+}
+
+BenchmarkResult bench_filter_image(const BenchmarkOptions& options, cv::Size size, double /*density*/)
+{
+    const auto src = make_random_image(size);
+    auto dst = cv::Mat_<cv::Vec3b>(size);
+    const auto kernel = cv::Mat_<float>{cv::Size{3, 3}, 1.0f / 9};
+
+    auto measurement = measure(options, [&]() { filter_image(src, dst, kernel); });
+    return summarize("filter_image", size.width, size.height, -1.0, std::move(measurement));
+}
+
+BenchmarkResult bench_bgr2hsv(const BenchmarkOptions& options, cv::Size size, double /*density*/)
+{
+    const auto src = make_random_image(size);
+    auto dst = cv::Mat_<cv::Vec3b>(size);
+
+    auto measurement = measure(options, [&]() { bgr2hsv(src, dst); });
+    return summarize("bgr2hsv", size.width, size.height, -1.0, std::move(measurement));
+}
+
+BenchmarkResult bench_erode(const BenchmarkOptions& options, cv::Size size, double density)
+{
+    const auto src = make_random_mask(size, density);
+    auto dst = cv::Mat_<uchar>(size);
+    const cv::Mat_<uchar> kernel = cv::Mat_<uchar>::ones(cv::Size{3, 3});
+
+    auto measurement = measure(options, [&]() { erode(src, dst, kernel); });
+    return summarize("erode", size.width, size.height, density, std::move(measurement));
+}
+
+BenchmarkResult bench_dilate(const BenchmarkOptions& options, cv::Size size, double density)
+{
+    const auto src = make_random_mask(size, density);
+    auto dst = cv::Mat_<uchar>(size);
+    const cv::Mat_<uchar> kernel = cv::Mat_<uchar>::ones(cv::Size{3, 3});
+
+    auto measurement = measure(options, [&]() { dilate(src, dst, kernel); });
+    return summarize("dilate", size.width, size.height, density, std::move(measurement));
+}
+
+BenchmarkResult bench_find_blobs(const BenchmarkOptions& options, cv::Size size, double density)
+{
+    // find_blobs clears the mask, so it is restored before each repetition
+    const auto src = make_random_mask(size, density);
+    auto mask = cv::Mat_<uchar>(size);
+    auto blobs = Blobs();
+
+    auto measurement = measure(options,
+                         [&]() { src.copyTo(mask); },
+                         [&]() { blobs = find_blobs(mask); });
+    return summarize("find_blobs", size.width, size.height, density, std::move(measurement));
+}
+
+/**
+ * @brief Finds blobs in random mask, as inputs of moments kernels
+ */
+Blobs make_random_blobs(cv::Size size, double density)
+{
+    auto mask = make_random_mask(size, density);
+    return find_blobs(mask);
+}
+
+BenchmarkResult bench_spatial_moments(const BenchmarkOptions& options, cv::Size size, double density)
+{
+    const auto blobs = make_random_blobs(size, density);
+    auto moments = std::vector<SpatialMoments>(blobs.size());
+
+    auto measurement = measure(options, [&]() {
+        for(auto i = std::size_t{0}; i < blobs.size(); ++i)
+        {
+            moments[i] = calc_spatial_moments(blobs[i]);
+        }
+    });
+    return summarize("calc_spatial_moments", size.width, size.height, density, std::move(measurement));
+}
+
+BenchmarkResult bench_central_moments(const BenchmarkOptions& options, cv::Size size, double density)
+{
+    const auto blobs = make_random_blobs(size, density);
+    auto moments = std::vector<CentralMoments>(blobs.size());
+
+    auto measurement = measure(options, [&]() {
+        for(auto i = std::size_t{0}; i < blobs.size(); ++i)
+        {
+            moments[i] = calc_central_moments(blobs[i]);
+        }
+    });
+    return summarize("calc_central_moments", size.width, size.height, density, std::move(measurement));
+}
+
+BenchmarkResult bench_normalized_moments(const BenchmarkOptions& options, cv::Size size, double density)
+{
+    const auto blobs = make_random_blobs(size, density);
+    auto central_moments = std::vector<CentralMoments>();
+    for(const auto& blob : blobs)
+    {
+        central_moments.push_back(calc_central_moments(blob));
+    }
+    auto moments = std::vector<NormalizedMoments>(blobs.size());
+
+    auto measurement = measure(options, [&]() {
+        for(auto i = std::size_t{0}; i < blobs.size(); ++i)
+        {
+            moments[i] = calc_normalized_moments(central_moments[i], static_cast<SpatialMoment>(blobs[i].size()));
+        }
+    });
+    return summarize("calc_normalized_moments", size.width, size.height, density, std::move(measurement));
+}
+
+BenchmarkResult bench_hu_moments(const BenchmarkOptions& options, cv::Size size, double density)
+{
+    const auto blobs = make_random_blobs(size, density);
+    auto normalized_moments = std::vector<NormalizedMoments>();
+    for(const auto& blob : blobs)
+    {
+        normalized_moments.push_back(calc_normalized_moments(calc_central_moments(blob),
+                                                             static_cast<SpatialMoment>(blob.size())));
+    }
+    auto moments = HuMomentsArray(blobs.size());
+
+    auto measurement = measure(options, [&]() {
+        for(auto i = std::size_t{0}; i < blobs.size(); ++i)
+        {
+            moments[i] = calc_hu_moments(normalized_moments[i]);
+        }
+    });
+    return summarize("calc_hu_moments", size.width, size.height, density, std::move(measurement));
+}
+
+BenchmarkResult bench_blobs_hu_moments(const BenchmarkOptions& options, cv::Size size, double density)
+{
+    const auto blobs = make_random_blobs(size, density);
+    auto hu_moments = HuMomentsArray();
+
+    auto measurement = measure(options, [&]() { hu_moments = calc_blobs_hu_moments(blobs); });
+    return summarize("calc_blobs_hu_moments", size.width, size.height, density, std::move(measurement));
+}
+
+const Kernel Kernels[] = {
+    {"threshold", false, bench_threshold},
+    {"bitwise_or", true, bench_bitwise_or},
+    {"filter_image", false, bench_filter_image},
+    {"bgr2hsv", false, bench_bgr2hsv},
+    {"erode", true, bench_erode},
+    {"dilate", true, bench_dilate},
+    {"find_blobs", true, bench_find_blobs},
+    {"calc_spatial_moments", true, bench_spatial_moments},
+    {"calc_central_moments", true, bench_central_moments},
+    {"calc_normalized_moments", true, bench_normalized_moments},
+    {"calc_hu_moments", true, bench_hu_moments},
+    {"calc_blobs_hu_moments", true, bench_blobs_hu_moments},
+};
+
+bool matches_filter(const char* name, const std::string& filter)
+{
+    return (filter.empty() || std::string(name).find(filter) != std::string::npos);
+}
+
+} // namespace
+
+std::vector<std::pair<std::string, cv::Size>> get_bench_sizes()
+{
+    return {
+        {"vga", cv::Size{640, 480}},
+        {"hd", cv::Size{1280, 720}},
+        {"fhd", cv::Size{1920, 1080}},
+        {"12mp", cv::Size{4000, 3000}},
+        {"48mp", cv::Size{8000, 6000}},
+    };
+}
+
+BenchmarkResults run_kernels_benchmarks(const KernelsBenchOptions& options)
+{
+    auto results = BenchmarkResults();
+
+    for(const auto& [size_name, size] : get_bench_sizes())
+    {
+        if(!options.sizes.empty()
+            && std::find(options.sizes.begin(), options.sizes.end(), size_name) == options.sizes.end())
+        {
+            continue;
+        }
+
+        for(const auto& kernel : Kernels)
+        {
+            if(!matches_filter(kernel.name, options.filter))
+            {
+                continue;
+            }
+
+            if(!kernel.uses_mask)
+            {
+                results.push_back(kernel.run(options.benchmark, size, -1.0));
+                print_result(results.back());
+                continue;
+            }
+
+            for(const auto density : options.densities)
+            {
+                results.push_back(kernel.run(options.benchmark, size, density));
+                print_result(results.back());
+            }
+        }
+    }
+
+    return results;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "Benchmark.hpp"
+
+struct KernelsBenchOptions
+{
+	BenchmarkOptions benchmark;
+	std::vector<std::string> sizes;
+	std::vector<double> densities;
+	std::string filter;
+};
+
+/**
+ * @brief Named resolutions available for kernels benchmarks, from VGA to 48 MP
+ */
+std::vector<std::pair<std::string, cv::Size>> get_bench_sizes();
+
+BenchmarkResults run_kernels_benchmarks(const KernelsBenchOptions& options);
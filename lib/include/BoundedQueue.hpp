@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cassert>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+/**
+ * @brief Fixed capacity FIFO queue, connecting two pipeline stages
+ * Producer blocks when queue is full (unless it uses try_push), consumer blocks when queue is empty.
+ * After closing, remaining items may still be popped, then pop returns nothing.
+ */
+template<typename T>
+class BoundedQueue
+{
+public:
+	explicit BoundedQueue(std::size_t capacity)
+		:	m_capacity(capacity)
+	{
+		assert(capacity > 0);
+	}
+
+	/**
+	 * @brief Pushes an item, waiting for free space if needed
+	 * @return false, if queue was closed and item was not pushed
+	 */
+	bool push(T item)
+	{
+		auto lock = std::unique_lock<std::mutex>(m_mutex);
+		m_not_full.wait(lock, [this]() { return (m_closed || m_items.size() < m_capacity); });
+		if(m_closed)
+		{
+			return false;
+		}
+
+		m_items.push_back(std::move(item));
+		lock.unlock();
+		m_not_empty.notify_one();
+		return true;
+	}
+
+	/**
+	 * @brief Pushes an item only if there is free space, never waits
+	 * @return false, if queue was full or closed and item was not pushed
+	 */
+	bool try_push(T item)
+	{
+		auto lock = std::unique_lock<std::mutex>(m_mutex);
+		if(m_closed || m_items.size() >= m_capacity)
+		{
+			return false;
+		}
+
+		m_items.push_back(std::move(item));
+		lock.unlock();
+		m_not_empty.notify_one();
+		return true;
+	}
+
+	/**
+	 * @brief Pops an item, waiting for one if queue is empty
+	 * @return Nothing, if queue was closed and drained
+	 */
+	std::optional<T> pop()
+	{
+		auto lock = std::unique_lock<std::mutex>(m_mutex);
+		m_not_empty.wait(lock, [this]() { return (m_closed || !m_items.empty()); });
+		if(m_items.empty())
+		{
+			return std::nullopt;
+		}
+
+		auto item = std::move(m_items.front());
+		m_items.pop_front();
+		lock.unlock();
+		m_not_full.notify_one();
+		return item;
+	}
+
+	/**
+	 * @brief Marks end of the stream and wakes up all waiting stages
+	 */
+	void close()
+	{
+		{
+			const auto lock = std::lock_guard<std::mutex>(m_mutex);
+			m_closed = true;
+		}
+
+		m_not_empty.notify_all();
+		m_not_full.notify_all();
+	}
+
+private:
+	const std::size_t m_capacity;
+	std::deque<T> m_items;
+	bool m_closed = false;
+
+	std::mutex m_mutex;
+	std::condition_variable m_not_empty;
+	std::condition_variable m_not_full;
+};
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "LogoDetector.hpp"
+
+#include <cstddef>
+
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "PepsiDetector.hpp"
+#include "blobs.hpp"
+#include "moments.hpp"
+#include "types.hpp"
+
+/**
+ * @brief Detector of many kinds of logos, each made of blobs of given colours
+ * Image is enhanced and converted to HSV once per call. Mask and blobs of each colour class
+ *  are made once too, only when the first logo using that colour needs them, and are shared
+ *  by all logos using it. Logo is skipped as soon as one of its parts has no candidates.
+ */
+class MultiLogoDetector
+	:	public LogoDetector
+{
+public:
+	/**
+	 * @brief Named colour, given by HSV ranges. Pixel falling into any of them has that colour
+	 */
+	struct ColorClass
+	{
+		std::string name;
+		ColorRanges ranges;
+	};
+
+	/**
+	 * @brief Filters of blobs making one part of logo
+	 * Centre of each part, except the first one, must lie within given distance from centre of the first part.
+	 */
+	struct PartDefinition
+	{
+		std::size_t color; // Index of colour class
+		BlobAreaRange area_range;
+		HuMomentRange hu0_range;
+		HuMomentRange hu1_range;
+		double max_center_distance;
+	};
+
+	struct LogoDefinition
+	{
+		std::string name;
+		std::vector<PartDefinition> parts;
+	};
+
+	struct Config
+	{
+		/**
+		 * @brief Parses config with "colors" object (ranges by colour name) and "logos" array
+		 * Hue range with min greater than max wraps around 180, as red one does.
+		 */
+		static Config from_json(const nlohmann::json& json);
+
+		/**
+		 * @brief Returns config finding the same logos as PepsiDetector with given config does
+		 */
+		static Config from_pepsi(const PepsiDetector::Config& config);
+
+		std::vector<ColorClass> colors;
+		std::vector<LogoDefinition> logos;
+	};
+
+	struct Detection
+	{
+		std::size_t logo_index; // Index of logo definition
+		Logo logo;
+		std::vector<LogoPart> parts; // In order of part definitions
+	};
+
+	using Detections = std::vector<Detection>;
+
+	explicit MultiLogoDetector(Config config);
+
+	Logos find_logos(const cv::Mat& img) const override;
+
+	Detections find_detections(const cv::Mat& img) const;
+
+	const Config& config() const noexcept;
+
+private:
+	struct ColorBlobs;
+	struct PartCandidates;
+
+	ColorBlobs find_color_blobs(std::size_t color, const cv::Mat_<cv::Vec3b>& hsv) const;
+
+	void match_parts(std::size_t logo_index, const std::vector<PartCandidates>& candidates,
+					 Detections& detections) const;
+
+	Config m_config;
+	std::vector<BlobAreaRange> m_colors_area_ranges; // Union of areas accepted by parts of each colour
+};
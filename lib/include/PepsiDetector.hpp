@@ -2,23 +2,62 @@
 
 #include "LogoDetector.hpp"
 
+#include <cstddef>
+#include <cstdint>
+
 #include <array>
 #include <memory>
 
 #include <nlohmann/json.hpp>
 
+#include "blobs.hpp"
 #include "moments.hpp"
+#include "presence.hpp"
+#include "stats.hpp"
+
+/**
+ * @brief Blob of single colour part of the logo
+ */
+struct LogoPart
+{
+	Rect rect;
+	BlobArea area; // In pixels
+};
+
+/**
+ * @brief Logo with parts it was matched from
+ */
+struct Detection
+{
+	Logo logo;
+	LogoPart blue;
+	LogoPart red;
+};
+
+using Detections = std::vector<Detection>;
+
+Logos to_logos(const Detections& detections);
 
 class PepsiDetector
 	:	public LogoDetector
 {
 public:
+	/**
+	 * @brief Version of detection algorithm, e.g. to tell apart results stored by older binaries
+	 * Must be bumped whenever detections found with the same config may change.
+	 */
+	static constexpr std::uint32_t DetectionVersion = 3;
+
 	struct Config
 	{
         Config();
 
         static Config from_json(const nlohmann::json& json);
 
+        Config scaled(double factor) const;
+
+        std::uint64_t hash() const;
+
 		ColorRange blue_range;
 		BlobAreaRange blue_blob_area_range;
 		HuMomentRange blue_blob_hu0_range;
@@ -30,6 +69,10 @@ public:
 		HuMomentRange red_blob_hu1_range;
 
 		double max_blobs_centers_distance;
+
+		bool pyramid;
+		bool part_windows; // Look for the second colour part only around candidates of the first one
+		PrecheckMode precheck; // Reject images without enough blue or red pixels before processing them
 	};
 
 	explicit PepsiDetector(const Config& config = Config());
@@ -43,6 +86,18 @@ public:
 
 	Logos find_logos(const cv::Mat& img) const override;
 
+	Logos find_logos(const cv::Mat& img, DetectionStats& stats) const;
+
+	Logos find_logos(const cv::Mat& img, const Rects& rois) const;
+
+	Logos find_logos(const uchar* bgr, cv::Size size, std::size_t stride) const;
+
+	Detections find_detections(const cv::Mat& img) const;
+
+	Detections find_detections(const cv::Mat& img, DetectionStats& stats) const;
+
+	const Config& config() const noexcept;
+
 private:
 	class Impl;
 	std::unique_ptr<Impl> m_impl;
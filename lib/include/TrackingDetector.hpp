@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+
+#include "PepsiDetector.hpp"
+#include "types.hpp"
+
+/**
+ * @brief Stateful detector for video streams
+ * Full frame detection is run only on keyframes. On the other frames, logos
+ *  are searched only inside expanded regions around logos from the previous frame.
+ *  If some of tracked logos is lost, full frame detection is run again.
+ */
+class TrackingDetector
+{
+public:
+	struct Config
+	{
+		Config();
+
+		int keyframe_interval;
+		int roi_margin;
+	};
+
+	struct FrameStats
+	{
+		bool keyframe = false;
+		std::size_t processed_pixels = 0;
+		std::size_t total_pixels = 0;
+	};
+
+	explicit TrackingDetector(PepsiDetector detector, const Config& config = Config());
+
+	Logos find_logos(const cv::Mat& frame);
+
+	const FrameStats& last_frame_stats() const noexcept;
+
+	void reset() noexcept;
+
+private:
+	Logos detect_keyframe(const cv::Mat& frame);
+
+	Logos detect_tracked(const cv::Mat& frame);
+
+	bool is_keyframe(const cv::Mat& frame) const noexcept;
+
+	PepsiDetector m_detector;
+	Config m_config;
+
+	Logos m_logos;
+	cv::Size m_frame_size;
+	int m_frames_since_keyframe;
+	FrameStats m_stats;
+};
@@ -5,6 +5,13 @@
 #include "types.hpp"
 #include "utility.hpp"
 
+inline bool color_in_range(const cv::Vec3b& color, const ColorRange& color_range) noexcept
+{
+	return (color[0] >= color_range.min[0] && color[0] <= color_range.max[0]
+		&& color[1] >= color_range.min[1] && color[1] <= color_range.max[1]
+		&& color[2] >= color_range.min[2] && color[2] <= color_range.max[2]);
+}
+
 void threshold(const cv::Mat_<cv::Vec3b>& src, cv::Mat_<uchar>& dst,
 		       const ColorRange& color_range);
 
@@ -12,4 +19,12 @@ void bitwise_or(const cv::Mat_<uchar>& src1, const cv::Mat_<uchar>& src2, cv::Ma
 
 void filter_image(const cv::Mat3b& src, cv::Mat3b& dst, const cv::Mat1f& kernel);
 
+const cv::Mat1f& get_unsharp_mask_kernel();
+
+cv::Vec3b filter_pixel(const cv::Mat3b& src, cv::Point point, const cv::Mat1f& kernel);
+
+void downsample(const cv::Mat3b& src, cv::Mat3b& dst, int factor);
+
+ColorRanges get_red_ranges(const ColorRange& red_range);
+
 bool images_equal(const cv::Mat& img1, const cv::Mat& img2);
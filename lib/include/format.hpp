@@ -3,3 +3,5 @@
 #include <opencv2/opencv.hpp>
 
 void bgr2hsv(const cv::Mat_<cv::Vec3b>& src, cv::Mat_<cv::Vec3b>& dst);
+
+cv::Vec3b bgr2hsv(cv::Vec3b bgr);
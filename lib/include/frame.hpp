@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstddef>
+
+#include <filesystem>
+
+#include <opencv2/opencv.hpp>
+
+cv::Mat wrap_bgr_frame(const uchar* data, cv::Size size, std::size_t stride);
+
+bool is_image_file(const std::filesystem::path& path);
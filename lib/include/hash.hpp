@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <opencv2/opencv.hpp>
+
+std::uint64_t hash_bytes(const void* data, std::size_t size, std::uint64_t seed = 0) noexcept;
+
+std::uint64_t hash_image(const cv::Mat& img);
+
+std::uint64_t hash_combine(std::uint64_t seed, std::uint64_t value) noexcept;
@@ -1,13 +1,67 @@
 #pragma once
 
+#include <cstddef>
+
+#include <string>
+
 #include <opencv2/opencv.hpp>
 
 namespace imglog {
 
+/**
+ * @brief Options of headless backend, which writes images to a directory
+ */
+struct DumpOptions
+{
+	std::string directory;
+	std::size_t queue_size = 16;
+	int every_nth_frame = 1;
+};
+
+/**
+ * @brief Enables logging to windows, with cv::imshow
+ */
 void enable() noexcept;
-void disable() noexcept;
+
+/**
+ * @brief Enables logging to a directory, on a background writer thread
+ * Images are encoded as PNG files named after frame index, order within the frame and image name.
+ *  When writer can not keep up, images are dropped instead of stalling the caller.
+ */
+void enable_dump(const DumpOptions& options);
+
+/**
+ * @brief Disables logging. Waits until all queued images are written
+ * May be called while images are logged on other threads. Then the writer is kept alive
+ *  by the last of them, which also waits for its queue.
+ */
+void disable();
+
+/**
+ * @brief Returns true, if images of current frame of the calling thread are logged
+ */
 bool enabled() noexcept;
 
+/**
+ * @brief Marks beginning of next frame (or image) on the calling thread, so only every Nth frame may be logged
+ * Frames begun on all threads are numbered together, so dumped images of each frame have their own prefix.
+ *  Should be called before each image is detected, also in batch and server modes.
+ */
+void begin_frame() noexcept;
+
+/**
+ * @brief Returns number of images dropped by the writer, because its queue was full
+ */
+std::size_t dropped() noexcept;
+
+/**
+ * @brief Logs image, which may be modified later by the caller. It is copied, if needed
+ */
 void log(const char* img_name, const cv::Mat& img);
 
+/**
+ * @brief Logs image, handing it off to the logger, so it does not have to be copied
+ */
+void log(const char* img_name, cv::Mat&& img);
+
 } // imglog
@@ -10,7 +10,7 @@
 
 using SpatialMoment = long long;
 
-using CentralMoment = long long;
+using CentralMoment = double; // Calculated exactly, then rounded
 
 using NormalizedMoment = double;
 
@@ -54,7 +54,7 @@ SpatialMoments calc_spatial_moments(const Blob& blob) noexcept;
 
 Centroid calc_centroid(const SpatialMoments& spatial_moments) noexcept;
 
-CentralMoments calc_central_moments(const Blob& blob, Centroid centroid) noexcept;
+CentralMoments calc_central_moments(const Blob& blob) noexcept;
 
 NormalizedMoments calc_normalized_moments(const CentralMoments& central_moments,
 										  SpatialMoment m00) noexcept;
@@ -6,6 +6,8 @@
 
 #include "types.hpp"
 
+double calc_points_distance(Point a, Point b) noexcept;
+
 Rect calc_bounding_rect(const Points& points);
 
 Rects calc_bounding_rects(const PointsSet& points_set);
@@ -13,3 +15,11 @@ Rects calc_bounding_rects(const PointsSet& points_set);
 void shift_points(Points& points, Point p);
 
 void shift_points_set(PointsSet& points_set, const Points& points);
+
+Rect expand_rect(Rect rect, int margin, cv::Size bounds);
+
+Rect scale_rect(Rect rect, int factor);
+
+Rects scale_rects(Rects rects, int factor);
+
+Rects merge_overlapping_rects(Rects rects);
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "types.hpp"
+
+/**
+ * @brief How presence of logo colours is checked, before image is processed
+ */
+enum class PrecheckMode
+{
+	Off,
+	Estimate, // Sparse grid of raw pixels, images with logos smaller than its cells may be rejected
+	Guarantee, // Grid of enhanced pixels, dense enough to reject only images without any logo
+};
+
+PrecheckMode parse_precheck_mode(const std::string& name);
+
+const char* get_precheck_mode_name(PrecheckMode mode) noexcept;
+
+/**
+ * @brief Counts pixels of grid, which HSV colours fall into each of given colours
+ * Colour is given by ranges, pixel falling into any of them is counted. Grid has given step
+ *  in both directions and contains also the last row and column. If kernel is given, each
+ *  sampled pixel is filtered with it first, exactly as filter_image would do.
+ */
+std::vector<std::size_t> count_grid_colors(const cv::Mat3b& bgr, int step, const cv::Mat1f* kernel,
+                                           const std::vector<ColorRanges>& colors);
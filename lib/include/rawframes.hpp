@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief Container of raw BGR frames, which may be read without decoding
+ * File starts with a header (RawFramesHeader), followed by a table with size and name
+ *  of each frame. Frames follow in slots of equal size, aligned to RawFramesAlignment,
+ *  so memory-mapped frames may be handed to detectors as they are. Frames may be smaller
+ *  than slots (width, height and stride in the header are these of slots), then they
+ *  occupy top-left part of the slot. Numbers are stored in native byte order.
+ */
+constexpr auto RawFramesAlignment = std::size_t{4096};
+
+enum class RawPixelFormat : std::uint32_t
+{
+	Bgr8 = 1,
+};
+
+struct RawFramesHeader
+{
+	char magic[8];
+	std::uint32_t version;
+	RawPixelFormat pixel_format;
+	std::uint32_t width;
+	std::uint32_t height;
+	std::uint64_t stride;
+	std::uint64_t frames_count;
+	std::uint64_t frames_offset;
+	std::uint64_t slot_size;
+};
+
+struct RawFrameEntry
+{
+	std::uint32_t width;
+	std::uint32_t height;
+	char name[248];
+};
+
+struct RawFrame
+{
+	std::string name;
+	cv::Mat img;
+};
+
+/**
+ * @brief Writes BGR images into raw frames container. Names longer than 247 bytes are truncated
+ */
+void write_raw_frames(const std::string& path, const std::vector<RawFrame>& frames);
+
+/**
+ * @brief Memory-mapped raw frames container, opened for reading
+ */
+class RawFramesFile
+{
+public:
+	explicit RawFramesFile(const std::string& path);
+	~RawFramesFile();
+
+	RawFramesFile(const RawFramesFile&) = delete;
+	RawFramesFile& operator=(const RawFramesFile&) = delete;
+
+	std::size_t size() const noexcept;
+
+	/**
+	 * @brief Returns header of the frame, referring to mapped memory. It must not be modified
+	 * Image stays valid as long as the file is open.
+	 */
+	cv::Mat frame(std::size_t index) const;
+
+	std::string frame_name(std::size_t index) const;
+
+private:
+	const RawFrameEntry& entry(std::size_t index) const;
+
+	const unsigned char* m_data;
+	std::size_t m_length;
+	const RawFramesHeader* m_header;
+};
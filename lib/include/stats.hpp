@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstddef>
+
+#include <array>
+#include <chrono>
+#include <vector>
+
+enum class Stage
+{
+	Enhance,
+	Convert,
+	Threshold,
+	Morphology,
+	Labelling,
+	Moments,
+	Matching,
+};
+
+constexpr static auto StagesMax = 7;
+
+const char* get_stage_name(Stage stage) noexcept;
+
+using StageTime = std::chrono::nanoseconds;
+
+using StagesTimes = std::array<StageTime, StagesMax>;
+
+/**
+ * @brief Receives notifications about beginning and end of each detection stage
+ * It may be used to read external measurements (e.g. hardware counters) around stages.
+ */
+class StageObserver
+{
+public:
+	virtual ~StageObserver() = default;
+
+	virtual void begin_stage(Stage stage) = 0;
+
+	virtual void end_stage(Stage stage) = 0;
+};
+
+/**
+ * @brief Numbers of blobs of one color, left after consecutive filters
+ */
+struct BlobsFunnel
+{
+	std::size_t found = 0;
+	std::size_t after_area_filter = 0;
+	std::size_t after_hu_filter = 0;
+};
+
+/**
+ * @brief Numbers of times detection was stopped early, as colour branch left no candidates
+ * Other branch is not run then, so its blobs funnel stays empty.
+ */
+struct CascadeExits
+{
+	std::size_t after_blue = 0;
+	std::size_t after_red = 0;
+};
+
+/**
+ * @brief Windows around candidates of the first colour part, in which the second part was looked for
+ * Pixels are summed over merged windows, or over the whole frame, when it was processed instead
+ *  (windows covering most of it, or blob crossing window border). Their ratio to frame pixels
+ *  tells how much of the second branch work was saved.
+ */
+struct PartWindows
+{
+	std::size_t runs = 0;
+	std::size_t windows = 0;
+	std::size_t pixels = 0;
+	std::size_t frame_pixels = 0;
+	std::size_t fallbacks = 0; // Runs on the whole frame
+};
+
+/**
+ * @brief Numbers of images checked for presence of logo colours, and of images rejected by that check
+ */
+struct PrecheckStats
+{
+	std::size_t runs = 0;
+	std::size_t rejections = 0;
+};
+
+/**
+ * @brief Coarse passes of pyramid mode, finding candidate regions on downsampled image
+ * Their stages and blobs are kept apart, so they are not added to the ones of full resolution pass.
+ */
+struct CoarsePasses
+{
+	std::size_t runs = 0;
+	std::size_t regions = 0; // After merging overlapping ones
+	StageTime time{}; // Downsampling and all stages of coarse detection
+};
+
+/**
+ * @brief Statistics of single detection call
+ * Stage times are summed, if stage was run many times (e.g. for both colors or many regions).
+ */
+struct DetectionStats
+{
+	StagesTimes stages_times{};
+	StageTime total_time{};
+
+	BlobsFunnel blue_blobs;
+	BlobsFunnel red_blobs;
+	std::size_t pairs_tested = 0;
+	std::size_t logos_found = 0;
+	CascadeExits cascade_exits;
+	PartWindows part_windows;
+	PrecheckStats precheck;
+	CoarsePasses coarse;
+
+	StageObserver* observer = nullptr;
+
+	StageTime& stage_time(Stage stage) noexcept
+	{
+		return stages_times[static_cast<std::size_t>(stage)];
+	}
+
+	StageTime stage_time(Stage stage) const noexcept
+	{
+		return stages_times[static_cast<std::size_t>(stage)];
+	}
+};
+
+struct TimeSummary
+{
+	StageTime min{};
+	StageTime mean{};
+	StageTime p99{};
+};
+
+/**
+ * @brief Collects statistics of many detection calls and summarizes them
+ */
+class DetectionStatsAggregator
+{
+public:
+	void add(const DetectionStats& stats);
+
+	std::size_t count() const noexcept;
+
+	TimeSummary summarize_stage(Stage stage) const;
+
+	TimeSummary summarize_total() const;
+
+	DetectionStats sum() const;
+
+private:
+	std::array<std::vector<StageTime>, StagesMax> m_stages_times;
+	std::vector<StageTime> m_total_times;
+	DetectionStats m_sum;
+};
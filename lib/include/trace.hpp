@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+namespace trace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Starts recording of spans, discarding previously recorded ones
+ */
+void enable();
+
+/**
+ * @brief Stops recording of spans. Recorded ones are kept, until next enable
+ */
+void disable() noexcept;
+
+bool enabled() noexcept;
+
+/**
+ * @brief Names calling thread in the trace. Name has to outlive the tracer (e.g. literal)
+ */
+void set_thread_name(const char* name) noexcept;
+
+/**
+ * @brief Records span of given name, begun at given time and ending now
+ * Spans are appended to buffer of calling thread, without locking.
+ */
+void record(const char* name, Clock::time_point start);
+
+/**
+ * @brief Writes recorded spans as Chrome Trace Event JSON (loadable in Perfetto or chrome://tracing)
+ * It should be called when traced threads do not record anymore (e.g. after joining them).
+ */
+void write(const std::string& dst_file);
+
+/**
+ * @brief Records span from its construction to destruction, if tracing is enabled
+ */
+class Span
+{
+public:
+	explicit Span(const char* name) noexcept
+		:	m_name(enabled() ? name : nullptr)
+	{
+		if(m_name)
+		{
+			m_start = Clock::now();
+		}
+	}
+
+	~Span()
+	{
+		if(m_name)
+		{
+			record(m_name, m_start);
+		}
+	}
+
+	Span(const Span&) = delete;
+	Span& operator=(const Span&) = delete;
+
+private:
+	const char* m_name;
+	Clock::time_point m_start;
+};
+
+} // namespace trace
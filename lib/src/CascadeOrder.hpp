@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+
+/**
+ * @brief Colour branch of detection cascade
+ */
+enum class CascadeBranch
+{
+	Blue,
+	Red,
+};
+
+using CascadeBranches = std::array<CascadeBranch, 2>;
+
+/**
+ * @brief Chooses order of colour branches from their measured selectivity and cost
+ * Logo requires both parts, so detection stops after the first branch leaving no candidates.
+ *  Expected cost is the lowest, when branches are run in descending order of
+ *  (probability of leaving no candidates) / (mean time). Probability is measured only when
+ *  branch is run first, as later it would be conditioned on the preceding one. So every
+ *  ExplorationInterval-th call runs the other branch first. Counters are atomic,
+ *  because detector is shared between threads, but they only steer the order, never results.
+ */
+class CascadeOrder
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	static constexpr auto ExplorationInterval = std::uint64_t{32};
+
+	CascadeOrder() noexcept = default;
+
+	CascadeOrder(const CascadeOrder& other) noexcept
+	{
+		*this = other;
+	}
+
+	CascadeOrder& operator=(const CascadeOrder& other) noexcept
+	{
+		for(auto i = std::size_t{0}; i < m_branches.size(); ++i)
+		{
+			auto& branch = m_branches[i];
+			const auto& other_branch = other.m_branches[i];
+			branch.runs_first.store(other_branch.runs_first.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			branch.empties_first.store(other_branch.empties_first.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			branch.runs.store(other_branch.runs.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			branch.time_ns.store(other_branch.time_ns.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		}
+
+		m_calls.store(other.m_calls.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		return *this;
+	}
+
+	CascadeBranches choose() const noexcept
+	{
+		const auto call = m_calls.fetch_add(1, std::memory_order_relaxed);
+		auto blue_first = (score(CascadeBranch::Blue) >= score(CascadeBranch::Red));
+		if(call % ExplorationInterval == ExplorationInterval - 1)
+		{
+			blue_first = !blue_first;
+		}
+
+		return blue_first
+			? CascadeBranches{CascadeBranch::Blue, CascadeBranch::Red}
+			: CascadeBranches{CascadeBranch::Red, CascadeBranch::Blue};
+	}
+
+	void record(CascadeBranch branch, bool first, bool empty, Clock::duration time) const noexcept
+	{
+		auto& counters = m_branches[static_cast<std::size_t>(branch)];
+		if(first)
+		{
+			counters.runs_first.fetch_add(1, std::memory_order_relaxed);
+			if(empty)
+			{
+				counters.empties_first.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+		counters.runs.fetch_add(1, std::memory_order_relaxed);
+		counters.time_ns.fetch_add(static_cast<std::uint64_t>(ns), std::memory_order_relaxed);
+	}
+
+private:
+	struct Counters
+	{
+		std::atomic<std::uint64_t> runs_first{0};
+		std::atomic<std::uint64_t> empties_first{0};
+		std::atomic<std::uint64_t> runs{0};
+		std::atomic<std::uint64_t> time_ns{0};
+	};
+
+	/**
+	 * @brief Returns probability of leaving no candidates per nanosecond, with priors for branches not measured yet
+	 */
+	double score(CascadeBranch branch) const noexcept
+	{
+		const auto& counters = m_branches[static_cast<std::size_t>(branch)];
+		const auto empties = static_cast<double>(counters.empties_first.load(std::memory_order_relaxed));
+		const auto runs_first = static_cast<double>(counters.runs_first.load(std::memory_order_relaxed));
+		const auto runs = static_cast<double>(counters.runs.load(std::memory_order_relaxed));
+		const auto time_ns = static_cast<double>(counters.time_ns.load(std::memory_order_relaxed));
+
+		const auto probability = ((empties + 1.0) / (runs_first + 2.0));
+		const auto mean_time = (runs > 0.0) ? std::max(time_ns / runs, 1.0) : 1.0;
+		return (probability / mean_time);
+	}
+
+	mutable std::array<Counters, 2> m_branches;
+	mutable std::atomic<std::uint64_t> m_calls{0};
+};
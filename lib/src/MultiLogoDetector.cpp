@@ -0,0 +1,380 @@
+#include "MultiLogoDetector.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+
+#include "core.hpp"
+#include "format.hpp"
+#include "log.hpp"
+#include "morpho.hpp"
+#include "points.hpp"
+#include "trace.hpp"
+
+using nlohmann::json;
+
+namespace {
+
+cv::Vec3b parse_color(const json& j)
+{
+    return cv::Vec3b{j.at(0).get<uchar>(), j.at(1).get<uchar>(), j.at(2).get<uchar>()};
+}
+
+template<typename T>
+ValueRange<T> parse_range(const json& j)
+{
+    return ValueRange<T>{j.at("min").get<T>(), j.at("max").get<T>()};
+}
+
+/**
+ * @brief Parses HSV range, splitting it in two, if hue wraps around 180
+ */
+ColorRanges parse_color_ranges(const json& j)
+{
+    const auto range = ColorRange{parse_color(j.at("min")), parse_color(j.at("max"))};
+    if(range.min[0] <= range.max[0])
+    {
+        return ColorRanges{range};
+    }
+
+    auto left_range = range;
+    left_range.min[0] = 0;
+
+    auto right_range = range;
+    right_range.max[0] = 180;
+
+    return ColorRanges{left_range, right_range};
+}
+
+std::size_t find_color(const std::vector<MultiLogoDetector::ColorClass>& colors, const std::string& name)
+{
+    const auto it = std::find_if(colors.begin(), colors.end(),
+                                 [&name](const auto& color) { return (color.name == name); });
+    if(it == colors.end())
+    {
+        throw std::invalid_argument("Unknown colour of logo part: " + name);
+    }
+
+    return static_cast<std::size_t>(it - colors.begin());
+}
+
+/**
+ * @brief Returns centre of blob bounding rect, which bottom right corner is its last pixel (as in PepsiDetector)
+ */
+Point get_rect_center(const Rect& rect) noexcept
+{
+    return Point{(rect.x + rect.br().x) / 2, (rect.y + rect.br().y) / 2};
+}
+
+bool is_in_range(BlobArea area, BlobAreaRange range) noexcept
+{
+    return (area >= range.min && area <= range.max);
+}
+
+bool is_in_range(HuMoment hu, HuMomentRange range) noexcept
+{
+    return (hu >= range.min && hu <= range.max);
+}
+
+} // namespace
+
+/**
+ * @brief Blobs of single colour class, with area accepted by some part of that colour
+ */
+struct MultiLogoDetector::ColorBlobs
+{
+    Blobs blobs;
+    Rects rects;
+    Points centers;
+    HuMomentsArray hu_moments;
+};
+
+/**
+ * @brief Indices of blobs passing filters of single logo part
+ */
+struct MultiLogoDetector::PartCandidates
+{
+    const ColorBlobs* color_blobs;
+    std::vector<std::size_t> indices;
+};
+
+MultiLogoDetector::Config MultiLogoDetector::Config::from_json(const nlohmann::json& json)
+{
+    auto config = Config();
+    for(const auto& color : json.at("colors").items())
+    {
+        config.colors.push_back(ColorClass{color.key(), parse_color_ranges(color.value())});
+    }
+
+    for(const auto& logo_json : json.at("logos"))
+    {
+        auto logo = LogoDefinition();
+        logo.name = logo_json.at("name").get<std::string>();
+        for(const auto& part_json : logo_json.at("parts"))
+        {
+            logo.parts.push_back(PartDefinition{
+                find_color(config.colors, part_json.at("color").get<std::string>()),
+                parse_range<BlobArea>(part_json.at("area_range")),
+                parse_range<HuMoment>(part_json.at("hu0_range")),
+                parse_range<HuMoment>(part_json.at("hu1_range")),
+                part_json.value("max_center_distance", 0.0)});
+        }
+
+        if(logo.parts.empty())
+        {
+            throw std::invalid_argument("Logo has no parts: " + logo.name);
+        }
+
+        config.logos.push_back(std::move(logo));
+    }
+
+    return config;
+}
+
+MultiLogoDetector::Config MultiLogoDetector::Config::from_pepsi(const PepsiDetector::Config& pepsi_config)
+{
+    // Red range always wraps around 180 in PepsiDetector
+    auto config = Config();
+    config.colors = {
+        ColorClass{"red", get_red_ranges(pepsi_config.red_range)},
+        ColorClass{"blue", ColorRanges{pepsi_config.blue_range}},
+    };
+
+    // Red part goes first, so logos are found in the same order as PepsiDetector matches them
+    config.logos = {
+        LogoDefinition{"pepsi", {
+            PartDefinition{0, pepsi_config.red_blob_area_range,
+                           pepsi_config.red_blob_hu0_range, pepsi_config.red_blob_hu1_range, 0.0},
+            PartDefinition{1, pepsi_config.blue_blob_area_range,
+                           pepsi_config.blue_blob_hu0_range, pepsi_config.blue_blob_hu1_range,
+                           pepsi_config.max_blobs_centers_distance},
+        }},
+    };
+
+    return config;
+}
+
+MultiLogoDetector::MultiLogoDetector(Config config)
+    :   m_config(std::move(config))
+    ,   m_colors_area_ranges(m_config.colors.size(), BlobAreaRange{std::numeric_limits<BlobArea>::max(),
+                                                                   std::numeric_limits<BlobArea>::min()})
+{
+    for(const auto& color : m_config.colors)
+    {
+        CV_Assert(!color.ranges.empty());
+    }
+
+    for(const auto& logo : m_config.logos)
+    {
+        CV_Assert(!logo.parts.empty());
+        for(const auto& part : logo.parts)
+        {
+            CV_Assert(part.color < m_config.colors.size());
+
+            auto& area_range = m_colors_area_ranges[part.color];
+            area_range.min = std::min(area_range.min, part.area_range.min);
+            area_range.max = std::max(area_range.max, part.area_range.max);
+        }
+    }
+
+    DETECTOR_LOG_DEBUG("[MultiLogoDetector] Initialized ({} colours, {} logos)",
+                       m_config.colors.size(), m_config.logos.size());
+}
+
+Logos MultiLogoDetector::find_logos(const cv::Mat& img) const
+{
+    const auto detections = find_detections(img);
+
+    auto logos = Logos();
+    logos.reserve(detections.size());
+    std::transform(detections.begin(), detections.end(),
+                   std::back_inserter(logos),
+                   [](const auto& detection) { return detection.logo; });
+
+    return logos;
+}
+
+/**
+ * @brief Finds logos of all definitions, in order of definitions
+ */
+MultiLogoDetector::Detections MultiLogoDetector::find_detections(const cv::Mat& img) const
+{
+    const auto span = trace::Span{"find_logos"};
+    DETECTOR_LOG_DEBUG("[MultiLogoDetector] Finding logos on image...");
+
+    const auto bgr = cv::Mat_<cv::Vec3b>{img};
+    auto enhanced = cv::Mat_<cv::Vec3b>{bgr.size()};
+    filter_image(bgr, enhanced, get_unsharp_mask_kernel());
+
+    auto hsv = cv::Mat_<cv::Vec3b>{bgr.size()};
+    bgr2hsv(enhanced, hsv);
+
+    // Blobs of each colour are found, when the first logo needs them
+    auto colors_blobs = std::vector<std::optional<ColorBlobs>>(m_config.colors.size());
+
+    auto detections = Detections();
+    for(auto logo_index = std::size_t{0}; logo_index < m_config.logos.size(); ++logo_index)
+    {
+        const auto& logo = m_config.logos[logo_index];
+
+        auto candidates = std::vector<PartCandidates>();
+        candidates.reserve(logo.parts.size());
+        for(const auto& part : logo.parts)
+        {
+            auto& color_blobs = colors_blobs[part.color];
+            if(!color_blobs)
+            {
+                color_blobs = find_color_blobs(part.color, hsv);
+            }
+
+            auto part_candidates = PartCandidates{&(*color_blobs), {}};
+            for(auto i = std::size_t{0}; i < color_blobs->blobs.size(); ++i)
+            {
+                const auto& hu = color_blobs->hu_moments[i];
+                if(is_in_range(static_cast<BlobArea>(color_blobs->blobs[i].size()), part.area_range)
+                    && is_in_range(hu[0], part.hu0_range) && is_in_range(hu[1], part.hu1_range))
+                {
+                    part_candidates.indices.push_back(i);
+                }
+            }
+
+            if(part_candidates.indices.empty())
+            {
+                // Logo requires all its parts, so colours of the rest are not needed for it
+                DETECTOR_LOG_DEBUG("[MultiLogoDetector] No candidates of {} part, skipping the rest", logo.name);
+                break;
+            }
+
+            candidates.push_back(std::move(part_candidates));
+        }
+
+        if(candidates.size() == logo.parts.size())
+        {
+            match_parts(logo_index, candidates, detections);
+        }
+    }
+
+    return detections;
+}
+
+const MultiLogoDetector::Config& MultiLogoDetector::config() const noexcept
+{
+    return m_config;
+}
+
+MultiLogoDetector::ColorBlobs MultiLogoDetector::find_color_blobs(std::size_t color, const cv::Mat_<cv::Vec3b>& hsv) const
+{
+    const auto& color_class = m_config.colors[color];
+    DETECTOR_LOG_DEBUG("[MultiLogoDetector] Finding {} blobs...", color_class.name);
+
+    auto mask = cv::Mat_<uchar>{hsv.size()};
+    auto tmp = cv::Mat_<uchar>{hsv.size()};
+    threshold(hsv, mask, color_class.ranges.front());
+    for(auto it = std::next(color_class.ranges.begin()); it != color_class.ranges.end(); ++it)
+    {
+        threshold(hsv, tmp, *it);
+        bitwise_or(mask, tmp, mask);
+    }
+
+    const cv::Mat_<uchar> kernel = cv::Mat_<uchar>::ones(cv::Size{3, 3});
+    erode(mask, tmp, kernel);
+    dilate(tmp, mask, kernel);
+
+    auto color_blobs = ColorBlobs();
+    color_blobs.blobs = find_blobs(mask);
+
+    // Blobs rejected by area of every part of that colour are dropped before their moments are calculated
+    const auto area_range = m_colors_area_ranges[color];
+    auto& blobs = color_blobs.blobs;
+    blobs.erase(std::remove_if(blobs.begin(), blobs.end(),
+                               [area_range](const auto& blob)
+                               {
+                                   return !is_in_range(static_cast<BlobArea>(blob.size()), area_range);
+                               }),
+                blobs.end());
+
+    color_blobs.rects = calc_bounding_rects(blobs);
+    color_blobs.centers.reserve(blobs.size());
+    std::transform(color_blobs.rects.begin(), color_blobs.rects.end(),
+                   std::back_inserter(color_blobs.centers),
+                   get_rect_center);
+    color_blobs.hu_moments = calc_blobs_hu_moments(blobs);
+
+    return color_blobs;
+}
+
+/**
+ * @brief Adds detections of all combinations of candidates, which parts are close enough to the first one
+ * Blob is never used as two parts of the same logo.
+ */
+void MultiLogoDetector::match_parts(std::size_t logo_index, const std::vector<PartCandidates>& candidates,
+                                    Detections& detections) const
+{
+    const auto& parts = m_config.logos[logo_index].parts;
+    auto chosen = std::vector<std::size_t>(candidates.size());
+
+    const auto add_detection =
+        [&]()
+        {
+            auto detection = Detection{logo_index, Logo{}, {}};
+            detection.parts.reserve(candidates.size());
+
+            auto top_left = Point{std::numeric_limits<int>::max(), std::numeric_limits<int>::max()};
+            auto bottom_right = Point{std::numeric_limits<int>::min(), std::numeric_limits<int>::min()};
+            for(auto part_idx = std::size_t{0}; part_idx < candidates.size(); ++part_idx)
+            {
+                const auto& color_blobs = *candidates[part_idx].color_blobs;
+                const auto blob_idx = chosen[part_idx];
+                const auto& rect = color_blobs.rects[blob_idx];
+
+                detection.parts.push_back(LogoPart{rect, static_cast<BlobArea>(color_blobs.blobs[blob_idx].size())});
+                top_left = Point{std::min(top_left.x, rect.x), std::min(top_left.y, rect.y)};
+                bottom_right = Point{std::max(bottom_right.x, rect.br().x), std::max(bottom_right.y, rect.br().y)};
+            }
+
+            detection.logo = Logo{top_left, bottom_right};
+            detections.push_back(std::move(detection));
+        };
+
+    const auto match_from =
+        [&](std::size_t part_idx, const auto& match_next) -> void
+        {
+            if(part_idx == candidates.size())
+            {
+                add_detection();
+                return;
+            }
+
+            const auto& part_candidates = candidates[part_idx];
+            for(const auto blob_idx : part_candidates.indices)
+            {
+                const auto center = part_candidates.color_blobs->centers[blob_idx];
+                if(part_idx > 0)
+                {
+                    const auto first_center = candidates.front().color_blobs->centers[chosen.front()];
+                    if(calc_points_distance(center, first_center) > parts[part_idx].max_center_distance)
+                    {
+                        continue;
+                    }
+                }
+
+                auto used = false;
+                for(auto other_idx = std::size_t{0}; other_idx < part_idx && !used; ++other_idx)
+                {
+                    used = (candidates[other_idx].color_blobs == part_candidates.color_blobs
+                        && chosen[other_idx] == blob_idx);
+                }
+
+                if(used)
+                {
+                    continue;
+                }
+
+                chosen[part_idx] = blob_idx;
+                match_next(part_idx + 1, match_next);
+            }
+        };
+
+    match_from(0, match_from);
+}
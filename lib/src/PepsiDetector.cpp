@@ -1,22 +1,28 @@
 #include "PepsiDetector.hpp"
 #include "PepsiDetectorImpl.hpp"
 
+#include <cmath>
 #include <cstdio>
 
 #include <algorithm>
 #include <chrono>
+#include <optional>
 
-#include <spdlog/spdlog.h>
 #include <spdlog/fmt/ostr.h>
 
 #include "blobs.hpp"
 #include "core.hpp"
 #include "drawing.hpp"
 #include "format.hpp"
+#include "frame.hpp"
 #include "imglog.hpp"
+#include "log.hpp"
 #include "moments.hpp"
 #include "utility.hpp"
 #include "morpho.hpp"
+#include "points.hpp"
+#include "StageTimer.hpp"
+#include "trace.hpp"
 
 namespace {
 
@@ -70,7 +76,7 @@ void log_blobs(const Blobs& blobs, const cv::Vec3b& color, cv::Size img_size, co
     {
         cv::Mat_<cv::Vec3b> img = cv::Mat_<cv::Vec3b>::zeros(img_size);
         draw_blobs(blobs, img, color);
-        imglog::log(img_name, img);
+        imglog::log(img_name, std::move(img));
     }
 }
 
@@ -80,7 +86,7 @@ void log_blobs_randomly(const Blobs& blobs, cv::Size img_size, const char* img_n
     {
         cv::Mat_<cv::Vec3b> img = cv::Mat_<cv::Vec3b>::zeros(img_size);
         draw_blobs_randomly(blobs, img);
-        imglog::log(img_name, img);
+        imglog::log(img_name, std::move(img));
     }
 }
 
@@ -117,7 +123,7 @@ BlobAnchors get_blob_anchors(const Blob& blob)
 
 BlobsAnchors get_blobs_anchors(const Blobs& blobs)
 {
-    spdlog::debug("[PepsiDetector] Getting blobs anchors...");
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Getting blobs anchors...");
 
     auto blobs_anchors = BlobsAnchors();
     blobs_anchors.reserve(blobs.size());
@@ -138,7 +144,7 @@ Point get_blob_center(const BlobAnchors& blob_anchors)
 
 Points get_blobs_centers(const BlobsAnchors& blobs_anchors)
 {
-    spdlog::debug("[PepsiDetector] Getting blobs centers from its anchors...");
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Getting blobs centers from its anchors...");
 
     auto blobs_centers = Points();
     blobs_centers.reserve(blobs_anchors.size());
@@ -150,115 +156,624 @@ Points get_blobs_centers(const BlobsAnchors& blobs_anchors)
     return blobs_centers;
 }
 
-double calc_points_distance(Point a, Point b) noexcept
+// Logos from different regions overlapping more than that are treated as duplicates
+constexpr auto MaxLogosOverlap = 0.5;
+
+struct RegionDetection
+{
+    Detection detection;
+    std::size_t region_idx;
+};
+
+using RegionsDetections = std::vector<RegionDetection>;
+
+/**
+ * @brief Removes logos found many times in overlapping regions
+ * Logo is removed, when it is mostly covered by bigger logo found in other region.
+ *  Bigger one is kept, as logos crossing region border are truncated.
+ */
+Detections suppress_duplicated_detections(RegionsDetections regions_detections)
+{
+    std::stable_sort(regions_detections.begin(), regions_detections.end(),
+                     [](const auto& a, const auto& b) { return (a.detection.logo.area() > b.detection.logo.area()); });
+
+    auto kept = RegionsDetections();
+    kept.reserve(regions_detections.size());
+    for(const auto& region_detection : regions_detections)
+    {
+        const auto& logo = region_detection.detection.logo;
+        const auto duplicated = std::any_of(kept.begin(), kept.end(),
+            [&region_detection, &logo](const auto& other)
+            {
+                const auto overlap = (logo & other.detection.logo).area();
+                return (other.region_idx != region_detection.region_idx
+                    && overlap > (MaxLogosOverlap * logo.area()));
+            });
+
+        if(!duplicated)
+        {
+            kept.push_back(region_detection);
+        }
+    }
+
+    auto detections = Detections();
+    detections.reserve(kept.size());
+    std::transform(kept.begin(), kept.end(),
+                   std::back_inserter(detections),
+                   [](const auto& region_detection) { return region_detection.detection; });
+
+    return detections;
+}
+
+void shift_detection(Detection& detection, Point offset) noexcept
+{
+    detection.logo += offset;
+    detection.blue.rect += offset;
+    detection.red.rect += offset;
+}
+
+LogoPart make_logo_part(const Blob& blob, const BlobAnchors& anchors)
+{
+    return LogoPart{Rect{anchors.top_left, anchors.bottom_right}, static_cast<BlobArea>(blob.size())};
+}
+
+// Smallest blob area, which still survives morphological filtering at coarse level
+constexpr auto MinCoarseBlobArea = 25;
+
+/**
+ * @brief Chooses downsampling factor for coarse detection
+ * It is the biggest one, for which smallest accepted blob is still resolvable.
+ */
+int calc_pyramid_factor(const PepsiDetector::Config& config) noexcept
+{
+    const auto min_blob_area = std::min(config.blue_blob_area_range.min,
+                                        config.red_blob_area_range.min);
+
+    for(const auto factor : {4, 2})
+    {
+        if(min_blob_area >= (MinCoarseBlobArea * factor * factor))
+        {
+            return factor;
+        }
+    }
+
+    return 1;
+}
+
+HuMomentRange widen_hu_moment_range(HuMomentRange range) noexcept
+{
+    const auto width = (range.max - range.min);
+    return {std::max(range.min - width, 0.0), (range.max + width)};
+}
+
+/**
+ * @brief Creates config for coarse detection level
+ * Filters are relaxed, as coarse level only has to find candidate regions,
+ *  and shapes of small blobs are distorted by downsampling.
+ */
+PepsiDetector::Config make_coarse_config(const PepsiDetector::Config& config, int factor)
+{
+    auto coarse_config = config.scaled(1.0 / factor);
+    coarse_config.pyramid = false;
+
+    coarse_config.blue_blob_area_range.min /= 2;
+    coarse_config.blue_blob_area_range.max *= 2;
+    coarse_config.blue_blob_hu0_range = widen_hu_moment_range(config.blue_blob_hu0_range);
+    coarse_config.blue_blob_hu1_range = widen_hu_moment_range(config.blue_blob_hu1_range);
+
+    coarse_config.red_blob_area_range.min /= 2;
+    coarse_config.red_blob_area_range.max *= 2;
+    coarse_config.red_blob_hu0_range = widen_hu_moment_range(config.red_blob_hu0_range);
+    coarse_config.red_blob_hu1_range = widen_hu_moment_range(config.red_blob_hu1_range);
+
+    coarse_config.max_blobs_centers_distance += 1.0;
+
+    return coarse_config;
+}
+
+/**
+ * @brief Returns margin around candidate region at full resolution
+ * It covers rounding of coarse coordinates, enhancement kernel border
+ *  and blob boundaries shifted by morphological filtering.
+ */
+int calc_candidate_margin(int factor) noexcept
+{
+    return ((4 * factor) + 8);
+}
+
+// Opening with 3x3 kernels makes each pixel depend on its 5x5 neighbourhood
+constexpr auto MorphologyGuard = 2;
+
+// Whole frame is processed, when windows would cover more than that part of it
+constexpr auto MaxPartWindowsCoverage = 0.5;
+
+// Grid step of precheck in estimate mode, each sampled pixel stands for step x step block
+constexpr auto EstimatePrecheckStep = 8;
+
+// Grid step of precheck in guarantee mode. Every 3x3 block (2x2 at image border) left set by
+//  opening contains a sampled pixel, so each set pixel lies within 5x5 block around sampled one.
+constexpr auto GuaranteePrecheckStep = 3;
+constexpr auto GuaranteePrecheckReach = 25;
+
+std::size_t calc_rects_area(const Rects& rects) noexcept
 {
-    const auto dx = (b.x - a.x);
-    const auto dy = (b.y - a.y);
-    return std::sqrt(dx*dx + dy*dy);
+    auto area = std::size_t{0};
+    for(const auto& rect : rects)
+    {
+        area += static_cast<std::size_t>(rect.area());
+    }
+
+    return area;
+}
+
+/**
+ * @brief Checks, if blob found in window reaches its border, which is not the border of the image
+ * Such blob may continue outside the window, so its shape is not known.
+ */
+bool blob_crosses_window(const Blob& blob, Rect window, cv::Size bounds) noexcept
+{
+    const auto left = (window.x > 0);
+    const auto top = (window.y > 0);
+    const auto right = (window.x + window.width < bounds.width);
+    const auto bottom = (window.y + window.height < bounds.height);
+
+    return std::any_of(blob.begin(), blob.end(),
+        [&window, left, top, right, bottom](const auto point)
+        {
+            return ((left && point.x == 0) || (top && point.y == 0)
+                || (right && point.x == window.width - 1) || (bottom && point.y == window.height - 1));
+        });
+}
+
+/**
+ * @brief Orders blobs as they are found on the whole image, by their first points in raster order
+ */
+void sort_blobs_in_raster_order(Blobs& blobs)
+{
+    std::sort(blobs.begin(), blobs.end(),
+              [](const auto& a, const auto& b)
+              {
+                  const auto pa = a.front();
+                  const auto pb = b.front();
+                  return (pa.y < pb.y || (pa.y == pb.y && pa.x < pb.x));
+              });
+}
+
+/**
+ * @brief Checks, if logo part found in candidate region reaches its border, which is not the border of the image
+ * Such part may be truncated blob of other logo, which passes filters only in its truncated shape.
+ *  Part rectangle ends at the last point of the blob.
+ */
+bool part_crosses_region(const LogoPart& part, Rect region, cv::Size bounds) noexcept
+{
+    return ((region.x > 0 && part.rect.x == 0)
+        || (region.y > 0 && part.rect.y == 0)
+        || (region.x + region.width < bounds.width && part.rect.br().x == region.width - 1)
+        || (region.y + region.height < bounds.height && part.rect.br().y == region.height - 1));
 }
 
 } //
 
+Logos to_logos(const Detections& detections)
+{
+    auto logos = Logos();
+    logos.reserve(detections.size());
+    std::transform(detections.begin(), detections.end(),
+                   std::back_inserter(logos),
+                   [](const auto& detection) { return detection.logo; });
+
+    return logos;
+}
+
 // PepsiDetector implementation
 
 PepsiDetector::Impl::Impl(const Config& config)
     :   m_config(config)
+    ,   m_pyramid_factor{config.pyramid ? calc_pyramid_factor(config) : 1}
+{
+    if(m_pyramid_factor > 1)
+    {
+        const auto coarse_config = make_coarse_config(config, m_pyramid_factor);
+        m_coarse_impl = std::make_shared<const Impl>(coarse_config);
+    }
+
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Initialized (pyramid factor: {})", m_pyramid_factor);
+}
+
+Detections PepsiDetector::Impl::find_detections(const cv::Mat& bgr, DetectionStats* stats) const
 {
-    spdlog::debug("[PepsiDetector] Initialized");
+    const auto span = trace::Span{"find_logos"};
+
+    if(m_coarse_impl)
+    {
+        return find_detections_coarse_to_fine(bgr, stats);
+    }
+
+    return find_detections_full(bgr, stats);
 }
 
-Logos PepsiDetector::Impl::find_logos(const cv::Mat& bgr) const
+Detections PepsiDetector::Impl::find_detections(const cv::Mat& bgr, const Rects& rois, DetectionStats* stats) const
 {
-    spdlog::debug("[PepsiDetector] Finding logos on image...");
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Finding logos in {} regions...", rois.size());
+
+    const auto img_rect = Rect{0, 0, bgr.cols, bgr.rows};
+
+    auto regions_detections = RegionsDetections();
+    for(auto roi_idx = std::size_t{0}; roi_idx < rois.size(); ++roi_idx)
+    {
+        const auto roi = (rois[roi_idx] & img_rect);
+        if(roi.empty())
+        {
+            continue;
+        }
+
+        // Region is processed in place, as a view of the whole image
+        for(auto detection : find_detections(bgr(roi), stats))
+        {
+            shift_detection(detection, roi.tl());
+            regions_detections.push_back(RegionDetection{detection, roi_idx});
+        }
+    }
+
+    return suppress_duplicated_detections(std::move(regions_detections));
+}
+
+const PepsiDetector::Config& PepsiDetector::Impl::config() const noexcept
+{
+    return m_config;
+}
+
+Detections PepsiDetector::Impl::find_detections_coarse_to_fine(const cv::Mat& bgr, DetectionStats* stats) const
+{
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Finding logos from coarse to fine...");
+
+    auto detections = Detections();
+    for(const auto& region : find_candidate_regions(bgr, stats))
+    {
+        for(auto detection : find_detections_full(bgr(region), stats))
+        {
+            // Logos found at coarse level lie inside the margin, so parts at region border belong to others
+            if(part_crosses_region(detection.blue, region, bgr.size())
+                || part_crosses_region(detection.red, region, bgr.size()))
+            {
+                continue;
+            }
+
+            shift_detection(detection, region.tl());
+            detections.push_back(detection);
+        }
+    }
+
+    return detections;
+}
+
+Rects PepsiDetector::Impl::find_candidate_regions(const cv::Mat& bgr, DetectionStats* stats) const
+{
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Finding candidate regions at coarse level...");
+
+    // Coarse pass gets its own stats, so its stages and blobs are not mixed with the ones of fine pass
+    auto coarse_stats = DetectionStats();
+    const auto coarse_stats_ptr = (stats ? &coarse_stats : nullptr);
+
+    const auto factor = m_pyramid_factor;
+    auto coarse = cv::Mat_<cv::Vec3b>{bgr.rows / factor, bgr.cols / factor};
+    {
+        const auto timer = StageTimer{coarse_stats_ptr, Stage::Enhance};
+        downsample(bgr, coarse, factor);
+    }
+
+    const auto coarse_detections = m_coarse_impl->find_detections_full(coarse, coarse_stats_ptr);
+    const auto margin = calc_candidate_margin(factor);
+
+    auto regions = Rects();
+    regions.reserve(coarse_detections.size());
+    for(const auto& coarse_detection : coarse_detections)
+    {
+        regions.push_back(expand_rect(scale_rect(coarse_detection.logo, factor), margin, bgr.size()));
+    }
+
+    regions = merge_overlapping_rects(std::move(regions));
+    if(stats)
+    {
+        ++stats->coarse.runs;
+        stats->coarse.regions += regions.size();
+        for(const auto time : coarse_stats.stages_times)
+        {
+            stats->coarse.time += time;
+        }
+    }
+
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Found {} candidate regions", regions.size());
+    return regions;
+}
+
+Detections PepsiDetector::Impl::find_detections_full(const cv::Mat& bgr, DetectionStats* stats) const
+{
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Finding logos on image...");
     imglog::log("Original", bgr);
 
-    const auto enhanced = enhance_image(bgr);
-    const auto hsv = convert_image(enhanced);
-    const auto blue_blobs = detect_blue_blobs(hsv);
-    const auto red_blobs = detect_red_blobs(hsv);
-    return match_blobs(red_blobs, blue_blobs);
+    if(m_config.precheck != PrecheckMode::Off && !colors_present(bgr, stats))
+    {
+        DETECTOR_LOG_DEBUG("[PepsiDetector] Not enough blue or red pixels, skipping image");
+        return Detections();
+    }
+
+    const auto enhanced = enhance_image(bgr, stats);
+    const auto hsv = convert_image(enhanced, stats);
+
+    auto blue_blobs = Blobs();
+    auto red_blobs = Blobs();
+    const auto order = m_cascade.choose();
+    for(const auto branch : order)
+    {
+        auto& blobs = (branch == CascadeBranch::Blue) ? blue_blobs : red_blobs;
+        const auto& other_blobs = (branch == CascadeBranch::Blue) ? red_blobs : blue_blobs;
+        blobs = detect_branch_blobs(branch, (branch == order.front()), other_blobs, hsv, stats);
+        if(blobs.empty())
+        {
+            // Logo requires both parts, so the rest of the cascade would find nothing
+            DETECTOR_LOG_DEBUG("[PepsiDetector] No {} candidates, skipping the rest",
+                               (branch == CascadeBranch::Blue) ? "blue" : "red");
+            if(stats)
+            {
+                ++((branch == CascadeBranch::Blue) ? stats->cascade_exits.after_blue : stats->cascade_exits.after_red);
+            }
+
+            return Detections();
+        }
+    }
+
+    return match_blobs(red_blobs, blue_blobs, stats);
 }
 
-cv::Mat_<cv::Vec3b> PepsiDetector::Impl::enhance_image(const cv::Mat_<cv::Vec3b>& bgr) const
+Blobs PepsiDetector::Impl::detect_branch_blobs(CascadeBranch branch, bool first, const Blobs& other_blobs,
+                                               const cv::Mat_<cv::Vec3b>& hsv, DetectionStats* stats) const
 {
-    spdlog::debug("Enhancing image...");
+    const auto start = CascadeOrder::Clock::now();
+    auto blobs = Blobs();
+    if(first || !m_config.part_windows)
+    {
+        blobs = (branch == CascadeBranch::Blue)
+            ? detect_blue_blobs(hsv, stats)
+            : detect_red_blobs(hsv, stats);
+    }
+    else
+    {
+        blobs = detect_branch_blobs_near(branch, other_blobs, hsv, stats);
+    }
+    m_cascade.record(branch, first, blobs.empty(), CascadeOrder::Clock::now() - start);
 
-    // Unsharp mask kernel 5x5, based on Gaussian blur with amount as 1 and threshold as 0
-    float kernel_data[] = {
-        -1.0/256,  -4.0/256,   -6.0/256,  -4.0/256, -1.0/256,
-        -4.0/256, -16.0/256,  -24.0/256, -16.0/256, -4.0/256,
-        -6.0/256, -24.0/256,  476.0/256, -24.0/256, -6.0/256,
-        -4.0/256, -16.0/256,  -24.0/256, -16.0/256, -4.0/256,
-        -1.0/256,  -4.0/256,   -6.0/256,  -4.0/256, -1.0/256,
-    };
+    return blobs;
+}
 
-    auto kernel = cv::Mat(5, 5, CV_32F, kernel_data);
-    auto enhanced = cv::Mat_<cv::Vec3b>{bgr.size()};
+/**
+ * @brief Detects blobs of the second colour part only in windows around candidates of the first one
+ * Results are the same as on the whole image. Masks are made with guard band, so opening inside
+ *  windows is exact, and blobs reaching window border are looked for on the whole image again.
+ */
+Blobs PepsiDetector::Impl::detect_branch_blobs_near(CascadeBranch branch, const Blobs& other_blobs,
+                                                    const cv::Mat_<cv::Vec3b>& hsv, DetectionStats* stats) const
+{
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Detecting {} blobs near {} candidates...",
+                       (branch == CascadeBranch::Blue) ? "blue" : "red", other_blobs.size());
+
+    const auto windows = make_part_windows(branch, other_blobs, hsv.size());
+    const auto pixels = calc_rects_area(windows);
+    const auto frame_pixels = static_cast<std::size_t>(hsv.rows) * static_cast<std::size_t>(hsv.cols);
+
+    auto blobs = (pixels <= MaxPartWindowsCoverage * frame_pixels)
+        ? find_branch_blobs_in_windows(branch, windows, hsv, stats)
+        : std::nullopt;
+
+    if(stats)
+    {
+        ++stats->part_windows.runs;
+        stats->part_windows.frame_pixels += frame_pixels;
+        stats->part_windows.windows += (blobs ? windows.size() : 0);
+        stats->part_windows.pixels += (blobs ? pixels : frame_pixels);
+        stats->part_windows.fallbacks += (blobs ? 0 : 1);
+    }
+
+    if(!blobs)
+    {
+        DETECTOR_LOG_DEBUG("[PepsiDetector] Falling back to the whole image");
+        return (branch == CascadeBranch::Blue)
+            ? detect_blue_blobs(hsv, stats)
+            : detect_red_blobs(hsv, stats);
+    }
+
+    if(branch == CascadeBranch::Blue)
+    {
+        filter_blue_blobs(*blobs, stats);
+        log_blobs(*blobs, cv::Vec3b{255, 0, 0}, hsv.size(), "Blue blobs final");
+    }
+    else
+    {
+        filter_red_blobs(*blobs, stats);
+        log_blobs(*blobs, cv::Vec3b{0, 0, 255}, hsv.size(), "Red blobs final");
+    }
+
+    return std::move(*blobs);
+}
+
+/**
+ * @brief Returns merged windows, in which blobs matching candidates of the other colour part may lie
+ * Centre of matching blob is not further than max blobs centers distance from candidate centre,
+ *  and the blob extends around its centre by about square root of its maximal area.
+ */
+Rects PepsiDetector::Impl::make_part_windows(CascadeBranch branch, const Blobs& other_blobs, cv::Size size) const
+{
+    const auto& area_range = (branch == CascadeBranch::Blue)
+        ? m_config.blue_blob_area_range
+        : m_config.red_blob_area_range;
+    const auto margin = static_cast<int>(std::ceil(m_config.max_blobs_centers_distance
+                                                   + std::sqrt(static_cast<double>(area_range.max))));
+
+    auto windows = Rects();
+    windows.reserve(other_blobs.size());
+    for(const auto& anchors : get_blobs_anchors(other_blobs))
+    {
+        const auto center = get_blob_center(anchors);
+        windows.push_back(expand_rect(Rect{center.x, center.y, 1, 1}, margin, size));
+    }
+
+    return merge_overlapping_rects(std::move(windows));
+}
+
+/**
+ * @brief Finds blobs in each window, in whole image coordinates and order
+ * Returns nothing, if some blob not rejected by its area reaches window border.
+ */
+std::optional<Blobs> PepsiDetector::Impl::find_branch_blobs_in_windows(CascadeBranch branch, const Rects& windows,
+                                                                       const cv::Mat_<cv::Vec3b>& hsv,
+                                                                       DetectionStats* stats) const
+{
+    const auto max_area = static_cast<std::size_t>((branch == CascadeBranch::Blue)
+        ? m_config.blue_blob_area_range.max
+        : m_config.red_blob_area_range.max);
+
+    auto blobs = Blobs();
+    for(const auto& window : windows)
+    {
+        const auto guarded = expand_rect(window, MorphologyGuard, hsv.size());
+        const auto guarded_hsv = hsv(guarded);
+        auto guarded_mask = (branch == CascadeBranch::Blue)
+            ? extract_blue_color(guarded_hsv, stats)
+            : extract_red_color(guarded_hsv, stats);
+
+        auto mask = cv::Mat_<uchar>{guarded_mask(window - guarded.tl())};
+        auto window_blobs = (branch == CascadeBranch::Blue)
+            ? find_blue_blobs(mask, stats)
+            : find_red_blobs(mask, stats);
+
+        for(auto& blob : window_blobs)
+        {
+            // Whole blob would be rejected by area anyway, as it is not smaller than its part
+            if(blob.size() <= max_area && blob_crosses_window(blob, window, hsv.size()))
+            {
+                return std::nullopt;
+            }
+
+            shift_points(blob, -window.tl());
+            blobs.push_back(std::move(blob));
+        }
+    }
+
+    sort_blobs_in_raster_order(blobs);
+    return blobs;
+}
+
+/**
+ * @brief Checks on sparse grid of pixels, if there may be enough blue and red ones for logo parts
+ * In guarantee mode, pixels are enhanced before classification, so they are the same as
+ *  thresholded later. Image is rejected when either blue or red part can not reach its minimal area,
+ *  as logo needs both of them.
+ */
+bool PepsiDetector::Impl::colors_present(const cv::Mat_<cv::Vec3b>& bgr, DetectionStats* stats) const
+{
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Checking presence of colors...");
+
+    const auto guarantee = (m_config.precheck == PrecheckMode::Guarantee);
+    const auto step = guarantee ? GuaranteePrecheckStep : EstimatePrecheckStep;
+    const auto pixels_per_sample = static_cast<std::size_t>(guarantee ? GuaranteePrecheckReach : (step * step));
+
+    const auto counts = [&]() {
+        const auto timer = StageTimer{stats, Stage::Threshold};
+        return count_grid_colors(bgr, step, guarantee ? &get_unsharp_mask_kernel() : nullptr,
+                                 {ColorRanges{m_config.blue_range}, get_red_ranges(m_config.red_range)});
+    }();
+
+    const auto present =
+        [pixels_per_sample](std::size_t count, BlobAreaRange area_range)
+        {
+            return ((count * pixels_per_sample) >= static_cast<std::size_t>(std::max(area_range.min, 0)));
+        };
 
-    filter_image(bgr, enhanced, kernel);
+    const auto result = (present(counts[0], m_config.blue_blob_area_range)
+        && present(counts[1], m_config.red_blob_area_range));
+
+    DETECTOR_LOG_DEBUG("[PepsiDetector] {} blue and {} red samples", counts[0], counts[1]);
+    if(stats)
+    {
+        ++stats->precheck.runs;
+        stats->precheck.rejections += (result ? 0 : 1);
+    }
+
+    return result;
+}
+
+cv::Mat_<cv::Vec3b> PepsiDetector::Impl::enhance_image(const cv::Mat_<cv::Vec3b>& bgr, DetectionStats* stats) const
+{
+    DETECTOR_LOG_DEBUG("Enhancing image...");
+    const auto timer = StageTimer{stats, Stage::Enhance};
+
+    auto enhanced = cv::Mat_<cv::Vec3b>{bgr.size()};
+    filter_image(bgr, enhanced, get_unsharp_mask_kernel());
     imglog::log("Image enhanced", enhanced);
 
     return enhanced;
 }
 
-cv::Mat_<cv::Vec3b> PepsiDetector::Impl::convert_image(const cv::Mat_<cv::Vec3b>& bgr) const
+cv::Mat_<cv::Vec3b> PepsiDetector::Impl::convert_image(const cv::Mat_<cv::Vec3b>& bgr, DetectionStats* stats) const
 {
-    spdlog::debug("[PepsiDetector] Converting image to HSV...");
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Converting image to HSV...");
+    const auto timer = StageTimer{stats, Stage::Convert};
 
     auto hsv = cv::Mat_<cv::Vec3b>{bgr.size()};
     bgr2hsv(bgr, hsv);
     return hsv;
 }
 
-Blobs PepsiDetector::Impl::detect_blue_blobs(const cv::Mat_<cv::Vec3b>& hsv) const
+Blobs PepsiDetector::Impl::detect_blue_blobs(const cv::Mat_<cv::Vec3b>& hsv, DetectionStats* stats) const
 {
-    spdlog::debug("[PepsiDetector] Detecting blue blobs on image...");
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Detecting blue blobs on image...");
 
-    auto blue_color_mask = extract_blue_color(hsv);
-    auto blue_blobs = find_blue_blobs(blue_color_mask);
-    filter_blue_blobs(blue_blobs);
+    auto blue_color_mask = extract_blue_color(hsv, stats);
+    auto blue_blobs = find_blue_blobs(blue_color_mask, stats);
+    filter_blue_blobs(blue_blobs, stats);
     log_blobs(blue_blobs, cv::Vec3b{255, 0, 0}, hsv.size(), "Blue blobs final");
 
     return blue_blobs;
 }
 
-Blobs PepsiDetector::Impl::detect_red_blobs(const cv::Mat_<cv::Vec3b>& hsv) const
+Blobs PepsiDetector::Impl::detect_red_blobs(const cv::Mat_<cv::Vec3b>& hsv, DetectionStats* stats) const
 {
-    spdlog::debug("[PepsiDetector] Detecting red blobs on image...");
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Detecting red blobs on image...");
 
-    auto red_color_mask = extract_red_color(hsv);
-    auto red_blobs = find_red_blobs(red_color_mask);
-    filter_red_blobs(red_blobs);
+    auto red_color_mask = extract_red_color(hsv, stats);
+    auto red_blobs = find_red_blobs(red_color_mask, stats);
+    filter_red_blobs(red_blobs, stats);
     log_blobs(red_blobs, cv::Vec3b{0, 0, 255}, hsv.size(), "Red blobs final");
 
     return red_blobs;
 }
 
-cv::Mat_<uchar> PepsiDetector::Impl::extract_blue_color(const cv::Mat_<cv::Vec3b>& hsv) const
+cv::Mat_<uchar> PepsiDetector::Impl::extract_blue_color(const cv::Mat_<cv::Vec3b>& hsv, DetectionStats* stats) const
 {
-    spdlog::debug("[PepsiDetector] Extracting blue color...");
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Extracting blue color...");
 
-    auto blue_mask = threshold_blue_color(hsv);
-    filter_color_mask(blue_mask);
+    auto blue_mask = threshold_blue_color(hsv, stats);
+    filter_color_mask(blue_mask, stats);
     imglog::log("Blue color mask filtered", blue_mask);
 
     return blue_mask;
 }
 
-cv::Mat_<uchar> PepsiDetector::Impl::extract_red_color(const cv::Mat_<cv::Vec3b>& hsv) const
+cv::Mat_<uchar> PepsiDetector::Impl::extract_red_color(const cv::Mat_<cv::Vec3b>& hsv, DetectionStats* stats) const
 {
-    spdlog::debug("[PepsiDetector] Extracting red color...");
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Extracting red color...");
 
-    auto red_mask = threshold_red_color(hsv);
-    filter_color_mask(red_mask);
+    auto red_mask = threshold_red_color(hsv, stats);
+    filter_color_mask(red_mask, stats);
     imglog::log("Red color mask filtered", red_mask);
 
     return red_mask;
 }
 
-cv::Mat_<uchar> PepsiDetector::Impl::threshold_blue_color(const cv::Mat_<cv::Vec3b>& hsv) const
+cv::Mat_<uchar> PepsiDetector::Impl::threshold_blue_color(const cv::Mat_<cv::Vec3b>& hsv, DetectionStats* stats) const
 {
-    spdlog::debug("[PepsiDetector] Thresholding blue color...");
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Thresholding blue color...");
+    const auto timer = StageTimer{stats, Stage::Threshold};
 
     auto blue_mask = cv::Mat_<uchar>{hsv.size()};
     threshold(hsv, blue_mask, m_config.blue_range);
@@ -267,20 +782,19 @@ cv::Mat_<uchar> PepsiDetector::Impl::threshold_blue_color(const cv::Mat_<cv::Vec
     return blue_mask;
 }
 
-cv::Mat_<uchar> PepsiDetector::Impl::threshold_red_color(const cv::Mat_<cv::Vec3b>& hsv) const
+cv::Mat_<uchar> PepsiDetector::Impl::threshold_red_color(const cv::Mat_<cv::Vec3b>& hsv, DetectionStats* stats) const
 {
-    spdlog::debug("[PepsiDetector] Thresholding red color...");
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Thresholding red color...");
+    const auto timer = StageTimer{stats, Stage::Threshold};
+
+    const auto red_ranges = get_red_ranges(m_config.red_range);
 
     auto left_red_mask = cv::Mat_<uchar>{hsv.size()};
-    auto left_red_range = m_config.red_range;
-    left_red_range.min[0] = 0;
-    threshold(hsv, left_red_mask, left_red_range);
+    threshold(hsv, left_red_mask, red_ranges[0]);
     imglog::log("Left red color mask", left_red_mask);
 
     auto right_red_mask = cv::Mat_<uchar>{hsv.size()};
-    auto right_red_range = m_config.red_range;
-    right_red_range.max[0] = 180;
-    threshold(hsv, right_red_mask, right_red_range);
+    threshold(hsv, right_red_mask, red_ranges[1]);
     imglog::log("Right red color mask", right_red_mask);
 
     auto red_mask = cv::Mat_<uchar>{hsv.size()};
@@ -290,52 +804,92 @@ cv::Mat_<uchar> PepsiDetector::Impl::threshold_red_color(const cv::Mat_<cv::Vec3
     return red_mask;
 }
 
-Blobs PepsiDetector::Impl::find_blue_blobs(cv::Mat_<uchar>& blue_color_mask) const
+Blobs PepsiDetector::Impl::find_blue_blobs(cv::Mat_<uchar>& blue_color_mask, DetectionStats* stats) const
 {
-    spdlog::debug("[PepsiDetector] Finding blue blobs...");
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Finding blue blobs...");
+
+    auto blue_blobs = [&blue_color_mask, stats]() {
+        const auto timer = StageTimer{stats, Stage::Labelling};
+        return find_blobs(blue_color_mask);
+    }();
+
+    if(stats)
+    {
+        stats->blue_blobs.found += blue_blobs.size();
+    }
 
-    auto blue_blobs = find_blobs(blue_color_mask);
     log_blobs_randomly(blue_blobs, blue_color_mask.size(), "Blue blobs");
 
     return blue_blobs;
 }
 
-Blobs PepsiDetector::Impl::find_red_blobs(cv::Mat_<uchar>& red_color_mask) const
+Blobs PepsiDetector::Impl::find_red_blobs(cv::Mat_<uchar>& red_color_mask, DetectionStats* stats) const
 {
-    spdlog::debug("[PepsiDetector] Finding red blobs...");
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Finding red blobs...");
+
+    auto red_blobs = [&red_color_mask, stats]() {
+        const auto timer = StageTimer{stats, Stage::Labelling};
+        return find_blobs(red_color_mask);
+    }();
+
+    if(stats)
+    {
+        stats->red_blobs.found += red_blobs.size();
+    }
 
-    auto red_blobs = find_blobs(red_color_mask);
     log_blobs_randomly(red_blobs, red_color_mask.size(), "Red blobs");
 
     return red_blobs;
 }
 
-void PepsiDetector::Impl::filter_red_blobs(Blobs& blobs) const
+void PepsiDetector::Impl::filter_red_blobs(Blobs& blobs, DetectionStats* stats) const
 {
-    spdlog::debug("[PepsiDetector] Filtering red blobs...");
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Filtering red blobs...");
+    const auto timer = StageTimer{stats, Stage::Moments};
 
     filter_blobs_by_area(blobs, m_config.red_blob_area_range);
+    if(stats)
+    {
+        stats->red_blobs.after_area_filter += blobs.size();
+    }
+
     const auto blobs_hu_moments = calc_blobs_hu_moments(blobs);
-    spdlog::debug("[PepsiDetector] Red blobs after by area filtering:\n{}", blobs_hu_moments);
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Red blobs after by area filtering:\n{}", blobs_hu_moments);
 
     filter_blobs_by_hu_moments(blobs, blobs_hu_moments,
                                m_config.red_blob_hu0_range,
                                m_config.red_blob_hu1_range);
-    spdlog::debug("[PepsiDetector] Red blobs after by hu filtering:\n{}", calc_blobs_hu_moments(blobs));
+    if(stats)
+    {
+        stats->red_blobs.after_hu_filter += blobs.size();
+    }
+
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Red blobs after by hu filtering:\n{}", calc_blobs_hu_moments(blobs));
 }
 
-void PepsiDetector::Impl::filter_blue_blobs(Blobs& blobs) const
+void PepsiDetector::Impl::filter_blue_blobs(Blobs& blobs, DetectionStats* stats) const
 {
-    spdlog::debug("[PepsiDetector] Filtering blue blobs...");
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Filtering blue blobs...");
+    const auto timer = StageTimer{stats, Stage::Moments};
 
     filter_blobs_by_area(blobs, m_config.blue_blob_area_range);
+    if(stats)
+    {
+        stats->blue_blobs.after_area_filter += blobs.size();
+    }
+
     auto blobs_hu_moments = calc_blobs_hu_moments(blobs);
-    spdlog::debug("[PepsiDetector] Blue blobs after by area filtering:\n{}", blobs_hu_moments);
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Blue blobs after by area filtering:\n{}", blobs_hu_moments);
 
     filter_blobs_by_hu_moments(blobs, blobs_hu_moments,
                                m_config.blue_blob_hu0_range,
                                m_config.blue_blob_hu1_range);
-    spdlog::debug("[PepsiDetector] Blue blobs after by hu filtering:\n{}", calc_blobs_hu_moments(blobs));
+    if(stats)
+    {
+        stats->blue_blobs.after_hu_filter += blobs.size();
+    }
+
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Blue blobs after by hu filtering:\n{}", calc_blobs_hu_moments(blobs));
 }
 
 bool PepsiDetector::Impl::blobs_centers_matching(Point red_center, Point blue_center) const
@@ -350,9 +904,14 @@ bool PepsiDetector::Impl::blobs_centers_matching(Point red_center, Point blue_ce
     return false;
 }
 
-Logos PepsiDetector::Impl::match_blobs(const Blobs& red_blobs, const Blobs& blue_blobs) const
+Detections PepsiDetector::Impl::match_blobs(const Blobs& red_blobs, const Blobs& blue_blobs, DetectionStats* stats) const
 {
-    spdlog::debug("[PepsiDetector] Matching blobs...");
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Matching blobs...");
+    const auto timer = StageTimer{stats, Stage::Matching};
+    if(stats)
+    {
+        stats->pairs_tested += (red_blobs.size() * blue_blobs.size());
+    }
 
     const auto red_blobs_anchors = get_blobs_anchors(red_blobs);
     const auto red_blobs_centers = get_blobs_centers(red_blobs_anchors);
@@ -360,12 +919,12 @@ Logos PepsiDetector::Impl::match_blobs(const Blobs& red_blobs, const Blobs& blue
     const auto blue_blobs_anchors = get_blobs_anchors(blue_blobs);
     const auto blue_blobs_centers = get_blobs_centers(blue_blobs_anchors);
 
-    spdlog::debug("[PepsiDetector] Red centers: {}", red_blobs_centers);
-    spdlog::debug("[PepsiDetector] Blue centers: {}", blue_blobs_centers);
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Red centers: {}", red_blobs_centers);
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Blue centers: {}", blue_blobs_centers);
 
-    Logos logos;
-    const auto logos_max = std::min(red_blobs.size(), blue_blobs.size());
-    logos.reserve(logos_max);
+    Detections detections;
+    const auto detections_max = std::min(red_blobs.size(), blue_blobs.size());
+    detections.reserve(detections_max);
 
     const auto red_blobs_size = red_blobs.size();
     const auto blue_blobs_size = blue_blobs.size();
@@ -386,18 +945,23 @@ Logos PepsiDetector::Impl::match_blobs(const Blobs& red_blobs, const Blobs& blue
                 const auto bottom_right_x = std::max(red_anchors.bottom_right.x, blue_anchors.bottom_right.x);
                 const auto bottom_right_y = std::max(red_anchors.bottom_right.y, blue_anchors.bottom_right.y);
 
-                logos.emplace_back(Point{top_left_x, top_left_y}, Point{bottom_right_x, bottom_right_y});
+                detections.push_back(Detection{
+                    Logo{Point{top_left_x, top_left_y}, Point{bottom_right_x, bottom_right_y}},
+                    make_logo_part(blue_blobs[blue_idx], blue_anchors),
+                    make_logo_part(red_blobs[red_idx], red_anchors)
+                });
             }
         }
     }
 
-    logos.shrink_to_fit();
-    return logos;
+    detections.shrink_to_fit();
+    return detections;
 }
 
-void PepsiDetector::Impl::filter_color_mask(cv::Mat_<uchar>& color_mask) const
+void PepsiDetector::Impl::filter_color_mask(cv::Mat_<uchar>& color_mask, DetectionStats* stats) const
 {
-    spdlog::debug("[PepsiDetector] Filtering color mask...");
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Filtering color mask...");
+    const auto timer = StageTimer{stats, Stage::Morphology};
 
     const cv::Mat_<uchar> kernel = cv::Mat_<uchar>::ones(cv::Size{3, 3});
     auto tmp = cv::Mat_<uchar>(color_mask.size());
@@ -408,7 +972,7 @@ void PepsiDetector::Impl::filter_color_mask(cv::Mat_<uchar>& color_mask) const
 
 Blobs::iterator PepsiDetector::Impl::filter_blobs_by_area(Blobs& blobs, BlobAreaRange blob_area_range) const
 {
-    spdlog::debug("[PepsiDetector] Filtering blobs by area...");
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Filtering blobs by area...");
 
     auto is_wrong_area =
         [&blob_area_range](const auto& blob)
@@ -420,10 +984,10 @@ Blobs::iterator PepsiDetector::Impl::filter_blobs_by_area(Blobs& blobs, BlobArea
     return blobs.erase(std::remove_if(blobs.begin(), blobs.end(), is_wrong_area), blobs.end());
 }
 
-Blobs::iterator PepsiDetector::Impl::filter_blobs_by_hu_moments(Blobs& blobs, HuMomentsArray hu_moments_array,
+Blobs::iterator PepsiDetector::Impl::filter_blobs_by_hu_moments(Blobs& blobs, const HuMomentsArray& hu_moments_array,
                                                                 HuMomentRange hu0_range, HuMomentRange hu1_range) const
 {
-    spdlog::debug("[PepsiDetector] Filtering blobs by hu_moments...");
+    DETECTOR_LOG_DEBUG("[PepsiDetector] Filtering blobs by hu_moments...");
 
     auto hu_it = hu_moments_array.begin();
     const auto hu_not_match =
@@ -467,5 +1031,65 @@ PepsiDetector& PepsiDetector::operator=(const PepsiDetector &other)
 
 Logos PepsiDetector::find_logos(const cv::Mat& img) const
 {
-    return m_impl->find_logos(img);
+    return to_logos(m_impl->find_detections(img, nullptr));
+}
+
+/**
+ * @brief Finds logos on image and fills statistics of that call (see find_detections)
+ */
+Logos PepsiDetector::find_logos(const cv::Mat& img, DetectionStats& stats) const
+{
+    return to_logos(find_detections(img, stats));
+}
+
+/**
+ * @brief Finds logos only inside given regions of interest
+ * Regions are processed in place, without copying. Returned logos are
+ *  in whole image coordinates, with duplicates from overlapping regions removed.
+ */
+Logos PepsiDetector::find_logos(const cv::Mat& img, const Rects& rois) const
+{
+    return to_logos(m_impl->find_detections(img, rois, nullptr));
+}
+
+/**
+ * @brief Finds logos in caller-owned BGR buffer, without copying it
+ * Rows may be padded, as long as stride is given in bytes.
+ */
+Logos PepsiDetector::find_logos(const uchar* bgr, cv::Size size, std::size_t stride) const
+{
+    return to_logos(m_impl->find_detections(wrap_bgr_frame(bgr, size, stride), nullptr));
+}
+
+/**
+ * @brief Finds logos with bounding rectangles and pixel areas of their blue and red parts
+ */
+Detections PepsiDetector::find_detections(const cv::Mat& img) const
+{
+    return m_impl->find_detections(img, nullptr);
+}
+
+/**
+ * @brief Finds logos with their parts and fills statistics of that call
+ * Statistics contain time spent in each stage and numbers of blobs left
+ *  after each filter. Their collection costs only a few clock reads.
+ *  Observer set in given statistics is kept and notified about each stage.
+ */
+Detections PepsiDetector::find_detections(const cv::Mat& img, DetectionStats& stats) const
+{
+    const auto observer = stats.observer;
+    stats = DetectionStats{};
+    stats.observer = observer;
+
+    const auto start = std::chrono::steady_clock::now();
+    auto detections = m_impl->find_detections(img, &stats);
+    stats.total_time = (std::chrono::steady_clock::now() - start);
+    stats.logos_found = detections.size();
+
+    return detections;
+}
+
+const PepsiDetector::Config& PepsiDetector::config() const noexcept
+{
+    return m_impl->config();
 }
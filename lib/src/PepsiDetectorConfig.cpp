@@ -1,5 +1,9 @@
 #include "PepsiDetector.hpp"
 
+#include <cmath>
+
+#include "hash.hpp"
+
 using nlohmann::json;
 
 namespace cv {
@@ -33,6 +37,10 @@ PepsiDetector::Config::Config()
 	,	red_blob_hu1_range{0.006, 0.015}
 
     ,   max_blobs_centers_distance{30.0}
+
+    ,   pyramid{false}
+    ,   part_windows{true}
+    ,   precheck{PrecheckMode::Off}
 {}
 
 PepsiDetector::Config PepsiDetector::Config::from_json(const nlohmann::json& json)
@@ -47,6 +55,60 @@ PepsiDetector::Config PepsiDetector::Config::from_json(const nlohmann::json& jso
     config.red_blob_hu0_range = json.at("red_blob_hu0_range");
     config.red_blob_hu1_range = json.at("red_blob_hu1_range");
     config.max_blobs_centers_distance = json.at("max_blobs_centers_distance");
+    config.pyramid = json.value("pyramid", false);
+    config.part_windows = json.value("part_windows", true);
+    config.precheck = parse_precheck_mode(json.value("precheck", std::string{"off"}));
 
     return config;
 }
+
+/**
+ * @brief Returns config for images resized by given factor
+ * Blobs areas are scaled with square of factor, distances linearly.
+ *  Hu moments are invariant to scale, so they are left unchanged.
+ */
+PepsiDetector::Config PepsiDetector::Config::scaled(double factor) const
+{
+    CV_Assert(factor > 0.0);
+
+    const auto scale_area = [area_factor = (factor * factor)](BlobAreaRange range)
+        {
+            return BlobAreaRange{
+                static_cast<BlobArea>(std::floor(range.min * area_factor)),
+                static_cast<BlobArea>(std::ceil(range.max * area_factor))
+            };
+        };
+
+    auto config = *this;
+    config.blue_blob_area_range = scale_area(blue_blob_area_range);
+    config.red_blob_area_range = scale_area(red_blob_area_range);
+    config.max_blobs_centers_distance = (max_blobs_centers_distance * factor);
+
+    return config;
+}
+
+/**
+ * @brief Returns hash of all params, e.g. to key cached results of detection
+ * Fields are hashed one by one, so padding between them does not matter.
+ *  Part windows and precheck in guarantee mode are skipped, as they never change results.
+ */
+std::uint64_t PepsiDetector::Config::hash() const
+{
+    auto hash = std::uint64_t{0};
+    const auto add = [&hash](const auto& value) { hash = hash_bytes(&value, sizeof(value), hash); };
+    const auto add_range = [&add](const auto& range) { add(range.min); add(range.max); };
+
+    add_range(blue_range);
+    add_range(blue_blob_area_range);
+    add_range(blue_blob_hu0_range);
+    add_range(blue_blob_hu1_range);
+    add_range(red_range);
+    add_range(red_blob_area_range);
+    add_range(red_blob_hu0_range);
+    add_range(red_blob_hu1_range);
+    add(max_blobs_centers_distance);
+    add(static_cast<std::uint8_t>(pyramid));
+    add(static_cast<std::uint8_t>(precheck == PrecheckMode::Estimate));
+
+    return hash;
+}
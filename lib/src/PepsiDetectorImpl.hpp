@@ -2,50 +2,82 @@
 
 #include "PepsiDetector.hpp"
 
+#include <memory>
+#include <optional>
+
+#include "CascadeOrder.hpp"
 #include "blobs.hpp"
+#include "stats.hpp"
 
 class PepsiDetector::Impl
 {
 public:
     explicit Impl(const Config& config);
 
-    Logos find_logos(const cv::Mat& bgr) const;
+    Detections find_detections(const cv::Mat& bgr, DetectionStats* stats) const;
+
+    Detections find_detections(const cv::Mat& bgr, const Rects& rois, DetectionStats* stats) const;
+
+    const Config& config() const noexcept;
 
 private:
-	cv::Mat_<cv::Vec3b> enhance_image(const cv::Mat_<cv::Vec3b>& bgr) const;
+	Detections find_detections_full(const cv::Mat& bgr, DetectionStats* stats) const;
+
+	Detections find_detections_coarse_to_fine(const cv::Mat& bgr, DetectionStats* stats) const;
+
+	Rects find_candidate_regions(const cv::Mat& bgr, DetectionStats* stats) const;
+
+	bool colors_present(const cv::Mat_<cv::Vec3b>& bgr, DetectionStats* stats) const;
 
-	cv::Mat_<cv::Vec3b> convert_image(const cv::Mat_<cv::Vec3b>& bgr) const;
+	cv::Mat_<cv::Vec3b> enhance_image(const cv::Mat_<cv::Vec3b>& bgr, DetectionStats* stats) const;
 
-	Blobs detect_blue_blobs(const cv::Mat_<cv::Vec3b>& hsv) const;
+	cv::Mat_<cv::Vec3b> convert_image(const cv::Mat_<cv::Vec3b>& bgr, DetectionStats* stats) const;
 
-	Blobs detect_red_blobs(const cv::Mat_<cv::Vec3b>& hsv) const;
+	Blobs detect_branch_blobs(CascadeBranch branch, bool first, const Blobs& other_blobs,
+							  const cv::Mat_<cv::Vec3b>& hsv, DetectionStats* stats) const;
 
-	cv::Mat_<uchar> extract_blue_color(const cv::Mat_<cv::Vec3b>& hsv) const;
+	Blobs detect_branch_blobs_near(CascadeBranch branch, const Blobs& other_blobs,
+								   const cv::Mat_<cv::Vec3b>& hsv, DetectionStats* stats) const;
 
-	cv::Mat_<uchar> extract_red_color(const cv::Mat_<cv::Vec3b>& hsv) const;
+	Rects make_part_windows(CascadeBranch branch, const Blobs& other_blobs, cv::Size size) const;
 
-	cv::Mat_<uchar> threshold_blue_color(const cv::Mat_<cv::Vec3b>& hsv) const;
+	std::optional<Blobs> find_branch_blobs_in_windows(CascadeBranch branch, const Rects& windows,
+													  const cv::Mat_<cv::Vec3b>& hsv, DetectionStats* stats) const;
 
-	cv::Mat_<uchar> threshold_red_color(const cv::Mat_<cv::Vec3b>& hsv) const;
+	Blobs detect_blue_blobs(const cv::Mat_<cv::Vec3b>& hsv, DetectionStats* stats) const;
 
-	void filter_color_mask(cv::Mat_<uchar>& mask) const;
+	Blobs detect_red_blobs(const cv::Mat_<cv::Vec3b>& hsv, DetectionStats* stats) const;
 
-	Blobs find_blue_blobs(cv::Mat_<uchar>& blue_color_mask) const;
+	cv::Mat_<uchar> extract_blue_color(const cv::Mat_<cv::Vec3b>& hsv, DetectionStats* stats) const;
 
-	Blobs find_red_blobs(cv::Mat_<uchar>& red_color_mask) const;
+	cv::Mat_<uchar> extract_red_color(const cv::Mat_<cv::Vec3b>& hsv, DetectionStats* stats) const;
 
-	void filter_blue_blobs(Blobs& blobs) const;
+	cv::Mat_<uchar> threshold_blue_color(const cv::Mat_<cv::Vec3b>& hsv, DetectionStats* stats) const;
 
-	void filter_red_blobs(Blobs& blobs) const;
+	cv::Mat_<uchar> threshold_red_color(const cv::Mat_<cv::Vec3b>& hsv, DetectionStats* stats) const;
+
+	void filter_color_mask(cv::Mat_<uchar>& mask, DetectionStats* stats) const;
+
+	Blobs find_blue_blobs(cv::Mat_<uchar>& blue_color_mask, DetectionStats* stats) const;
+
+	Blobs find_red_blobs(cv::Mat_<uchar>& red_color_mask, DetectionStats* stats) const;
+
+	void filter_blue_blobs(Blobs& blobs, DetectionStats* stats) const;
+
+	void filter_red_blobs(Blobs& blobs, DetectionStats* stats) const;
 
 	Blobs::iterator filter_blobs_by_area(Blobs& blobs, BlobAreaRange blob_area_range) const;
 
-	Blobs::iterator filter_blobs_by_hu_moments(Blobs& blobs, HuMomentsArray hu_moments_array,
+	Blobs::iterator filter_blobs_by_hu_moments(Blobs& blobs, const HuMomentsArray& hu_moments_array,
 											   HuMomentRange hu0_range, HuMomentRange hu1_range) const;
 
 	bool blobs_centers_matching(Point red_center, Point blue_center) const;
 
-	Logos match_blobs(const Blobs& red_blobs, const Blobs& blue_blobs) const;
+	Detections match_blobs(const Blobs& red_blobs, const Blobs& blue_blobs, DetectionStats* stats) const;
 
     Config m_config;
+
+    int m_pyramid_factor;
+    std::shared_ptr<const Impl> m_coarse_impl;
+    CascadeOrder m_cascade;
 };
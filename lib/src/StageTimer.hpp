@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chrono>
+
+#include "stats.hpp"
+#include "trace.hpp"
+
+/**
+ * @brief Adds time spent in its scope to given stage of detection statistics
+ * When statistics are not requested (null pointer), clock is not read at all.
+ *  Observer of the statistics, if any, is notified outside of the timed region.
+ *  Independently of statistics, the stage is recorded as a span, if tracing is enabled.
+ */
+class StageTimer
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	StageTimer(DetectionStats* stats, Stage stage) noexcept
+		:	m_stats(stats)
+		,	m_stage(stage)
+		,	m_span(get_stage_name(stage))
+	{
+		if(m_stats)
+		{
+			if(m_stats->observer)
+			{
+				m_stats->observer->begin_stage(m_stage);
+			}
+
+			m_start = Clock::now();
+		}
+	}
+
+	~StageTimer()
+	{
+		if(m_stats)
+		{
+			m_stats->stage_time(m_stage) += (Clock::now() - m_start);
+
+			if(m_stats->observer)
+			{
+				m_stats->observer->end_stage(m_stage);
+			}
+		}
+	}
+
+	StageTimer(const StageTimer&) = delete;
+	StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+	DetectionStats* m_stats;
+	Stage m_stage;
+	Clock::time_point m_start;
+	trace::Span m_span;
+};
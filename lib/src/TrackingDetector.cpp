@@ -0,0 +1,120 @@
+#include "TrackingDetector.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+#include "log.hpp"
+#include "points.hpp"
+
+namespace {
+
+Rects get_tracking_rois(const Logos& logos, int margin, cv::Size frame_size)
+{
+    auto rois = Rects();
+    rois.reserve(logos.size());
+
+    std::transform(logos.begin(), logos.end(),
+                   std::back_inserter(rois),
+                   [margin, frame_size](const auto& logo)
+                   {
+                       return expand_rect(logo, margin, frame_size);
+                   });
+
+    return merge_overlapping_rects(std::move(rois));
+}
+
+} // namespace
+
+/**
+ * @brief Default constructor for TrackingDetector's Config. Provides default values for params
+ */
+TrackingDetector::Config::Config()
+    :   keyframe_interval{30}
+    ,   roi_margin{32}
+{}
+
+TrackingDetector::TrackingDetector(PepsiDetector detector, const Config& config)
+    :   m_detector(std::move(detector))
+    ,   m_config(config)
+    ,   m_frames_since_keyframe{0}
+{
+    CV_Assert(m_config.keyframe_interval > 0);
+    CV_Assert(m_config.roi_margin >= 0);
+}
+
+Logos TrackingDetector::find_logos(const cv::Mat& frame)
+{
+    m_stats = FrameStats{};
+    m_stats.total_pixels = frame.total();
+
+    auto logos = Logos();
+    if(is_keyframe(frame))
+    {
+        logos = detect_keyframe(frame);
+    }
+    else
+    {
+        logos = detect_tracked(frame);
+        if(logos.size() < m_logos.size())
+        {
+            DETECTOR_LOG_DEBUG("[TrackingDetector] Lost {} logos, detecting on full frame...",
+                          (m_logos.size() - logos.size()));
+            logos = detect_keyframe(frame);
+        }
+        else
+        {
+            ++m_frames_since_keyframe;
+        }
+    }
+
+    DETECTOR_LOG_DEBUG("[TrackingDetector] Processed {} of {} pixels",
+                  m_stats.processed_pixels, m_stats.total_pixels);
+
+    m_logos = logos;
+    return logos;
+}
+
+const TrackingDetector::FrameStats& TrackingDetector::last_frame_stats() const noexcept
+{
+    return m_stats;
+}
+
+void TrackingDetector::reset() noexcept
+{
+    m_logos.clear();
+    m_frame_size = cv::Size{};
+    m_frames_since_keyframe = 0;
+}
+
+bool TrackingDetector::is_keyframe(const cv::Mat& frame) const noexcept
+{
+    return (m_frame_size != frame.size()
+        || m_frames_since_keyframe >= m_config.keyframe_interval);
+}
+
+Logos TrackingDetector::detect_keyframe(const cv::Mat& frame)
+{
+    DETECTOR_LOG_DEBUG("[TrackingDetector] Detecting logos on keyframe...");
+
+    m_frame_size = frame.size();
+    m_frames_since_keyframe = 1;
+
+    m_stats.keyframe = true;
+    m_stats.processed_pixels += frame.total();
+
+    return m_detector.find_logos(frame);
+}
+
+Logos TrackingDetector::detect_tracked(const cv::Mat& frame)
+{
+    DETECTOR_LOG_DEBUG("[TrackingDetector] Detecting logos around {} tracked logos...", m_logos.size());
+
+    const auto rois = get_tracking_rois(m_logos, m_config.roi_margin, frame.size());
+
+    for(const auto& roi : rois)
+    {
+        m_stats.processed_pixels += roi.area();
+    }
+
+    return m_detector.find_logos(frame, rois);
+}
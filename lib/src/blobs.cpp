@@ -53,8 +53,6 @@ Blob find_blob_at(cv::Mat_<uchar>& img, cv::Point first)
 
 Blobs find_blobs(cv::Mat_<uchar>& img)
 {
-    CV_Assert(img.isContinuous());
-
 	auto blobs = Blobs();
     blobs.reserve(256); // Typically it should be less than this value
 
@@ -62,9 +60,9 @@ Blobs find_blobs(cv::Mat_<uchar>& img)
     const auto ncols = img.cols;
 
     auto point = cv::Point();
-    auto ptr = img.data;
     for(point.y = 0; point.y < nrows; ++point.y)
     {
+        auto ptr = img.ptr<uchar>(point.y);
         for(point.x = 0; point.x < ncols; ++point.x)
         {
             if(*ptr != 0)
@@ -1,54 +1,63 @@
 #include "core.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 #include <opencv2/imgproc.hpp>
 
 void threshold(const cv::Mat_<cv::Vec3b>& src, cv::Mat_<uchar>& dst,
 			   const ColorRange& color_range)
 {
 	CV_Assert(src.size() == dst.size());
-	CV_Assert(src.isContinuous());
-	CV_Assert(dst.isContinuous());
 
-	auto src_ptr = src.data;
-    const auto src_end = src.dataend;
-    auto dst_ptr = dst.data;
+	const auto ncols = src.cols;
+	const auto nrows = src.rows;
+	for(auto y = 0; y < nrows; ++y)
+	{
+		auto src_ptr = src.ptr<uchar>(y);
+		const auto src_end = (src_ptr + 3*ncols);
+		auto dst_ptr = dst.ptr<uchar>(y);
 
-    while(src_ptr != src_end)
-    {
-    	const auto a = *(src_ptr++);
-    	const auto b = *(src_ptr++);
-    	const auto c = *(src_ptr++);
-
-    	if(a >= color_range.min[0] && a <= color_range.max[0]
-    		&& b >= color_range.min[1] && b <= color_range.max[1]
-    		&& c >= color_range.min[2] && c <= color_range.max[2])
-    	{
-    		*(dst_ptr) = 255;
-    	}
-    	else
-    	{
-    		*(dst_ptr) = 0;
-    	}
-
-    	++dst_ptr;
-    }
+		while(src_ptr != src_end)
+		{
+			const auto a = *(src_ptr++);
+			const auto b = *(src_ptr++);
+			const auto c = *(src_ptr++);
+
+			if(a >= color_range.min[0] && a <= color_range.max[0]
+				&& b >= color_range.min[1] && b <= color_range.max[1]
+				&& c >= color_range.min[2] && c <= color_range.max[2])
+			{
+				*(dst_ptr) = 255;
+			}
+			else
+			{
+				*(dst_ptr) = 0;
+			}
+
+			++dst_ptr;
+		}
+	}
 }
 
 void bitwise_or(const cv::Mat_<uchar>& src1, const cv::Mat_<uchar>& src2, cv::Mat_<uchar>& dst)
 {
 	CV_Assert(src1.size() == src2.size());
     CV_Assert(src2.size() == dst.size());
-    CV_Assert(src1.isContinuous());
-    CV_Assert(src2.isContinuous());
-    CV_Assert(dst.isContinuous());
-
-    auto src1_ptr = src1.data;
-    auto src2_ptr = src2.data;
-    auto dst_ptr = dst.data;
-    const auto dst_end = dst.dataend;
-    while(dst_ptr != dst_end)
+
+    const auto ncols = dst.cols;
+    const auto nrows = dst.rows;
+    for(auto y = 0; y < nrows; ++y)
     {
-        *(dst_ptr++) = (*(src1_ptr++) | *(src2_ptr++));
+        auto src1_ptr = src1.ptr<uchar>(y);
+        auto src2_ptr = src2.ptr<uchar>(y);
+        auto dst_ptr = dst.ptr<uchar>(y);
+        const auto dst_end = (dst_ptr + ncols);
+        while(dst_ptr != dst_end)
+        {
+            *(dst_ptr++) = (*(src1_ptr++) | *(src2_ptr++));
+        }
     }
 }
 
@@ -65,11 +74,68 @@ void clamp(T& t, T min, T max)
     }
 }
 
+namespace {
+
+inline cv::Vec3b filter_pixel_at(const cv::Mat3b& src, int x, int y, const cv::Mat1f& kernel)
+{
+    const auto ncols = src.cols;
+    const auto nrows = src.rows;
+
+    const auto width = kernel.cols;
+    const auto height = kernel.rows;
+
+    const auto anchor_x = (width/2);
+    const auto anchor_y = (height/2);
+
+    auto accu = cv::Vec3f::all(0.0f);
+    auto kernel_ptr = reinterpret_cast<const float*>(kernel.data);
+    for(auto ky = 0; ky < height; ++ky)
+    {
+        const auto src_y = y + ky - anchor_y;
+        if(src_y < 0 || src_y >= nrows)
+        {
+            kernel_ptr += width;
+            continue;
+        }
+
+        const auto src_row = src.ptr<uchar>(src_y);
+        for(auto kx = 0; kx < width; ++kx, ++kernel_ptr)
+        {
+            const auto src_x = x + kx - anchor_x;
+            if(src_x < 0 || src_x >= ncols)
+            {
+                continue;
+            }
+
+            assert(src_x >= 0 && src_x < ncols);
+            const auto src_ptr = (src_row + 3*src_x);
+            const auto src_v0 = *(src_ptr);
+            const auto src_v1 = *(src_ptr + 1);
+            const auto src_v2 = *(src_ptr + 2);
+
+            assert(ky >= 0 && ky < height);
+            assert(kx >= 0 && kx < width);
+            assert((uchar*)kernel_ptr >= kernel.data && (uchar*)kernel_ptr < kernel.dataend);
+            const auto k_v = *kernel_ptr;
+
+            accu[0] += (k_v * src_v0);
+            accu[1] += (k_v * src_v1);
+            accu[2] += (k_v * src_v2);
+        }
+    }
+
+    clamp(accu[0], 0.0f, 255.0f);
+    clamp(accu[1], 0.0f, 255.0f);
+    clamp(accu[2], 0.0f, 255.0f);
+
+    return cv::Vec3b{static_cast<uchar>(accu[0]), static_cast<uchar>(accu[1]), static_cast<uchar>(accu[2])};
+}
+
+} // namespace
+
 void filter_image(const cv::Mat3b& src, cv::Mat3b& dst, const cv::Mat1f& kernel)
 {
     CV_Assert(src.size() == dst.size());
-    CV_Assert(src.isContinuous());
-    CV_Assert(dst.isContinuous());
     CV_Assert(kernel.rows % 2 == 1);
     CV_Assert(kernel.cols % 2 == 1);
     CV_Assert(kernel.isContinuous());
@@ -78,73 +144,122 @@ void filter_image(const cv::Mat3b& src, cv::Mat3b& dst, const cv::Mat1f& kernel)
     const auto ncols = src.cols;
     const auto nrows = src.rows;
 
-    const auto width = kernel.cols;
-    const auto height = kernel.rows;
+    // Rows are accessed through row pointers, so source may be a view (e.g. ROI) of bigger image
+    for(auto y = 0; y < nrows; ++y)
+    {
+        auto dst_ptr = dst.ptr<uchar>(y);
+        for(auto x = 0; x < ncols; ++x)
+        {
+            const auto value = filter_pixel_at(src, x, y, kernel);
+            *(dst_ptr++) = value[0];
+            *(dst_ptr++) = value[1];
+            *(dst_ptr++) = value[2];
+        }
+    }
+}
 
-    const auto anchor_x = (width/2);
-    const auto anchor_y = (height/2);
+/**
+ * @brief Returns unsharp mask kernel 5x5, based on Gaussian blur with amount as 1 and threshold as 0
+ */
+const cv::Mat1f& get_unsharp_mask_kernel()
+{
+    static const auto kernel = []() {
+        const float kernel_data[] = {
+            -1.0/256,  -4.0/256,   -6.0/256,  -4.0/256, -1.0/256,
+            -4.0/256, -16.0/256,  -24.0/256, -16.0/256, -4.0/256,
+            -6.0/256, -24.0/256,  476.0/256, -24.0/256, -6.0/256,
+            -4.0/256, -16.0/256,  -24.0/256, -16.0/256, -4.0/256,
+            -1.0/256,  -4.0/256,   -6.0/256,  -4.0/256, -1.0/256,
+        };
 
-    auto dst_ptr = dst.data;
-    auto src_ptr_start = (src.data - 3*((anchor_y*ncols) + anchor_x));
+        return cv::Mat1f{cv::Mat(5, 5, CV_32F, const_cast<float*>(kernel_data)).clone()};
+    }();
+
+    return kernel;
+}
+
+/**
+ * @brief Returns single pixel of image filtered with kernel, the same as filter_image would write there
+ */
+cv::Vec3b filter_pixel(const cv::Mat3b& src, cv::Point point, const cv::Mat1f& kernel)
+{
+    CV_Assert(is_point_valid(src, point));
+    CV_Assert(kernel.rows % 2 == 1);
+    CV_Assert(kernel.cols % 2 == 1);
+    CV_Assert(kernel.isContinuous());
+
+    return filter_pixel_at(src, point.x, point.y, kernel);
+}
+
+/**
+ * @brief Shrinks image by integer factor, averaging each factor x factor block of pixels
+ * Destination size must be equal to source size divided by factor (rounded down).
+ */
+void downsample(const cv::Mat3b& src, cv::Mat3b& dst, int factor)
+{
+    CV_Assert(factor > 0);
+    CV_Assert(dst.cols == (src.cols / factor));
+    CV_Assert(dst.rows == (src.rows / factor));
+
+    const auto ncols = dst.cols;
+    const auto nrows = dst.rows;
+    const auto area = (factor * factor);
+
+    auto sums = std::vector<int>(3 * ncols);
     for(auto y = 0; y < nrows; ++y)
     {
-        for(auto x = 0; x < ncols; ++x, src_ptr_start += 3)
+        std::fill(sums.begin(), sums.end(), 0);
+        for(auto sy = (y * factor); sy < ((y + 1) * factor); ++sy)
         {
-            auto accu = cv::Vec3f::all(0.0f);
-            auto kernel_ptr = reinterpret_cast<float*>(kernel.data);
-            auto src_ptr = src_ptr_start;
-            for(auto ky = 0; ky < height; ++ky)
+            auto src_ptr = src.ptr<uchar>(sy);
+            auto sums_ptr = sums.data();
+            for(auto x = 0; x < ncols; ++x, sums_ptr += 3)
             {
-                for(auto kx = 0; kx < width; ++kx, ++kernel_ptr, src_ptr += 3)
+                for(auto sx = 0; sx < factor; ++sx)
                 {
-                    const auto src_y = y + ky - anchor_y;
-                    const auto src_x = x + kx - anchor_x;
-
-                    if(src_y < 0 || src_y >= nrows || src_x < 0 || src_x >= ncols)
-                    {
-                        continue;
-                    }
-
-                    assert(src_y >= 0 && src_y < nrows);
-                    assert(src_x >= 0 && src_x < ncols);
-                    assert(src_ptr >= src.data && src_ptr+2 < src.dataend);
-                    const auto src_v0 = *(src_ptr);
-                    const auto src_v1 = *(src_ptr + 1);
-                    const auto src_v2 = *(src_ptr + 2);
-
-                    assert(ky >= 0 && ky < height);
-                    assert(kx >= 0 && kx < width);
-                    assert((uchar*)kernel_ptr >= kernel.data && (uchar*)kernel_ptr < kernel.dataend);
-                    const auto k_v = *kernel_ptr;
-
-                    accu[0] += (k_v * src_v0);
-                    accu[1] += (k_v * src_v1);
-                    accu[2] += (k_v * src_v2);
+                    sums_ptr[0] += *(src_ptr++);
+                    sums_ptr[1] += *(src_ptr++);
+                    sums_ptr[2] += *(src_ptr++);
                 }
-
-                src_ptr += (3*(ncols - width));
             }
+        }
 
-            clamp(accu[0], 0.0f, 255.0f);
-            clamp(accu[1], 0.0f, 255.0f);
-            clamp(accu[2], 0.0f, 255.0f);
-
-            assert(dst_ptr >= dst.data && dst_ptr+2 < dst.dataend);
-            *(dst_ptr++) = static_cast<uchar>(accu[0]);
-            *(dst_ptr++) = static_cast<uchar>(accu[1]);
-            *(dst_ptr++) = static_cast<uchar>(accu[2]);
+        auto dst_ptr = dst.ptr<uchar>(y);
+        for(const auto sum : sums)
+        {
+            *(dst_ptr++) = static_cast<uchar>((sum + area/2) / area);
         }
     }
 }
 
+/**
+ * @brief Splits red range wrapping around hue 0 into left and right ranges
+ */
+ColorRanges get_red_ranges(const ColorRange& red_range)
+{
+    auto left_red_range = red_range;
+    left_red_range.min[0] = 0;
+
+    auto right_red_range = red_range;
+    right_red_range.max[0] = 180;
+
+    return ColorRanges{left_red_range, right_red_range};
+}
+
 bool images_equal(const cv::Mat& img1, const cv::Mat& img2)
 {
     assert(img1.size() == img2.size());
     assert(img1.channels() == img2.channels());
     assert(img1.depth() == img2.depth());
-    assert(img1.isContinuous());
-    assert(img2.isContinuous());
 
-    assert(img1.data == img1.datastart);
-    return (std::memcmp(img1.data, img2.data, img1.dataend - img1.datastart) == 0);
+    const auto row_size = (img1.cols * img1.elemSize());
+    for(auto y = 0; y < img1.rows; ++y)
+    {
+        if(std::memcmp(img1.ptr(y), img2.ptr(y), row_size) != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
 }
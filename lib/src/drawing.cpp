@@ -42,3 +42,11 @@ void draw_rectangle_centered(cv::Mat_<uchar>& img, cv::Size size, uchar color, i
 		          color,
 		          thickness);
 }
+
+void draw_logos(cv::Mat& img, const Logos& logos)
+{
+	for(const auto& logo : logos)
+	{
+		cv::rectangle(img, logo, cv::Scalar{0, 255, 0});
+	}
+}
@@ -47,33 +47,47 @@ inline uchar calc_saturation(uchar max, uchar diff)
 	return static_cast<uchar>((diff * 255.0) / max);
 }
 
+inline cv::Vec3b convert_bgr2hsv(uchar blue, uchar green, uchar red)
+{
+	const auto min = std::min({blue, green, red});
+	const auto max = std::max({blue, green, red});
+
+	const auto diff = (max - min);
+	const auto hue = calc_hue(blue, green, red, max, diff);
+	const auto saturation = calc_saturation(max, diff);
+	const auto value = max;
+
+	return cv::Vec3b{hue, saturation, value};
+}
+
 } // namespace
 
 void bgr2hsv(const cv::Mat_<cv::Vec3b>& src, cv::Mat_<cv::Vec3b>& dst)
 {
 	CV_Assert(src.size() == dst.size());
-	CV_Assert(src.isContinuous());
-	CV_Assert(dst.isContinuous());
 
-	auto src_it = src.data;
-	auto dst_it = dst.data;
-	const auto dst_end = dst.dataend;
-	while(dst_it != dst_end)
+	const auto ncols = src.cols;
+	const auto nrows = src.rows;
+	for(auto y = 0; y < nrows; ++y)
 	{
-		const auto blue = *(src_it++);
-		const auto green = *(src_it++);
-		const auto red = *(src_it++);
+		auto src_it = src.ptr<uchar>(y);
+		auto dst_it = dst.ptr<uchar>(y);
+		const auto dst_end = (dst_it + 3*ncols);
+		while(dst_it != dst_end)
+		{
+			const auto blue = *(src_it++);
+			const auto green = *(src_it++);
+			const auto red = *(src_it++);
 
-		const auto min = std::min({blue, green, red});
-		const auto max = std::max({blue, green, red});
-
-		const auto diff = (max - min);
-		const auto hue = calc_hue(blue, green, red, max, diff);
-		const auto saturation = calc_saturation(max, diff);
-		const auto value = max;
-
-		*(dst_it++) = hue;
-		*(dst_it++) = saturation;
-		*(dst_it++) = value;
+			const auto hsv = convert_bgr2hsv(blue, green, red);
+			*(dst_it++) = hsv[0];
+			*(dst_it++) = hsv[1];
+			*(dst_it++) = hsv[2];
+		}
 	}
 }
+
+cv::Vec3b bgr2hsv(cv::Vec3b bgr)
+{
+	return convert_bgr2hsv(bgr[0], bgr[1], bgr[2]);
+}
@@ -0,0 +1,39 @@
+#include "frame.hpp"
+
+#include <cctype>
+
+#include <algorithm>
+#include <string>
+
+/**
+ * @brief Wraps caller-owned BGR buffer into an image header, without copying
+ * Rows may be padded (stride greater than 3 * width), e.g. aligned by capture hardware.
+ *  Buffer is not modified by detectors, but it must outlive returned image.
+ *
+ * @param data pointer to the first pixel of the first row
+ * @param size width and height of the frame in pixels
+ * @param stride distance between beginnings of consecutive rows in bytes
+ *
+ * @return
+ */
+cv::Mat wrap_bgr_frame(const uchar* data, cv::Size size, std::size_t stride)
+{
+    CV_Assert(data != nullptr);
+    CV_Assert(size.width >= 0 && size.height >= 0);
+    CV_Assert(stride >= static_cast<std::size_t>(3 * size.width));
+
+    return cv::Mat(size, CV_8UC3, const_cast<uchar*>(data), stride);
+}
+
+/**
+ * @brief Checks, if file extension (in any case) is one of image formats read by the detectors' callers
+ */
+bool is_image_file(const std::filesystem::path& path)
+{
+    auto extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+
+    return (extension == ".jpg" || extension == ".jpeg"
+        || extension == ".png" || extension == ".bmp");
+}
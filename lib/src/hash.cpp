@@ -0,0 +1,140 @@
+#include "hash.hpp"
+
+#include <cstring>
+
+namespace {
+
+constexpr auto Prime1 = std::uint64_t{0x9E3779B185EBCA87};
+constexpr auto Prime2 = std::uint64_t{0xC2B2AE3D27D4EB4F};
+constexpr auto Prime3 = std::uint64_t{0x165667B19E3779F9};
+constexpr auto Prime4 = std::uint64_t{0x85EBCA77C2B2AE63};
+constexpr auto Prime5 = std::uint64_t{0x27D4EB2F165667C5};
+
+std::uint64_t rotate_left(std::uint64_t value, int bits) noexcept
+{
+    return ((value << bits) | (value >> (64 - bits)));
+}
+
+std::uint64_t read_word(const unsigned char* data) noexcept
+{
+    auto word = std::uint64_t{0};
+    std::memcpy(&word, data, sizeof(word));
+    return word;
+}
+
+std::uint64_t round(std::uint64_t accumulator, std::uint64_t word) noexcept
+{
+    accumulator += (word * Prime2);
+    return (rotate_left(accumulator, 31) * Prime1);
+}
+
+std::uint64_t merge_round(std::uint64_t hash, std::uint64_t accumulator) noexcept
+{
+    hash ^= round(0, accumulator);
+    return (hash * Prime1 + Prime4);
+}
+
+std::uint64_t avalanche(std::uint64_t hash) noexcept
+{
+    hash ^= (hash >> 33);
+    hash *= Prime2;
+    hash ^= (hash >> 29);
+    hash *= Prime3;
+    hash ^= (hash >> 32);
+    return hash;
+}
+
+} // namespace
+
+/**
+ * @brief Computes fast, non-cryptographic 64-bit hash of given bytes
+ * Bytes are consumed in 32 byte blocks by four independent accumulators, so multiplications
+ *  of consecutive words overlap in the pipeline (the same scheme as xxHash64 uses).
+ *  Words are read in native byte order, so hashes are stable only between machines of the same endianness.
+ *
+ * @param data
+ * @param size in bytes
+ * @param seed e.g. hash of preceding data
+ *
+ * @return
+ */
+std::uint64_t hash_bytes(const void* data, std::size_t size, std::uint64_t seed) noexcept
+{
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    const auto* const end = (bytes + size);
+
+    auto hash = std::uint64_t{0};
+    if(size >= 32)
+    {
+        auto v1 = (seed + Prime1 + Prime2);
+        auto v2 = (seed + Prime2);
+        auto v3 = seed;
+        auto v4 = (seed - Prime1);
+        for(; bytes + 32 <= end; bytes += 32)
+        {
+            v1 = round(v1, read_word(bytes));
+            v2 = round(v2, read_word(bytes + 8));
+            v3 = round(v3, read_word(bytes + 16));
+            v4 = round(v4, read_word(bytes + 24));
+        }
+
+        hash = (rotate_left(v1, 1) + rotate_left(v2, 7) + rotate_left(v3, 12) + rotate_left(v4, 18));
+        hash = merge_round(hash, v1);
+        hash = merge_round(hash, v2);
+        hash = merge_round(hash, v3);
+        hash = merge_round(hash, v4);
+    }
+    else
+    {
+        hash = (seed + Prime5);
+    }
+
+    hash += static_cast<std::uint64_t>(size);
+
+    for(; bytes + 8 <= end; bytes += 8)
+    {
+        hash ^= round(0, read_word(bytes));
+        hash = (rotate_left(hash, 27) * Prime1 + Prime4);
+    }
+
+    for(; bytes < end; ++bytes)
+    {
+        hash ^= (*bytes * Prime5);
+        hash = (rotate_left(hash, 11) * Prime1);
+    }
+
+    return avalanche(hash);
+}
+
+/**
+ * @brief Computes hash of image pixels, together with its size and type
+ * Rows are hashed one by one, so the hash does not depend on padding between them,
+ *  e.g. frame wrapped with stride and its continuous copy have the same hash.
+ *
+ * @param img
+ *
+ * @return
+ */
+std::uint64_t hash_image(const cv::Mat& img)
+{
+    CV_Assert(img.dims == 2);
+
+    const int header[] = {img.rows, img.cols, img.type()};
+    auto hash = hash_bytes(header, sizeof(header));
+
+    const auto row_size = (img.cols * img.elemSize());
+    for(auto y = 0; y < img.rows; ++y)
+    {
+        hash = hash_bytes(img.ptr(y), row_size, hash);
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Mixes given value into the hash, e.g. to build keys from several parts
+ */
+std::uint64_t hash_combine(std::uint64_t seed, std::uint64_t value) noexcept
+{
+    return hash_bytes(&value, sizeof(value), seed);
+}
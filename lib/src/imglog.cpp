@@ -1,36 +1,208 @@
 #include "imglog.hpp"
 
+#include <cstdio>
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <thread>
+
 #include <opencv2/highgui.hpp>
 
+#include "BoundedQueue.hpp"
+#include "log.hpp"
+
+namespace fs = std::filesystem;
+
 namespace imglog {
 
 namespace {
 
-bool g_enabled = false;
+struct DumpEntry
+{
+	fs::path path;
+	cv::Mat img;
+};
+
+/**
+ * @brief Encodes queued images to files on its own thread
+ */
+class DumpWriter
+{
+public:
+	explicit DumpWriter(const DumpOptions& options)
+		:	m_directory(options.directory)
+		,	m_queue(options.queue_size)
+		,	m_thread([this]() { run(); })
+	{}
+
+	~DumpWriter()
+	{
+		m_queue.close();
+		m_thread.join();
+	}
+
+	bool write(const char* img_name, std::size_t frame, std::size_t index, cv::Mat img)
+	{
+		auto file_name = std::string(img_name);
+		std::replace(file_name.begin(), file_name.end(), ' ', '_');
+
+		char prefix[32];
+		std::snprintf(prefix, sizeof(prefix), "%06zu_%02zu_", frame, index);
+
+		return m_queue.try_push(DumpEntry{m_directory / (prefix + file_name + ".png"), std::move(img)});
+	}
+
+private:
+	void run()
+	{
+		while(auto entry = m_queue.pop())
+		{
+			if(!cv::imwrite(entry->path.string(), entry->img))
+			{
+				DETECTOR_LOG_WARN("[imglog] Could not write {}", entry->path.string());
+			}
+		}
+	}
+
+	const fs::path m_directory;
+	BoundedQueue<DumpEntry> m_queue;
+	std::thread m_thread;
+};
+
+enum class Mode
+{
+	Off,
+	Window,
+	Dump,
+};
+
+// Settings are read by detection threads, while they may be changed by other ones.
+//  Writer is shared, so the one taken by log() outlives disabling, and is only accessed atomically.
+std::atomic<Mode> g_mode{Mode::Off};
+std::atomic<int> g_every_nth_frame{1};
+std::shared_ptr<DumpWriter> g_writer;
+
+// Frames are numbered in order of beginning on any thread, so images of different frames
+//  never share a prefix. Current frame is kept per thread, as each thread processes its own image.
+std::atomic<std::size_t> g_next_frame{0};
+thread_local std::size_t t_frame = 0;
+thread_local std::size_t t_frame_images = 0;
+std::atomic<std::size_t> g_dropped{0};
+
+bool is_frame_sampled() noexcept
+{
+	const auto every_nth_frame = static_cast<std::size_t>(g_every_nth_frame.load(std::memory_order_relaxed));
+	return (t_frame % every_nth_frame == 0);
+}
+
+void log_to_window(const char* img_name, const cv::Mat& img)
+{
+	cv::imshow(img_name, img);
+	cv::moveWindow(img_name, 0, 0);
+}
+
+void log_to_writer(DumpWriter& writer, const char* img_name, cv::Mat img)
+{
+	if(!writer.write(img_name, t_frame, t_frame_images++, std::move(img)))
+	{
+		g_dropped.fetch_add(1, std::memory_order_relaxed);
+	}
+}
 
 } // namespace
 
 void enable() noexcept
 {
-	g_enabled = true;
+	g_mode.store(Mode::Window, std::memory_order_relaxed);
+}
+
+void enable_dump(const DumpOptions& options)
+{
+	CV_Assert(!options.directory.empty());
+	CV_Assert(options.queue_size > 0);
+	CV_Assert(options.every_nth_frame > 0);
+
+	disable();
+
+	fs::create_directories(options.directory);
+	std::atomic_store(&g_writer, std::make_shared<DumpWriter>(options));
+	g_every_nth_frame.store(options.every_nth_frame, std::memory_order_relaxed);
+	g_next_frame = 0;
+	t_frame = 0;
+	t_frame_images = 0;
+	g_dropped = 0;
+	g_mode.store(Mode::Dump, std::memory_order_relaxed);
 }
 
-void disable() noexcept
+void disable()
 {
-	g_enabled = false;
+	g_mode.store(Mode::Off, std::memory_order_relaxed);
+
+	// Writer is destroyed by the last log() still using it, if there is any
+	if(auto writer = std::atomic_exchange(&g_writer, std::shared_ptr<DumpWriter>()))
+	{
+		writer.reset();
+		if(g_dropped > 0)
+		{
+			DETECTOR_LOG_WARN("[imglog] Dropped {} images, as writer could not keep up", g_dropped.load());
+		}
+	}
+
+	g_every_nth_frame.store(1, std::memory_order_relaxed);
 }
 
 bool enabled() noexcept
 {
-	return g_enabled;
+	return (g_mode.load(std::memory_order_relaxed) != Mode::Off && is_frame_sampled());
+}
+
+void begin_frame() noexcept
+{
+	t_frame = g_next_frame.fetch_add(1, std::memory_order_relaxed);
+	t_frame_images = 0;
+}
+
+std::size_t dropped() noexcept
+{
+	return g_dropped.load(std::memory_order_relaxed);
 }
 
 void log(const char* img_name, const cv::Mat& img)
 {
-	if(g_enabled)
+	const auto mode = g_mode.load(std::memory_order_relaxed);
+	if(mode == Mode::Off || !is_frame_sampled())
+	{
+		return;
+	}
+
+	if(mode == Mode::Window)
+	{
+		log_to_window(img_name, img);
+	}
+	else if(const auto writer = std::atomic_load(&g_writer))
+	{
+		// Caller may modify the image after this call, while it waits in the queue
+		log_to_writer(*writer, img_name, img.clone());
+	}
+}
+
+void log(const char* img_name, cv::Mat&& img)
+{
+	const auto mode = g_mode.load(std::memory_order_relaxed);
+	if(mode == Mode::Off || !is_frame_sampled())
+	{
+		return;
+	}
+
+	if(mode == Mode::Window)
+	{
+		log_to_window(img_name, img);
+	}
+	else if(const auto writer = std::atomic_load(&g_writer))
 	{
-		cv::imshow(img_name, img);
-		cv::moveWindow(img_name, 0, 0);
+		log_to_writer(*writer, img_name, std::move(img));
 	}
 }
 
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <spdlog/spdlog.h>
+
+/**
+ * Logging macros of the library.
+ * Calls below DETECTOR_LOG_LEVEL are compiled out entirely. Remaining calls
+ *  evaluate their arguments only if the line is going to be emitted at runtime,
+ *  so formatting whole vectors (or computing values just to log them) costs nothing otherwise.
+ */
+
+#define DETECTOR_LOG_LEVEL_TRACE 0
+#define DETECTOR_LOG_LEVEL_DEBUG 1
+#define DETECTOR_LOG_LEVEL_INFO 2
+#define DETECTOR_LOG_LEVEL_WARN 3
+#define DETECTOR_LOG_LEVEL_ERROR 4
+#define DETECTOR_LOG_LEVEL_OFF 6
+
+#ifndef DETECTOR_LOG_LEVEL
+#define DETECTOR_LOG_LEVEL DETECTOR_LOG_LEVEL_DEBUG
+#endif
+
+#define DETECTOR_LOG_LAZY(lvl, ...) \
+	do \
+	{ \
+		if(spdlog::default_logger_raw()->should_log(spdlog::level::lvl)) \
+		{ \
+			spdlog::lvl(__VA_ARGS__); \
+		} \
+	} while(false)
+
+// Stripped calls are still compiled (but never run), so their arguments stay valid code
+#define DETECTOR_LOG_STRIPPED(lvl, ...) \
+	do \
+	{ \
+		if(false) \
+		{ \
+			spdlog::lvl(__VA_ARGS__); \
+		} \
+	} while(false)
+
+#if DETECTOR_LOG_LEVEL <= DETECTOR_LOG_LEVEL_DEBUG
+#define DETECTOR_LOG_DEBUG(...) DETECTOR_LOG_LAZY(debug, __VA_ARGS__)
+#else
+#define DETECTOR_LOG_DEBUG(...) DETECTOR_LOG_STRIPPED(debug, __VA_ARGS__)
+#endif
+
+#if DETECTOR_LOG_LEVEL <= DETECTOR_LOG_LEVEL_INFO
+#define DETECTOR_LOG_INFO(...) DETECTOR_LOG_LAZY(info, __VA_ARGS__)
+#else
+#define DETECTOR_LOG_INFO(...) DETECTOR_LOG_STRIPPED(info, __VA_ARGS__)
+#endif
+
+#if DETECTOR_LOG_LEVEL <= DETECTOR_LOG_LEVEL_WARN
+#define DETECTOR_LOG_WARN(...) DETECTOR_LOG_LAZY(warn, __VA_ARGS__)
+#else
+#define DETECTOR_LOG_WARN(...) DETECTOR_LOG_STRIPPED(warn, __VA_ARGS__)
+#endif
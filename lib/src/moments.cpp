@@ -3,37 +3,67 @@
 #include <cassert>
 #include <cmath>
 
-static inline SpatialMoment calc_spatial_moment(const Blob& blob, int p, int q)
+namespace {
+
+// Intermediates of central moments need up to about 2^115 for the biggest blobs
+__extension__ typedef __int128 Int128;
+
+/**
+ * @brief Raw moments up to third order, relative to given origin
+ */
+struct RawMoments
 {
-	auto spatial_moment = SpatialMoment{0};
+	Int128 m00, m10, m01, m20, m11, m02, m30, m21, m12, m03;
+};
+
+RawMoments calc_raw_moments(const Blob& blob, Point origin) noexcept
+{
+	auto raw = RawMoments{};
 	for(const auto point : blob)
 	{
-		spatial_moment += (std::pow(point.x, p) * std::pow(point.y, q));
+		// Coordinates relative to a blob point are bounded by blob extent, so products fit in 64 bits
+		const auto x = static_cast<long long>(point.x - origin.x);
+		const auto y = static_cast<long long>(point.y - origin.y);
+		const auto xx = (x * x);
+		const auto yy = (y * y);
+
+		raw.m00 += 1;
+		raw.m10 += x;
+		raw.m01 += y;
+		raw.m20 += xx;
+		raw.m11 += (x * y);
+		raw.m02 += yy;
+		raw.m30 += (xx * x);
+		raw.m21 += (xx * y);
+		raw.m12 += (x * yy);
+		raw.m03 += (yy * y);
 	}
 
-	return spatial_moment;
+	return raw;
 }
 
-static inline CentralMoment calc_central_moment(const Blob& blob, int p, int q, Centroid centroid)
+/**
+ * @brief Returns m00^(1 + order/2), by which central moment of given order is normalized
+ * Only correctly rounded operations are used, so result is the same on every platform.
+ */
+double calc_normalization_divisor(double m00, int order) noexcept
 {
-	auto central_moment = CentralMoment{0};
-	for(const auto point : blob)
+	auto divisor = m00;
+	for(auto i = 0; i < (order / 2); ++i)
 	{
-		const auto px = std::pow(point.x - centroid.x, p);
-		const auto qy = std::pow(point.y - centroid.y, q);
-		central_moment += (px * qy);
+		divisor *= m00;
 	}
 
-	return central_moment;
-}
+	if(order % 2 == 1)
+	{
+		divisor *= std::sqrt(m00);
+	}
 
-static inline NormalizedMoment calc_normalized_moment(CentralMoment muij, int i, int j, SpatialMoment m00)
-{
-	const auto num = muij;
-	const double den = std::pow(m00, 1 + ((i+j) / 2));
-	return (num / den);
+	return divisor;
 }
 
+} // namespace
+
 template<typename T>
 constexpr auto sqr(T t) noexcept
 {
@@ -42,18 +72,25 @@ constexpr auto sqr(T t) noexcept
 
 SpatialMoments calc_spatial_moments(const Blob& blob) noexcept
 {
-	return SpatialMoments {
-		calc_spatial_moment(blob, 0, 0),
-		calc_spatial_moment(blob, 1, 0),
-		calc_spatial_moment(blob, 0, 1),
-		calc_spatial_moment(blob, 2, 0),
-		calc_spatial_moment(blob, 1, 1),
-		calc_spatial_moment(blob, 0, 2),
-		calc_spatial_moment(blob, 3, 0),
-		calc_spatial_moment(blob, 2, 1),
-		calc_spatial_moment(blob, 1, 2),
-		calc_spatial_moment(blob, 0, 3)
-	};
+	auto spatial = SpatialMoments{};
+	for(const auto point : blob)
+	{
+		const auto x = static_cast<SpatialMoment>(point.x);
+		const auto y = static_cast<SpatialMoment>(point.y);
+
+		spatial.m00 += 1;
+		spatial.m10 += x;
+		spatial.m01 += y;
+		spatial.m20 += (x * x);
+		spatial.m11 += (x * y);
+		spatial.m02 += (y * y);
+		spatial.m30 += (x * x * x);
+		spatial.m21 += (x * x * y);
+		spatial.m12 += (x * y * y);
+		spatial.m03 += (y * y * y);
+	}
+
+	return spatial;
 }
 
 Centroid calc_centroid(const SpatialMoments& spatial) noexcept
@@ -64,31 +101,50 @@ Centroid calc_centroid(const SpatialMoments& spatial) noexcept
 	return {centr_x, centr_y};
 }
 
-CentralMoments calc_central_moments(const Blob& blob, Centroid centroid) noexcept
+/**
+ * @brief Calculates central moments exactly, from integer raw moments
+ * Central moments of order k, multiplied by m00^(k-1), are integers. They are calculated in 128-bit
+ *  arithmetic from raw moments relative to the first blob point (central moments do not depend on
+ *  origin), and rounded to double only in the final division.
+ */
+CentralMoments calc_central_moments(const Blob& blob) noexcept
 {
+	if(blob.empty())
+	{
+		return CentralMoments{};
+	}
+
+	const auto [m00, m10, m01, m20, m11, m02, m30, m21, m12, m03] = calc_raw_moments(blob, blob.front());
+	const auto m00_2 = (m00 * m00);
+
+	const auto second = [divisor = static_cast<double>(m00)](Int128 scaled) { return (static_cast<double>(scaled) / divisor); };
+	const auto third = [divisor = static_cast<double>(m00_2)](Int128 scaled) { return (static_cast<double>(scaled) / divisor); };
+
 	return CentralMoments {
-		calc_central_moment(blob, 2, 0, centroid),
-		calc_central_moment(blob, 1, 1, centroid),
-		calc_central_moment(blob, 0, 2, centroid),
-		calc_central_moment(blob, 3, 0, centroid),
-		calc_central_moment(blob, 2, 1, centroid),
-		calc_central_moment(blob, 1, 2, centroid),
-		calc_central_moment(blob, 0, 3, centroid),
+		second(m00*m20 - m10*m10),
+		second(m00*m11 - m10*m01),
+		second(m00*m02 - m01*m01),
+		third(m00_2*m30 - 3*m00*m10*m20 + 2*m10*m10*m10),
+		third(m00_2*m21 - 2*m00*m10*m11 - m00*m01*m20 + 2*m10*m10*m01),
+		third(m00_2*m12 - 2*m00*m01*m11 - m00*m10*m02 + 2*m10*m01*m01),
+		third(m00_2*m03 - 3*m00*m01*m02 + 2*m01*m01*m01),
 	};
 }
 
 NormalizedMoments calc_normalized_moments(const CentralMoments& central_moments, SpatialMoment m00) noexcept
 {
 	const auto [mu20, mu11, mu02, mu30, mu21, mu12, mu03] = central_moments;
+	const auto second = calc_normalization_divisor(static_cast<double>(m00), 2);
+	const auto third = calc_normalization_divisor(static_cast<double>(m00), 3);
 
 	return NormalizedMoments {
-		calc_normalized_moment(mu20, 2, 0, m00),
-		calc_normalized_moment(mu11, 1, 1, m00),
-		calc_normalized_moment(mu02, 0, 2, m00),
-		calc_normalized_moment(mu03, 3, 0, m00),
-		calc_normalized_moment(mu21, 2, 1, m00),
-		calc_normalized_moment(mu12, 1, 2, m00),
-		calc_normalized_moment(mu03, 0, 3, m00),
+		mu20 / second,
+		mu11 / second,
+		mu02 / second,
+		mu30 / third,
+		mu21 / third,
+		mu12 / third,
+		mu03 / third,
 	};
 }
 
@@ -112,10 +168,8 @@ HuMoments calc_hu_moments(const NormalizedMoments& normalized_moments) noexcept
 
 HuMoments calc_blob_hu_moments(const Blob& blob) noexcept
 {
-	const auto spatial_moments = calc_spatial_moments(blob);
-	const auto centroid = calc_centroid(spatial_moments);
-	const auto central_moments = calc_central_moments(blob, centroid);
-	const auto normalized_moments = calc_normalized_moments(central_moments, spatial_moments.m00);
+	const auto central_moments = calc_central_moments(blob);
+	const auto normalized_moments = calc_normalized_moments(central_moments, static_cast<SpatialMoment>(blob.size()));
 
 	return calc_hu_moments(normalized_moments);
 }
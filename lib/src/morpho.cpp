@@ -6,8 +6,6 @@ void dilate(const cv::Mat_<uchar>& src, cv::Mat_<uchar>& dst,
             const cv::Mat_<uchar>& kernel)
 {
 	CV_Assert(src.size() == dst.size());
-	CV_Assert(src.isContinuous());
-	CV_Assert(dst.isContinuous());
 	CV_Assert(kernel.rows % 2 == 1);
 	CV_Assert(kernel.cols % 2 == 1);
 	CV_Assert(kernel.isContinuous());
@@ -24,9 +22,9 @@ void dilate(const cv::Mat_<uchar>& src, cv::Mat_<uchar>& dst,
     const auto anchor_x = (width/2);
     const auto anchor_y = (height/2);
 
-    auto dst_ptr = dst.data;
     for(auto y = 0; y < nrows; ++y)
     {
+        auto dst_ptr = dst.ptr<uchar>(y);
         for(auto x = 0; x < ncols; ++x)
         {
 			auto max_value = std::numeric_limits<uchar>::min();
@@ -71,8 +69,6 @@ void erode(const cv::Mat_<uchar>& src, cv::Mat_<uchar>& dst,
            const cv::Mat_<uchar>& kernel)
 {
 	CV_Assert(src.size() == dst.size());
-	CV_Assert(src.isContinuous());
-	CV_Assert(dst.isContinuous());
 	CV_Assert(kernel.rows % 2 == 1);
 	CV_Assert(kernel.cols % 2 == 1);
 	CV_Assert(kernel.isContinuous());
@@ -89,9 +85,9 @@ void erode(const cv::Mat_<uchar>& src, cv::Mat_<uchar>& dst,
     const auto anchor_x = (width/2);
     const auto anchor_y = (height/2);
 
-    auto dst_ptr = dst.data;
     for(auto y = 0; y < nrows; ++y)
     {
+        auto dst_ptr = dst.ptr<uchar>(y);
         for(auto x = 0; x < ncols; ++x)
         {
 			auto min_value = std::numeric_limits<uchar>::max();
@@ -127,7 +123,6 @@ void erode(const cv::Mat_<uchar>& src, cv::Mat_<uchar>& dst,
                 }
             }
 
-            assert(dst_ptr >= dst.data && dst_ptr < dst.dataend);
             *(dst_ptr++) = min_value;
         }
     }
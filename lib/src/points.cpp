@@ -1,5 +1,14 @@
 #include "points.hpp"
 
+#include <cmath>
+
+double calc_points_distance(Point a, Point b) noexcept
+{
+    const auto dx = (b.x - a.x);
+    const auto dy = (b.y - a.y);
+    return std::sqrt(dx*dx + dy*dy);
+}
+
 Rect calc_bounding_rect(const Points& points)
 {
     auto top_left = points.front();
@@ -65,3 +74,73 @@ void shift_points_set(PointsSet& points_set, const Points& points)
     	shift_points(points, p);
     }
 }
+
+/**
+ * @brief Expands rectangle by margin on each side, clipping it to image bounds
+ */
+Rect expand_rect(Rect rect, int margin, cv::Size bounds)
+{
+    const auto top_left = Point{std::max(rect.x - margin, 0),
+                                std::max(rect.y - margin, 0)};
+    const auto bottom_right = Point{std::min(rect.x + rect.width + margin, bounds.width),
+                                    std::min(rect.y + rect.height + margin, bounds.height)};
+
+    if(bottom_right.x <= top_left.x || bottom_right.y <= top_left.y)
+    {
+        return Rect{};
+    }
+
+    return Rect{top_left, bottom_right};
+}
+
+/**
+ * @brief Maps rectangle from image downsampled by factor to full resolution coordinates
+ */
+Rect scale_rect(Rect rect, int factor)
+{
+    return Rect{rect.x * factor, rect.y * factor, rect.width * factor, rect.height * factor};
+}
+
+Rects scale_rects(Rects rects, int factor)
+{
+    for(auto& rect : rects)
+    {
+        rect = scale_rect(rect, factor);
+    }
+
+    return rects;
+}
+
+/**
+ * @brief Replaces each group of overlapping rectangles with its bounding rectangle
+ * Empty rectangles are dropped. Resulting rectangles do not overlap each other.
+ */
+Rects merge_overlapping_rects(Rects rects)
+{
+    rects.erase(std::remove_if(rects.begin(), rects.end(),
+                               [](const auto& rect) { return rect.empty(); }),
+                rects.end());
+
+    auto merged = true;
+    while(merged)
+    {
+        merged = false;
+        for(auto i = std::size_t{0}; i < rects.size() && !merged; ++i)
+        {
+            for(auto j = (i + 1); j < rects.size(); ++j)
+            {
+                if((rects[i] & rects[j]).empty())
+                {
+                    continue;
+                }
+
+                rects[i] |= rects[j];
+                rects.erase(rects.begin() + j);
+                merged = true;
+                break;
+            }
+        }
+    }
+
+    return rects;
+}
@@ -0,0 +1,86 @@
+#include "presence.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "core.hpp"
+#include "format.hpp"
+
+namespace {
+
+/**
+ * @brief Returns coordinates of grid lines: every step-th one and the last one
+ */
+std::vector<int> make_grid_lines(int length, int step)
+{
+    auto lines = std::vector<int>();
+    lines.reserve((length / step) + 2);
+    for(auto line = 0; line < length; line += step)
+    {
+        lines.push_back(line);
+    }
+
+    if(length > 0 && lines.back() != (length - 1))
+    {
+        lines.push_back(length - 1);
+    }
+
+    return lines;
+}
+
+} // namespace
+
+PrecheckMode parse_precheck_mode(const std::string& name)
+{
+    for(const auto mode : {PrecheckMode::Off, PrecheckMode::Estimate, PrecheckMode::Guarantee})
+    {
+        if(name == get_precheck_mode_name(mode))
+        {
+            return mode;
+        }
+    }
+
+    throw std::invalid_argument("Unknown precheck mode: " + name);
+}
+
+const char* get_precheck_mode_name(PrecheckMode mode) noexcept
+{
+    switch(mode)
+    {
+    case PrecheckMode::Off: return "off";
+    case PrecheckMode::Estimate: return "estimate";
+    case PrecheckMode::Guarantee: return "guarantee";
+    }
+
+    return "unknown";
+}
+
+std::vector<std::size_t> count_grid_colors(const cv::Mat3b& bgr, int step, const cv::Mat1f* kernel,
+                                           const std::vector<ColorRanges>& colors)
+{
+    CV_Assert(step > 0);
+
+    const auto columns = make_grid_lines(bgr.cols, step);
+    auto counts = std::vector<std::size_t>(colors.size(), 0);
+    for(const auto y : make_grid_lines(bgr.rows, step))
+    {
+        const auto row = bgr.ptr<cv::Vec3b>(y);
+        for(const auto x : columns)
+        {
+            const auto pixel = kernel ? filter_pixel(bgr, cv::Point{x, y}, *kernel) : row[x];
+            const auto hsv = bgr2hsv(pixel);
+
+            for(auto i = std::size_t{0}; i < colors.size(); ++i)
+            {
+                const auto& ranges = colors[i];
+                if(std::any_of(ranges.begin(), ranges.end(),
+                               [&hsv](const auto& range) { return color_in_range(hsv, range); }))
+                {
+                    ++counts[i];
+                }
+            }
+        }
+    }
+
+    return counts;
+}
@@ -0,0 +1,177 @@
+#include "rawframes.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include <algorithm>
+#include <fstream>
+#include <system_error>
+
+#include "frame.hpp"
+
+namespace {
+
+constexpr char Magic[8] = {'P', 'L', 'D', 'R', 'A', 'W', '\0', '\0'};
+constexpr auto Version = std::uint32_t{1};
+constexpr auto BytesPerPixel = std::size_t{3};
+
+std::uint64_t align_up(std::uint64_t value)
+{
+    return ((value + RawFramesAlignment - 1) / RawFramesAlignment) * RawFramesAlignment;
+}
+
+void write_padding(std::ofstream& ofs, std::uint64_t size)
+{
+    static const auto zeros = std::vector<char>(RawFramesAlignment, 0);
+    for(; size > 0; size -= std::min<std::uint64_t>(size, zeros.size()))
+    {
+        ofs.write(zeros.data(), std::min<std::uint64_t>(size, zeros.size()));
+    }
+}
+
+} // namespace
+
+void write_raw_frames(const std::string& path, const std::vector<RawFrame>& frames)
+{
+    auto header = RawFramesHeader{};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.pixel_format = RawPixelFormat::Bgr8;
+    for(const auto& frame : frames)
+    {
+        CV_Assert(frame.img.type() == CV_8UC3);
+        header.width = std::max(header.width, static_cast<std::uint32_t>(frame.img.cols));
+        header.height = std::max(header.height, static_cast<std::uint32_t>(frame.img.rows));
+    }
+
+    // Rows are aligned for vectorized kernels, slots for mapping them page by page
+    header.stride = ((header.width * BytesPerPixel + 63) / 64) * 64;
+    header.frames_count = frames.size();
+    header.frames_offset = align_up(sizeof(RawFramesHeader) + frames.size() * sizeof(RawFrameEntry));
+    header.slot_size = align_up(header.stride * header.height);
+
+    auto ofs = std::ofstream(path, std::ios::binary);
+    if(!ofs)
+    {
+        throw std::runtime_error("Could not open raw frames file: " + path);
+    }
+
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for(const auto& frame : frames)
+    {
+        auto entry = RawFrameEntry{};
+        entry.width = static_cast<std::uint32_t>(frame.img.cols);
+        entry.height = static_cast<std::uint32_t>(frame.img.rows);
+        std::strncpy(entry.name, frame.name.c_str(), sizeof(entry.name) - 1);
+        ofs.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    }
+
+    write_padding(ofs, header.frames_offset - sizeof(RawFramesHeader) - frames.size() * sizeof(RawFrameEntry));
+
+    for(const auto& frame : frames)
+    {
+        for(auto y = 0; y < frame.img.rows; ++y)
+        {
+            const auto frame_row_size = (frame.img.cols * BytesPerPixel);
+            ofs.write(reinterpret_cast<const char*>(frame.img.ptr(y)), frame_row_size);
+            write_padding(ofs, header.stride - frame_row_size);
+        }
+
+        write_padding(ofs, header.slot_size - header.stride * frame.img.rows);
+    }
+
+    if(!ofs.flush())
+    {
+        throw std::runtime_error("Could not write raw frames file: " + path);
+    }
+}
+
+RawFramesFile::RawFramesFile(const std::string& path)
+    :   m_data{nullptr}
+    ,   m_length{0}
+    ,   m_header{nullptr}
+{
+    const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "Could not open raw frames file " + path);
+    }
+
+    struct stat status;
+    if(::fstat(fd, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(RawFramesHeader)))
+    {
+        ::close(fd);
+        throw std::runtime_error("Raw frames file too short: " + path);
+    }
+
+    m_length = static_cast<std::size_t>(status.st_size);
+    auto* const data = ::mmap(nullptr, m_length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(data == MAP_FAILED)
+    {
+        throw std::system_error(errno, std::generic_category(), "Could not map raw frames file " + path);
+    }
+
+    m_data = static_cast<const unsigned char*>(data);
+    m_header = reinterpret_cast<const RawFramesHeader*>(m_data);
+
+    // Header fields are not trusted, so sizes are checked by division, without overflowing
+    const auto& header = *m_header;
+    const auto valid = (std::memcmp(header.magic, Magic, sizeof(Magic)) == 0
+        && header.version == Version
+        && header.pixel_format == RawPixelFormat::Bgr8
+        && header.stride >= header.width * BytesPerPixel
+        && (header.height == 0 || header.stride <= header.slot_size / header.height)
+        && header.frames_offset >= sizeof(RawFramesHeader)
+        && header.frames_offset <= m_length
+        && header.frames_offset % RawFramesAlignment == 0
+        && header.frames_count <= (header.frames_offset - sizeof(RawFramesHeader)) / sizeof(RawFrameEntry)
+        && (header.slot_size == 0 || header.frames_count <= (m_length - header.frames_offset) / header.slot_size));
+    if(!valid)
+    {
+        ::munmap(const_cast<unsigned char*>(m_data), m_length);
+        throw std::runtime_error("Invalid raw frames file: " + path);
+    }
+
+    // Frames are usually read in order, once
+    ::madvise(const_cast<unsigned char*>(m_data), m_length, MADV_SEQUENTIAL);
+}
+
+RawFramesFile::~RawFramesFile()
+{
+    ::munmap(const_cast<unsigned char*>(m_data), m_length);
+}
+
+std::size_t RawFramesFile::size() const noexcept
+{
+    return static_cast<std::size_t>(m_header->frames_count);
+}
+
+cv::Mat RawFramesFile::frame(std::size_t index) const
+{
+    const auto& frame_entry = entry(index);
+    const auto* const slot = (m_data + m_header->frames_offset + index * m_header->slot_size);
+    const auto size = cv::Size{static_cast<int>(frame_entry.width), static_cast<int>(frame_entry.height)};
+    return wrap_bgr_frame(slot, size, m_header->stride);
+}
+
+std::string RawFramesFile::frame_name(std::size_t index) const
+{
+    const auto& frame_entry = entry(index);
+    return std::string(frame_entry.name, strnlen(frame_entry.name, sizeof(frame_entry.name)));
+}
+
+const RawFrameEntry& RawFramesFile::entry(std::size_t index) const
+{
+    CV_Assert(index < size());
+
+    const auto* const entries = reinterpret_cast<const RawFrameEntry*>(m_data + sizeof(RawFramesHeader));
+    const auto& frame_entry = entries[index];
+    CV_Assert(frame_entry.width <= m_header->width && frame_entry.height <= m_header->height);
+    return frame_entry;
+}
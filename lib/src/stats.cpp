@@ -0,0 +1,103 @@
+#include "stats.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numeric>
+
+namespace {
+
+TimeSummary summarize_times(std::vector<StageTime> times)
+{
+    if(times.empty())
+    {
+        return TimeSummary{};
+    }
+
+    std::sort(times.begin(), times.end());
+
+    // Nearest-rank percentile
+    const auto p99_rank = static_cast<std::size_t>(std::ceil(0.99 * times.size()));
+    assert(p99_rank >= 1 && p99_rank <= times.size());
+
+    const auto total = std::accumulate(times.begin(), times.end(), StageTime{0});
+    return TimeSummary{
+        times.front(),
+        (total / static_cast<StageTime::rep>(times.size())),
+        times[p99_rank - 1]
+    };
+}
+
+void add_funnel(BlobsFunnel& sum, const BlobsFunnel& funnel) noexcept
+{
+    sum.found += funnel.found;
+    sum.after_area_filter += funnel.after_area_filter;
+    sum.after_hu_filter += funnel.after_hu_filter;
+}
+
+} // namespace
+
+const char* get_stage_name(Stage stage) noexcept
+{
+    switch(stage)
+    {
+        case Stage::Enhance: return "enhance";
+        case Stage::Convert: return "convert";
+        case Stage::Threshold: return "threshold";
+        case Stage::Morphology: return "morphology";
+        case Stage::Labelling: return "labelling";
+        case Stage::Moments: return "moments";
+        case Stage::Matching: return "matching";
+    }
+
+    return "unknown";
+}
+
+void DetectionStatsAggregator::add(const DetectionStats& stats)
+{
+    for(auto i = std::size_t{0}; i < StagesMax; ++i)
+    {
+        m_stages_times[i].push_back(stats.stages_times[i]);
+        m_sum.stages_times[i] += stats.stages_times[i];
+    }
+
+    m_total_times.push_back(stats.total_time);
+    m_sum.total_time += stats.total_time;
+
+    add_funnel(m_sum.blue_blobs, stats.blue_blobs);
+    add_funnel(m_sum.red_blobs, stats.red_blobs);
+    m_sum.pairs_tested += stats.pairs_tested;
+    m_sum.logos_found += stats.logos_found;
+    m_sum.cascade_exits.after_blue += stats.cascade_exits.after_blue;
+    m_sum.cascade_exits.after_red += stats.cascade_exits.after_red;
+    m_sum.part_windows.runs += stats.part_windows.runs;
+    m_sum.part_windows.windows += stats.part_windows.windows;
+    m_sum.part_windows.pixels += stats.part_windows.pixels;
+    m_sum.part_windows.frame_pixels += stats.part_windows.frame_pixels;
+    m_sum.part_windows.fallbacks += stats.part_windows.fallbacks;
+    m_sum.precheck.runs += stats.precheck.runs;
+    m_sum.precheck.rejections += stats.precheck.rejections;
+    m_sum.coarse.runs += stats.coarse.runs;
+    m_sum.coarse.regions += stats.coarse.regions;
+    m_sum.coarse.time += stats.coarse.time;
+}
+
+std::size_t DetectionStatsAggregator::count() const noexcept
+{
+    return m_total_times.size();
+}
+
+TimeSummary DetectionStatsAggregator::summarize_stage(Stage stage) const
+{
+    return summarize_times(m_stages_times[static_cast<std::size_t>(stage)]);
+}
+
+TimeSummary DetectionStatsAggregator::summarize_total() const
+{
+    return summarize_times(m_total_times);
+}
+
+DetectionStats DetectionStatsAggregator::sum() const
+{
+    return m_sum;
+}
@@ -0,0 +1,157 @@
+#include "trace.hpp"
+
+#include <cstdint>
+
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace trace {
+
+namespace {
+
+constexpr auto InitialEventsCapacity = std::size_t{4096};
+
+struct Event
+{
+	const char* name;
+	Clock::time_point start;
+	Clock::time_point end;
+};
+
+/**
+ * @brief Events of single thread. Only that thread appends to it
+ */
+struct ThreadBuffer
+{
+	int tid;
+	int generation;
+	const char* name;
+	std::vector<Event> events;
+};
+
+std::atomic<bool> g_enabled{false};
+std::atomic<int> g_generation{0};
+Clock::time_point g_start;
+
+// Guards only registration of threads buffers and writing, not recording
+std::mutex g_mutex;
+std::vector<std::shared_ptr<ThreadBuffer>> g_buffers;
+
+thread_local std::shared_ptr<ThreadBuffer> t_buffer;
+thread_local const char* t_name = nullptr;
+
+ThreadBuffer& get_thread_buffer()
+{
+	const auto generation = g_generation.load(std::memory_order_acquire);
+	if(!t_buffer || t_buffer->generation != generation)
+	{
+		auto buffer = std::make_shared<ThreadBuffer>();
+		buffer->generation = generation;
+		buffer->name = t_name;
+		buffer->events.reserve(InitialEventsCapacity);
+
+		const auto lock = std::lock_guard<std::mutex>(g_mutex);
+		buffer->tid = static_cast<int>(g_buffers.size()) + 1;
+		g_buffers.push_back(buffer);
+		t_buffer = std::move(buffer);
+	}
+
+	return *t_buffer;
+}
+
+double to_microseconds(Clock::duration duration)
+{
+	return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+} // namespace
+
+void enable()
+{
+	const auto lock = std::lock_guard<std::mutex>(g_mutex);
+	g_buffers.clear();
+	g_start = Clock::now();
+	g_generation.fetch_add(1, std::memory_order_release);
+	g_enabled.store(true, std::memory_order_release);
+}
+
+void disable() noexcept
+{
+	g_enabled.store(false, std::memory_order_release);
+}
+
+bool enabled() noexcept
+{
+	return g_enabled.load(std::memory_order_relaxed);
+}
+
+void set_thread_name(const char* name) noexcept
+{
+	t_name = name;
+	if(t_buffer)
+	{
+		t_buffer->name = name;
+	}
+}
+
+void record(const char* name, Clock::time_point start)
+{
+	const auto end = Clock::now();
+	get_thread_buffer().events.push_back(Event{name, start, end});
+}
+
+void write(const std::string& dst_file)
+{
+	auto ofs = std::ofstream(dst_file);
+	if(!ofs)
+	{
+		throw std::runtime_error("Could not open trace file");
+	}
+
+	const auto lock = std::lock_guard<std::mutex>(g_mutex);
+	const auto pid = 1;
+
+	ofs << std::fixed << std::setprecision(3);
+	ofs << "{\"traceEvents\":[\n";
+	auto first = true;
+	const auto separate = [&ofs, &first]() {
+		if(!first)
+		{
+			ofs << ",\n";
+		}
+		first = false;
+	};
+
+	for(const auto& buffer : g_buffers)
+	{
+		if(buffer->name)
+		{
+			separate();
+			ofs << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+				<< ",\"tid\":" << buffer->tid
+				<< ",\"args\":{\"name\":\"" << buffer->name << "\"}}";
+		}
+
+		for(const auto& event : buffer->events)
+		{
+			separate();
+			ofs << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":" << pid
+				<< ",\"tid\":" << buffer->tid
+				<< ",\"ts\":" << to_microseconds(event.start - g_start)
+				<< ",\"dur\":" << to_microseconds(event.end - event.start) << "}";
+		}
+	}
+
+	ofs << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	if(!ofs)
+	{
+		throw std::runtime_error("Could not write trace file");
+	}
+}
+
+} // namespace trace
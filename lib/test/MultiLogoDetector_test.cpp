@@ -0,0 +1,116 @@
+#include <catch2/catch.hpp>
+
+#include <opencv2/opencv.hpp>
+#include <nlohmann/json.hpp>
+
+#include "MultiLogoDetector.hpp"
+#include "test_support.hpp"
+
+namespace {
+
+const auto IMAGES_FILES = std::vector<const char*>{
+    "assets/camera/0.jpg",
+    "assets/camera/4.jpg",
+    "assets/camera/9.jpg",
+};
+
+/**
+ * @brief Returns definitions of Pepsi logo from camera config, in the form read from JSON
+ */
+nlohmann::json make_logos_json(const nlohmann::json& camera_json)
+{
+    const auto make_part = [&camera_json](const char* color, double max_center_distance)
+        {
+            const auto prefix = std::string(color) + "_blob_";
+            return nlohmann::json{
+                {"color", color},
+                {"area_range", camera_json.at(prefix + "area_range")},
+                {"hu0_range", camera_json.at(prefix + "hu0_range")},
+                {"hu1_range", camera_json.at(prefix + "hu1_range")},
+                {"max_center_distance", max_center_distance},
+            };
+        };
+
+    const auto distance = camera_json.at("max_blobs_centers_distance").get<double>();
+    return nlohmann::json{
+        {"colors", {
+            {"blue", camera_json.at("blue_range")},
+            {"red", camera_json.at("red_range")},
+        }},
+        {"logos", {
+            {{"name", "pepsi"}, {"parts", {make_part("red", 0.0), make_part("blue", distance)}}},
+            {{"name", "pepsi_blue_first"}, {"parts", {make_part("blue", 0.0), make_part("red", distance)}}},
+        }},
+    };
+}
+
+} //
+
+SCENARIO("Many logos can be found sharing colour blobs", "[MultiLogoDetector]")
+{
+    const auto camera_json = read_json_file("assets/camera/config.json");
+    const auto pepsi_detector = PepsiDetector{PepsiDetector::Config::from_json(camera_json)};
+
+    GIVEN("Detector made from Pepsi config")
+    {
+        const auto detector = MultiLogoDetector{MultiLogoDetector::Config::from_pepsi(pepsi_detector.config())};
+
+        THEN("Same logos as with PepsiDetector should be found")
+        {
+            for(const auto file_name : IMAGES_FILES)
+            {
+                const auto image = cv::imread(file_name, cv::IMREAD_COLOR);
+                REQUIRE(!image.empty());
+                REQUIRE(detector.find_logos(image) == pepsi_detector.find_logos(image));
+            }
+        }
+    }
+
+    GIVEN("Detector with two definitions of the same logo, read from JSON")
+    {
+        const auto config = MultiLogoDetector::Config::from_json(make_logos_json(camera_json));
+        const auto detector = MultiLogoDetector{config};
+
+        REQUIRE(config.colors.size() == 2);
+        REQUIRE(config.logos.size() == 2);
+
+        WHEN("Finding detections on image with logos")
+        {
+            const auto image = cv::imread("assets/camera/0.jpg", cv::IMREAD_COLOR);
+            const auto detections = detector.find_detections(image);
+            const auto expected = pepsi_detector.find_detections(image);
+
+            THEN("Each logo should be found by both definitions, with parts in their order")
+            {
+                REQUIRE(!expected.empty());
+                REQUIRE(detections.size() == 2 * expected.size());
+
+                for(auto i = std::size_t{0}; i < expected.size(); ++i)
+                {
+                    const auto& red_first = detections[i];
+                    REQUIRE(red_first.logo_index == 0);
+                    REQUIRE(red_first.logo == expected[i].logo);
+                    REQUIRE(red_first.parts.size() == 2);
+                    REQUIRE(red_first.parts[0].rect == expected[i].red.rect);
+                    REQUIRE(red_first.parts[1].area == expected[i].blue.area);
+                }
+
+                for(auto i = expected.size(); i < detections.size(); ++i)
+                {
+                    REQUIRE(detections[i].logo_index == 1);
+                }
+            }
+        }
+    }
+
+    GIVEN("Config with part of undefined colour")
+    {
+        auto json = make_logos_json(camera_json);
+        json["logos"][0]["parts"][0]["color"] = "green";
+
+        THEN("Config should be rejected")
+        {
+            REQUIRE_THROWS_AS(MultiLogoDetector::Config::from_json(json), std::invalid_argument);
+        }
+    }
+}
@@ -1,11 +1,14 @@
 #include <catch2/catch.hpp>
 
-#include <fstream>
+#include <algorithm>
+#include <cstring>
+
+#include <tuple>
 
 #include <opencv2/opencv.hpp>
-#include <nlohmann/json.hpp>
 
 #include "PepsiDetector.hpp"
+#include "test_support.hpp"
 
 namespace {
 
@@ -51,6 +54,23 @@ LogosArray find_logos_on_images(const Images& images, const PepsiDetector& detec
     return logos_array;
 }
 
+/**
+ * @brief Sorts logos in raster order of their top left corners, for comparing logos found in different order
+ */
+LogosArray sort_logos(LogosArray logos_array)
+{
+    for(auto& logos : logos_array)
+    {
+        std::sort(logos.begin(), logos.end(),
+                  [](const auto& a, const auto& b)
+                  {
+                      return (std::tie(a.y, a.x, a.width, a.height) < std::tie(b.y, b.x, b.width, b.height));
+                  });
+    }
+
+    return logos_array;
+}
+
 bool logos_matching(const Logo& found_logo, const Logo& real_logo)
 {
     const auto dx = (real_logo.x - found_logo.x);
@@ -66,23 +86,6 @@ bool logos_matching(const Logo& found_logo, const Logo& real_logo)
     return false;
 }
 
-PepsiDetector::Config read_config(const char* path)
-{
-    std::ifstream ifs(path);
-    if(!ifs)
-    {
-        throw std::runtime_error("Could not open config JSON file");
-    }
-
-    nlohmann::json json;
-    if(!(ifs >> json))
-    {
-        throw std::runtime_error("Could not read config JSON file");
-    }
-
-    return PepsiDetector::Config::from_json(json);
-}
-
 void debug_logos(const Logos& logos)
 {
     for(const auto& logo : logos)
@@ -161,3 +164,405 @@ SCENARIO("Pepsi logos can be found on color image", "[PepsiDetector]")
         }
     }
 }
+
+SCENARIO("Detector config can be scaled for resized images", "[PepsiDetector]")
+{
+    const auto config = read_config("assets/camera/config.json");
+
+    GIVEN("Config for full resolution images")
+    {
+        WHEN("Scaling it by half")
+        {
+            const auto scaled = config.scaled(0.5);
+
+            THEN("Blob areas should be scaled by square of factor")
+            {
+                REQUIRE(scaled.blue_blob_area_range.min == config.blue_blob_area_range.min / 4);
+                REQUIRE(scaled.blue_blob_area_range.max == config.blue_blob_area_range.max / 4);
+                REQUIRE(scaled.red_blob_area_range.min == config.red_blob_area_range.min / 4);
+                REQUIRE(scaled.red_blob_area_range.max == config.red_blob_area_range.max / 4);
+            }
+
+            THEN("Blobs centers distance should be scaled linearly")
+            {
+                REQUIRE(scaled.max_blobs_centers_distance == Approx(config.max_blobs_centers_distance / 2));
+            }
+
+            THEN("Hu moments ranges should be left unchanged")
+            {
+                REQUIRE(scaled.blue_blob_hu0_range.min == config.blue_blob_hu0_range.min);
+                REQUIRE(scaled.red_blob_hu1_range.max == config.red_blob_hu1_range.max);
+            }
+        }
+    }
+}
+
+SCENARIO("Pyramid mode falls back to full resolution for small blobs", "[PepsiDetector]")
+{
+    // Camera config accepts blobs too small to be resolved after downsampling
+    auto config = read_config("assets/camera/config.json");
+    const auto detector = PepsiDetector{config};
+
+    config.pyramid = true;
+    const auto pyramid_detector = PepsiDetector{config};
+
+    GIVEN("Images from phone camera")
+    {
+        const auto images = read_images(IMAGES_FILES);
+
+        WHEN("Finding logos in pyramid mode")
+        {
+            const auto logos_array = find_logos_on_images(images, pyramid_detector);
+
+            THEN("Same logos as in normal mode should be found")
+            {
+                REQUIRE(logos_array == find_logos_on_images(images, detector));
+            }
+        }
+    }
+}
+
+SCENARIO("Pyramid mode finds candidate regions at coarse level", "[PepsiDetector]")
+{
+    // Net config accepts only blobs large enough to be found after downsampling twice
+    auto config = read_config("assets/net/config.json");
+    const auto detector = PepsiDetector{config};
+
+    config.pyramid = true;
+    const auto pyramid_detector = PepsiDetector{config};
+
+    GIVEN("Images from the Internet")
+    {
+        const auto images = read_images({"assets/net/0.jpg", "assets/net/1.jpg", "assets/net/2.jpg"});
+
+        WHEN("Finding logos in pyramid mode")
+        {
+            auto stats_array = std::vector<DetectionStats>(images.size());
+            auto logos_array = LogosArray();
+            for(auto i = std::size_t{0}; i < images.size(); ++i)
+            {
+                logos_array.push_back(pyramid_detector.find_logos(images[i], stats_array[i]));
+            }
+
+            THEN("Same logos as in normal mode should be found, in order of candidate regions")
+            {
+                REQUIRE(sort_logos(logos_array) == sort_logos(find_logos_on_images(images, detector)));
+            }
+
+            THEN("Coarse pass should be run on each image, with its stats kept apart from full resolution ones")
+            {
+                for(auto i = std::size_t{0}; i < images.size(); ++i)
+                {
+                    const auto& stats = stats_array[i];
+                    REQUIRE(stats.coarse.runs == 1);
+                    REQUIRE((logos_array[i].empty() || stats.coarse.regions > 0));
+                    REQUIRE(stats.coarse.time > StageTime{0});
+                    REQUIRE(stats.logos_found == logos_array[i].size());
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Pepsi logos can be found only inside regions of interest", "[PepsiDetector]")
+{
+    const auto config = read_config("assets/camera/config.json");
+    const auto detector = PepsiDetector{config};
+
+    GIVEN("Image with logos")
+    {
+        const auto image = read_image("assets/camera/0.jpg");
+        const auto& real_logos = REAL_LOGOS_ARRAY[0];
+
+        WHEN("Finding logos in region around the first logo")
+        {
+            const auto roi = Rect{real_logos[0].x - 20, real_logos[0].y - 20,
+                                  real_logos[0].width + 40, real_logos[0].height + 40};
+            const auto logos = detector.find_logos(image, Rects{roi});
+
+            THEN("Only that logo should be found, in whole image coordinates")
+            {
+                REQUIRE(logos.size() == 1);
+                REQUIRE(logos_matching(logos[0], real_logos[0]));
+            }
+        }
+
+        WHEN("Finding logos in overlapping regions")
+        {
+            const auto roi = Rect{0, 0, image.cols, image.rows};
+            const auto logos = detector.find_logos(image, Rects{roi, roi});
+
+            THEN("Each logo should be found once")
+            {
+                REQUIRE(logos.size() == real_logos.size());
+            }
+        }
+
+        WHEN("Finding logos in region outside the image")
+        {
+            const auto roi = Rect{image.cols, image.rows, 100, 100};
+            const auto logos = detector.find_logos(image, Rects{roi});
+
+            THEN("No logo should be found")
+            {
+                REQUIRE(logos.empty());
+            }
+        }
+    }
+}
+
+SCENARIO("Pepsi logos can be found in caller-owned buffers with padded rows", "[PepsiDetector]")
+{
+    const auto config = read_config("assets/camera/config.json");
+    const auto detector = PepsiDetector{config};
+
+    GIVEN("Image copied to buffer with 64-byte aligned rows")
+    {
+        const auto image = read_image("assets/camera/0.jpg");
+        const auto row_size = static_cast<std::size_t>(3 * image.cols);
+        const auto stride = ((row_size + 63) / 64) * 64 + 64;
+
+        auto buffer = std::vector<uchar>(stride * image.rows, 0);
+        for(auto y = 0; y < image.rows; ++y)
+        {
+            std::memcpy(&buffer[y * stride], image.ptr(y), row_size);
+        }
+
+        WHEN("Finding logos in buffer")
+        {
+            const auto logos = detector.find_logos(buffer.data(), image.size(), stride);
+
+            THEN("Same logos as in continuous image should be found")
+            {
+                REQUIRE(logos == detector.find_logos(image));
+            }
+        }
+    }
+}
+
+SCENARIO("Statistics of detection can be collected", "[PepsiDetector]")
+{
+    const auto config = read_config("assets/camera/config.json");
+    const auto detector = PepsiDetector{config};
+
+    GIVEN("Image from phone camera")
+    {
+        const auto image = read_image("assets/camera/9.jpg");
+
+        WHEN("Finding logos with statistics")
+        {
+            auto stats = DetectionStats{};
+            const auto logos = detector.find_logos(image, stats);
+
+            THEN("Logos should be the same as without statistics")
+            {
+                REQUIRE(logos == detector.find_logos(image));
+                REQUIRE(stats.logos_found == logos.size());
+            }
+
+            THEN("Blobs should only be rejected by consecutive filters")
+            {
+                for(const auto& funnel : {stats.blue_blobs, stats.red_blobs})
+                {
+                    REQUIRE(funnel.after_area_filter <= funnel.found);
+                    REQUIRE(funnel.after_hu_filter <= funnel.after_area_filter);
+                    REQUIRE(funnel.after_hu_filter >= logos.size());
+                }
+
+                REQUIRE(stats.pairs_tested == stats.blue_blobs.after_hu_filter * stats.red_blobs.after_hu_filter);
+            }
+
+            THEN("Stages times should not exceed total time")
+            {
+                auto stages_time = StageTime{0};
+                for(const auto stage_time : stats.stages_times)
+                {
+                    stages_time += stage_time;
+                }
+
+                REQUIRE(stats.total_time > StageTime{0});
+                REQUIRE(stages_time <= stats.total_time);
+            }
+        }
+    }
+}
+
+SCENARIO("Detection stops early, when colour branch leaves no candidates", "[PepsiDetector]")
+{
+    const auto config = read_config("assets/camera/config.json");
+    const auto detector = PepsiDetector{config};
+
+    GIVEN("Image without any blue or red")
+    {
+        const auto image = cv::Mat(480, 640, CV_8UC3, cv::Scalar{40, 200, 40});
+
+        WHEN("Finding logos with statistics many times")
+        {
+            auto aggregator = DetectionStatsAggregator{};
+            for(auto i = 0; i < 40; ++i)
+            {
+                auto stats = DetectionStats{};
+                REQUIRE(detector.find_logos(image, stats).empty());
+                aggregator.add(stats);
+            }
+
+            THEN("Each call should stop after its first branch, without matching")
+            {
+                const auto sum = aggregator.sum();
+                REQUIRE(sum.cascade_exits.after_blue + sum.cascade_exits.after_red == 40);
+                REQUIRE(sum.blue_blobs.found == 0);
+                REQUIRE(sum.red_blobs.found == 0);
+                REQUIRE(sum.pairs_tested == 0);
+                REQUIRE(sum.stage_time(Stage::Matching) == StageTime{0});
+            }
+        }
+    }
+
+    GIVEN("Image with logos")
+    {
+        const auto image = read_image("assets/camera/0.jpg");
+
+        WHEN("Finding logos with statistics many times")
+        {
+            THEN("Both branches should be run and logos should not depend on their order")
+            {
+                const auto expected = detector.find_logos(image);
+                REQUIRE(!expected.empty());
+
+                for(auto i = 0; i < 40; ++i)
+                {
+                    auto stats = DetectionStats{};
+                    REQUIRE(detector.find_logos(image, stats) == expected);
+                    REQUIRE(stats.cascade_exits.after_blue == 0);
+                    REQUIRE(stats.cascade_exits.after_red == 0);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Second colour part is looked for only near candidates of the first one", "[PepsiDetector]")
+{
+    auto config = read_config("assets/camera/config.json");
+    const auto detector = PepsiDetector{config};
+
+    config.part_windows = false;
+    const auto whole_image_detector = PepsiDetector{config};
+
+    GIVEN("Images from phone camera")
+    {
+        const auto images = read_images(IMAGES_FILES);
+
+        WHEN("Finding logos with and without part windows")
+        {
+            const auto logos_array = find_logos_on_images(images, detector);
+
+            THEN("Same logos should be found")
+            {
+                REQUIRE(logos_array == find_logos_on_images(images, whole_image_detector));
+            }
+        }
+    }
+
+    GIVEN("Image with logos")
+    {
+        const auto image = read_image("assets/camera/0.jpg");
+
+        WHEN("Finding logos with statistics")
+        {
+            auto stats = DetectionStats{};
+            const auto logos = detector.find_logos(image, stats);
+
+            THEN("Second part should be looked for once, in part of the image at most")
+            {
+                REQUIRE(!logos.empty());
+                REQUIRE(stats.part_windows.runs == 1);
+                REQUIRE(stats.part_windows.frame_pixels == image.total());
+                REQUIRE(stats.part_windows.pixels <= stats.part_windows.frame_pixels);
+                REQUIRE((stats.part_windows.windows > 0 || stats.part_windows.fallbacks == 1));
+            }
+        }
+    }
+}
+
+SCENARIO("Images without enough blue or red pixels are rejected before processing", "[PepsiDetector]")
+{
+    auto config = read_config("assets/camera/config.json");
+    const auto detector = PepsiDetector{config};
+
+    config.precheck = PrecheckMode::Guarantee;
+    const auto guarantee_detector = PepsiDetector{config};
+
+    config.precheck = PrecheckMode::Estimate;
+    const auto estimate_detector = PepsiDetector{config};
+
+    GIVEN("Images from phone camera")
+    {
+        const auto images = read_images(IMAGES_FILES);
+
+        WHEN("Finding logos with precheck in guarantee mode")
+        {
+            const auto logos_array = find_logos_on_images(images, guarantee_detector);
+
+            THEN("Same logos as without precheck should be found")
+            {
+                REQUIRE(logos_array == find_logos_on_images(images, detector));
+            }
+        }
+    }
+
+    GIVEN("Image without any blue or red")
+    {
+        const auto image = cv::Mat(480, 640, CV_8UC3, cv::Scalar{40, 200, 40});
+
+        WHEN("Finding logos with statistics, with precheck in both modes")
+        {
+            for(const auto* checked_detector : {&guarantee_detector, &estimate_detector})
+            {
+                auto stats = DetectionStats{};
+                REQUIRE(checked_detector->find_logos(image, stats).empty());
+
+                // Image should be rejected before enhancement
+                REQUIRE(stats.precheck.runs == 1);
+                REQUIRE(stats.precheck.rejections == 1);
+                REQUIRE(stats.stage_time(Stage::Enhance) == StageTime{0});
+            }
+        }
+    }
+}
+
+SCENARIO("Pepsi logos can be found with their parts", "[PepsiDetector]")
+{
+    const auto config = read_config("assets/camera/config.json");
+    const auto detector = PepsiDetector{config};
+
+    GIVEN("Image from phone camera")
+    {
+        const auto image = read_image("assets/camera/0.jpg");
+
+        WHEN("Finding detections")
+        {
+            const auto detections = detector.find_detections(image);
+
+            THEN("Logos should be the same as found alone")
+            {
+                REQUIRE(!detections.empty());
+                REQUIRE(to_logos(detections) == detector.find_logos(image));
+            }
+
+            THEN("Parts should lie inside their logos and have accepted areas")
+            {
+                for(const auto& detection : detections)
+                {
+                    REQUIRE((detection.blue.rect & detection.logo) == detection.blue.rect);
+                    REQUIRE((detection.red.rect & detection.logo) == detection.red.rect);
+
+                    REQUIRE(detection.blue.area >= config.blue_blob_area_range.min);
+                    REQUIRE(detection.blue.area <= config.blue_blob_area_range.max);
+                    REQUIRE(detection.red.area >= config.red_blob_area_range.min);
+                    REQUIRE(detection.red.area <= config.red_blob_area_range.max);
+                }
+            }
+        }
+    }
+}
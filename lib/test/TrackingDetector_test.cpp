@@ -0,0 +1,94 @@
+#include <catch2/catch.hpp>
+
+#include <opencv2/opencv.hpp>
+
+#include "TrackingDetector.hpp"
+#include "test_support.hpp"
+
+SCENARIO("Pepsi logos can be tracked between video frames", "[TrackingDetector]")
+{
+    const auto config = read_config("assets/camera/config.json");
+    const auto detector = PepsiDetector{config};
+
+    auto tracking_config = TrackingDetector::Config{};
+    tracking_config.keyframe_interval = 3;
+    auto tracker = TrackingDetector{detector, tracking_config};
+
+    GIVEN("Static sequence of frames with logos")
+    {
+        const auto frame = cv::imread("assets/camera/0.jpg", cv::IMREAD_COLOR);
+        REQUIRE(!frame.empty());
+
+        const auto expected_logos = detector.find_logos(frame);
+        REQUIRE(!expected_logos.empty());
+
+        WHEN("Processing first frame")
+        {
+            const auto logos = tracker.find_logos(frame);
+            const auto& stats = tracker.last_frame_stats();
+
+            THEN("Full frame should be processed")
+            {
+                REQUIRE(stats.keyframe);
+                REQUIRE(stats.processed_pixels == frame.total());
+                REQUIRE(stats.total_pixels == frame.total());
+            }
+
+            THEN("Same logos as with plain detector should be found")
+            {
+                REQUIRE(logos == expected_logos);
+            }
+        }
+
+        WHEN("Processing next frame")
+        {
+            tracker.find_logos(frame);
+            const auto logos = tracker.find_logos(frame);
+            const auto& stats = tracker.last_frame_stats();
+
+            THEN("Only regions around tracked logos should be processed")
+            {
+                REQUIRE(!stats.keyframe);
+                REQUIRE(stats.processed_pixels < frame.total());
+            }
+
+            THEN("All tracked logos should be found again")
+            {
+                REQUIRE(logos.size() == expected_logos.size());
+            }
+        }
+
+        WHEN("Processing frames up to keyframe interval")
+        {
+            for(auto i = 0; i < tracking_config.keyframe_interval; ++i)
+            {
+                tracker.find_logos(frame);
+            }
+
+            tracker.find_logos(frame);
+
+            THEN("Full frame detection should be run again")
+            {
+                REQUIRE(tracker.last_frame_stats().keyframe);
+            }
+        }
+    }
+
+    GIVEN("Frame without logos after frame with logos")
+    {
+        const auto frame = cv::imread("assets/camera/0.jpg", cv::IMREAD_COLOR);
+        const cv::Mat empty_frame = cv::Mat::zeros(frame.size(), frame.type());
+
+        WHEN("Tracked logos are lost")
+        {
+            tracker.find_logos(frame);
+            const auto logos = tracker.find_logos(empty_frame);
+
+            THEN("Full frame detection should be run")
+            {
+                REQUIRE(logos.empty());
+                REQUIRE(tracker.last_frame_stats().keyframe);
+            }
+        }
+    }
+}
@@ -0,0 +1,152 @@
+#include "alloc_counter.hpp"
+
+#include <cstdlib>
+
+#include <new>
+
+#include <opencv2/opencv.hpp>
+
+// Replaced global allocation functions are defined in this file, so they are
+//  linked in together with AllocationScope by everyone who uses it.
+
+namespace {
+
+// Trivial type, so no dynamic TLS initialization is needed inside operator new
+thread_local AllocationStats t_stats;
+
+#if CV_VERSION_MAJOR >= 4
+using AccessFlags = cv::AccessFlag;
+#else
+using AccessFlags = int;
+#endif
+
+void count_allocation(std::size_t size) noexcept
+{
+    ++t_stats.count;
+    t_stats.bytes += size;
+}
+
+void* allocate(std::size_t size) noexcept
+{
+    count_allocation(size);
+    return std::malloc(size ? size : 1);
+}
+
+void* allocate_aligned(std::size_t size, std::align_val_t alignment) noexcept
+{
+    count_allocation(size);
+
+    // aligned_alloc requires size to be a multiple of alignment
+    const auto align = static_cast<std::size_t>(alignment);
+    const auto aligned_size = ((size + align - 1) / align) * align;
+    return std::aligned_alloc(align, aligned_size ? aligned_size : align);
+}
+
+void* allocate_or_throw(std::size_t size)
+{
+    if(auto ptr = allocate(size))
+    {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void* allocate_aligned_or_throw(std::size_t size, std::align_val_t alignment)
+{
+    if(auto ptr = allocate_aligned(size, alignment))
+    {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+/**
+ * @brief cv::Mat allocator, which counts buffers allocated by the default one
+ * OpenCV allocates matrices data with fastMalloc, so they are not seen by operator new.
+ */
+class CountingMatAllocator
+    :   public cv::MatAllocator
+{
+public:
+    explicit CountingMatAllocator(cv::MatAllocator* allocator)
+        :   m_allocator(allocator)
+    {}
+
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           AccessFlags flags, cv::UMatUsageFlags usage) const override
+    {
+        auto u = m_allocator->allocate(dims, sizes, type, data, step, flags, usage);
+        if(u && !data)
+        {
+            count_allocation(u->size);
+        }
+
+        return u;
+    }
+
+    bool allocate(cv::UMatData* data, AccessFlags flags, cv::UMatUsageFlags usage) const override
+    {
+        return m_allocator->allocate(data, flags, usage);
+    }
+
+    void deallocate(cv::UMatData* data) const override
+    {
+        m_allocator->deallocate(data);
+    }
+
+private:
+    cv::MatAllocator* m_allocator;
+};
+
+void install_mat_allocator_hook()
+{
+    // Never destroyed, as matrices may outlive any static object
+    static const auto hook = new CountingMatAllocator(cv::Mat::getStdAllocator());
+    if(cv::Mat::getDefaultAllocator() != hook)
+    {
+        cv::Mat::setDefaultAllocator(hook);
+    }
+}
+
+} // namespace
+
+AllocationStats get_thread_allocation_stats() noexcept
+{
+    return t_stats;
+}
+
+AllocationScope::AllocationScope()
+{
+    install_mat_allocator_hook();
+    m_start = get_thread_allocation_stats();
+}
+
+AllocationStats AllocationScope::stats() const noexcept
+{
+    const auto now = get_thread_allocation_stats();
+    return AllocationStats{now.count - m_start.count, now.bytes - m_start.bytes};
+}
+
+// Replaced global allocation functions
+
+void* operator new(std::size_t size) { return allocate_or_throw(size); }
+void* operator new[](std::size_t size) { return allocate_or_throw(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocate_aligned_or_throw(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocate_aligned_or_throw(size, alignment); }
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @brief Numbers of heap allocations and allocated bytes
+ * Both operator new and cv::Mat buffers (which bypass it) are counted.
+ */
+struct AllocationStats
+{
+	std::size_t count = 0;
+	std::size_t bytes = 0;
+};
+
+/**
+ * @brief Returns numbers of allocations made by calling thread since its start
+ */
+AllocationStats get_thread_allocation_stats() noexcept;
+
+/**
+ * @brief Counts allocations made by calling thread during its lifetime
+ * Usage:
+ *  const auto scope = AllocationScope{};
+ *  detector.find_logos(img);
+ *  REQUIRE(scope.stats().count == 0);
+ */
+class AllocationScope
+{
+public:
+	AllocationScope();
+
+	AllocationStats stats() const noexcept;
+
+private:
+	AllocationStats m_start;
+};
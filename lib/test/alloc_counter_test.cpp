@@ -0,0 +1,120 @@
+#include <catch2/catch.hpp>
+
+#include <memory>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "alloc_counter.hpp"
+#include "PepsiDetector.hpp"
+
+namespace {
+
+// Bounds of allocations of detection on a frame without logos
+constexpr auto MaxAllocationsPerFrame = std::size_t{64};
+constexpr auto MaxBytesPerPixel = std::size_t{16};
+
+// Calls after which both colour branches have been run first, so their order no longer changes
+constexpr auto CascadeWarmupCalls = 2;
+
+} //
+
+SCENARIO("Heap allocations can be counted", "[alloc_counter]")
+{
+    // Scopes are taken only around the code under test, as Catch allocates when entering sections
+    GIVEN("Allocation scope")
+    {
+        WHEN("Nothing is allocated")
+        {
+            const auto stats = []() {
+                const auto scope = AllocationScope{};
+                return scope.stats();
+            }();
+
+            THEN("No allocations should be counted")
+            {
+                REQUIRE(stats.count == 0);
+                REQUIRE(stats.bytes == 0);
+            }
+        }
+
+        WHEN("Vector is allocated with operator new")
+        {
+            auto values = std::vector<int>();
+            const auto stats = [&values]() {
+                const auto scope = AllocationScope{};
+                values.reserve(100);
+                return scope.stats();
+            }();
+
+            THEN("Its buffer should be counted")
+            {
+                REQUIRE(stats.count == 1);
+                REQUIRE(stats.bytes == 100 * sizeof(int));
+            }
+        }
+
+        WHEN("Matrix is created")
+        {
+            auto mat = cv::Mat_<uchar>();
+            const auto stats = [&mat]() {
+                const auto scope = AllocationScope{};
+                mat.create(cv::Size{64, 32});
+                return scope.stats();
+            }();
+
+            THEN("Its data buffer should be counted, even though it bypasses operator new")
+            {
+                REQUIRE(stats.count >= 1);
+                REQUIRE(stats.bytes >= 64 * 32);
+            }
+        }
+    }
+}
+
+SCENARIO("Detection allocates a bounded number of buffers per frame", "[alloc_counter]")
+{
+    const auto detector = PepsiDetector{};
+
+    GIVEN("Frame from a video stream")
+    {
+        auto frame = cv::Mat_<cv::Vec3b>(cv::Size{320, 240});
+        frame = cv::Vec3b{40, 40, 40};
+
+        WHEN("Finding logos twice, after order of colour branches has settled")
+        {
+            // Branch not measured yet is run first, and branches allocate different buffers
+            for(auto i = 0; i < CascadeWarmupCalls; ++i)
+            {
+                detector.find_logos(frame);
+            }
+
+            const auto first_stats = [&]() {
+                const auto scope = AllocationScope{};
+                detector.find_logos(frame);
+                return scope.stats();
+            }();
+
+            const auto second_stats = [&]() {
+                const auto scope = AllocationScope{};
+                detector.find_logos(frame);
+                return scope.stats();
+            }();
+
+            THEN("Second call should not allocate more than the first one")
+            {
+                REQUIRE(first_stats.count > 0);
+                REQUIRE(second_stats.count <= first_stats.count);
+                REQUIRE(second_stats.bytes <= first_stats.bytes);
+            }
+
+            THEN("Allocations should be limited to a few image buffers, not made per pixel or per row")
+            {
+                // Enhanced and HSV images take 3 bytes per pixel each, colour masks 1 byte each
+                const auto pixels = static_cast<std::size_t>(frame.total());
+                REQUIRE(second_stats.count <= MaxAllocationsPerFrame);
+                REQUIRE(second_stats.bytes <= MaxBytesPerPixel * pixels);
+            }
+        }
+    }
+}
@@ -0,0 +1,93 @@
+#include <catch2/catch.hpp>
+
+#include <filesystem>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+#include <nlohmann/json.hpp>
+
+#include "PepsiDetector.hpp"
+#include "test_support.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Written by "detector_bench corpus --logos-baseline" on the same directories
+const auto BASELINE_FILE = std::string("assets/baseline.json");
+const auto DIRECTORIES = std::vector<std::string>{"assets/camera", "assets/net"};
+
+using LogosByName = std::map<std::string, Logos>;
+
+LogosByName read_baseline(const std::string& path)
+{
+    const auto json = read_json_file(path);
+    auto baseline = LogosByName();
+    for(const auto& image : json.at("benchmarks"))
+    {
+        auto& logos = baseline[image.at("name").get<std::string>()];
+        for(const auto& logo : image.at("logos"))
+        {
+            logos.push_back(Logo{logo.at(0).get<int>(), logo.at(1).get<int>(),
+                                 logo.at(2).get<int>(), logo.at(3).get<int>()});
+        }
+    }
+
+    return baseline;
+}
+
+/**
+ * @brief Finds logos in each image of the directory, named as corpus benchmark names them
+ */
+void find_logos_in_directory(const fs::path& directory, LogosByName& found)
+{
+    const auto detector = PepsiDetector{read_config(directory / "config.json")};
+    for(const auto& entry : fs::directory_iterator(directory))
+    {
+        if(entry.path().extension() != ".jpg")
+        {
+            continue;
+        }
+
+        const auto img = cv::imread(entry.path().string(), cv::IMREAD_COLOR);
+        if(img.empty())
+        {
+            throw std::runtime_error("Could not read image file: " + entry.path().string());
+        }
+
+        found[entry.path().generic_string()] = detector.find_logos(img);
+    }
+}
+
+} //
+
+SCENARIO("Detections on assets are unchanged against committed baseline", "[baseline]")
+{
+    GIVEN("Baseline of logos found in each image of assets")
+    {
+        const auto baseline = read_baseline(BASELINE_FILE);
+
+        WHEN("Finding logos in each image of assets")
+        {
+            auto found = LogosByName();
+            for(const auto& directory : DIRECTORIES)
+            {
+                find_logos_in_directory(directory, found);
+            }
+
+            THEN("Each image should be in baseline, with exactly the same logos")
+            {
+                REQUIRE(found.size() == baseline.size());
+                for(const auto& [name, logos] : found)
+                {
+                    INFO("Image: " << name);
+                    REQUIRE(baseline.count(name) == 1);
+                    REQUIRE(logos == baseline.at(name));
+                }
+            }
+        }
+    }
+}
@@ -219,3 +219,29 @@ SCENARIO("Blobs can be extracted from the binary image", "[find_blobs]")
 		}
 	}
 }
+
+SCENARIO("Blobs can be extracted from region of binary image", "[find_blobs]")
+{
+	GIVEN("Two blobs, only one of them inside the region")
+	{
+		cv::Mat_<uchar> img = cv::Mat_<uchar>::zeros(cv::Size{16, 8});
+		img(cv::Rect{1, 1, 3, 3}) = 255;
+		img(cv::Rect{10, 2, 2, 4}) = 255;
+
+		const auto roi = cv::Rect{8, 0, 8, 8};
+		auto view = img(roi);
+
+		WHEN("Finding blobs in region view")
+		{
+			const auto blobs = find_blobs(view);
+
+			THEN("Only blob inside region should be returned, in region coordinates")
+			{
+				REQUIRE(!view.isContinuous());
+				REQUIRE(blobs.size() == 1);
+				REQUIRE(blobs.front().size() == 8);
+				REQUIRE(std::count(blobs.front().begin(), blobs.front().end(), cv::Point{2, 2}) == 1);
+			}
+		}
+	}
+}
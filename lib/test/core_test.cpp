@@ -103,6 +103,32 @@ SCENARIO("Color images can be thresholded from both sides", "[threshold]")
 	}
 }
 
+SCENARIO("Color images can be thresholded also inside regions of interest", "[threshold]")
+{
+	GIVEN("Image with 255's inside and zeros around the region")
+	{
+		auto img = cv::Mat_<cv::Vec3b>{cv::Size{12, 10}, cv::Vec3b{0, 0, 0}};
+		const auto roi = cv::Rect{2, 3, 6, 4};
+		img(roi) = cv::Vec3b{255, 255, 255};
+
+		WHEN("Thresholding region view in range [255,255,255] - [255,255,255]")
+		{
+			const auto src = img(roi);
+			auto dst_img = cv::Mat_<uchar>{img.size(), 0};
+			auto dst = dst_img(roi);
+			threshold(src, dst, ColorRange{cv::Vec3b{255, 255, 255}, cv::Vec3b{255, 255, 255}});
+
+			THEN("Only pixels inside region should be marked")
+			{
+				auto target = cv::Mat_<uchar>{img.size(), 0};
+				target(roi) = 255;
+				REQUIRE(!src.isContinuous());
+				REQUIRE(images_equal(dst_img, target));
+			}
+		}
+	}
+}
+
 SCENARIO("Images can be bitwise OR'ed", "[bitwise_or]")
 {
 	const auto size = cv::Size{8, 10};
@@ -197,3 +223,133 @@ SCENARIO("Images can be bitwise OR'ed", "[bitwise_or]")
 		}
 	}
 }
+
+SCENARIO("Color images can be downsampled by integer factor", "[downsample]")
+{
+	GIVEN("Uniform image")
+	{
+		const auto src = cv::Mat_<cv::Vec3b>{cv::Size{8, 6}, cv::Vec3b{10, 20, 30}};
+
+		WHEN("Downsampling it by 2")
+		{
+			auto dst = cv::Mat_<cv::Vec3b>{cv::Size{4, 3}};
+			downsample(src, dst, 2);
+
+			THEN("Result should be uniform too")
+			{
+				const auto target = cv::Mat_<cv::Vec3b>{dst.size(), cv::Vec3b{10, 20, 30}};
+				REQUIRE(images_equal(dst, target));
+			}
+		}
+	}
+
+	GIVEN("Image with vertical stripes")
+	{
+		auto src = cv::Mat_<cv::Vec3b>{cv::Size{9, 4}};
+		for(auto y = 0; y < src.rows; ++y)
+		{
+			for(auto x = 0; x < src.cols; ++x)
+			{
+				src(y, x) = (x % 2) ? cv::Vec3b{200, 200, 200} : cv::Vec3b{0, 0, 0};
+			}
+		}
+
+		WHEN("Downsampling it by 2")
+		{
+			auto dst = cv::Mat_<cv::Vec3b>{cv::Size{4, 2}};
+			downsample(src, dst, 2);
+
+			THEN("Stripes should be averaged and last column dropped")
+			{
+				const auto target = cv::Mat_<cv::Vec3b>{dst.size(), cv::Vec3b{100, 100, 100}};
+				REQUIRE(images_equal(dst, target));
+			}
+		}
+	}
+}
+
+SCENARIO("Images can be filtered also inside regions of interest", "[filter_image]")
+{
+	GIVEN("Random image and its region of interest")
+	{
+		auto img = cv::Mat_<cv::Vec3b>{cv::Size{16, 12}};
+		for(auto& v : img)
+		{
+			v = cv::Vec3b(rand() % 255, rand() % 255, rand() % 255);
+		}
+
+		const auto roi = cv::Rect{3, 2, 8, 7};
+		const auto view = img(roi);
+		const auto copy = view.clone();
+		const auto kernel = cv::Mat_<float>{cv::Size{3, 3}, 1.0f / 9};
+
+		WHEN("Filtering the view and the copy of region")
+		{
+			auto view_dst = cv::Mat_<cv::Vec3b>{roi.size()};
+			filter_image(view, view_dst, kernel);
+
+			auto copy_dst = cv::Mat_<cv::Vec3b>{roi.size()};
+			filter_image(copy, copy_dst, kernel);
+
+			THEN("Results should be the same")
+			{
+				REQUIRE(!view.isContinuous());
+				REQUIRE(images_equal(view_dst, copy_dst));
+			}
+		}
+	}
+}
+
+SCENARIO("Single pixels can be filtered the same as whole image", "[filter_image]")
+{
+	GIVEN("Random image")
+	{
+		auto img = cv::Mat_<cv::Vec3b>{cv::Size{9, 7}};
+		for(auto& v : img)
+		{
+			v = cv::Vec3b(rand() % 255, rand() % 255, rand() % 255);
+		}
+
+		auto kernel = cv::Mat_<float>{cv::Size{5, 5}, -1.0f / 16};
+		kernel(2, 2) = 2.5f;
+
+		WHEN("Filtering whole image")
+		{
+			auto dst = cv::Mat_<cv::Vec3b>{img.size()};
+			filter_image(img, dst, kernel);
+
+			THEN("Each pixel should be the same as filtered alone, also at borders")
+			{
+				for(auto y = 0; y < img.rows; ++y)
+				{
+					for(auto x = 0; x < img.cols; ++x)
+					{
+						REQUIRE(filter_pixel(img, cv::Point{x, y}, kernel) == dst(y, x));
+					}
+				}
+			}
+		}
+	}
+}
+
+SCENARIO("Red range wrapping around hue 0 can be split", "[get_red_ranges]")
+{
+	GIVEN("Red range with minimum hue above maximum one")
+	{
+		const auto red_range = ColorRange{cv::Vec3b{170, 80, 60}, cv::Vec3b{8, 255, 255}};
+
+		WHEN("Splitting it")
+		{
+			const auto red_ranges = get_red_ranges(red_range);
+
+			THEN("Left range should start at hue 0 and right one should end at hue 180")
+			{
+				REQUIRE(red_ranges.size() == 2);
+				REQUIRE(red_ranges[0].min == cv::Vec3b(0, 80, 60));
+				REQUIRE(red_ranges[0].max == cv::Vec3b(8, 255, 255));
+				REQUIRE(red_ranges[1].min == cv::Vec3b(170, 80, 60));
+				REQUIRE(red_ranges[1].max == cv::Vec3b(180, 255, 255));
+			}
+		}
+	}
+}
@@ -0,0 +1,72 @@
+#include <catch2/catch.hpp>
+
+#include <string>
+
+#include <opencv2/opencv.hpp>
+
+#include "PepsiDetector.hpp"
+#include "hash.hpp"
+
+SCENARIO("Bytes hash depends on every byte and on seed", "[hash]")
+{
+    GIVEN("Buffer longer than a block, with odd tail")
+    {
+        auto bytes = std::string(1000 + 7, 'x');
+        const auto hash = hash_bytes(bytes.data(), bytes.size());
+
+        THEN("Hash is repeatable")
+        {
+            REQUIRE(hash_bytes(bytes.data(), bytes.size()) == hash);
+        }
+
+        THEN("Changing any part changes the hash")
+        {
+            for(const auto index : {std::size_t{0}, std::size_t{500}, bytes.size() - 1})
+            {
+                auto changed = bytes;
+                changed[index] = 'y';
+                REQUIRE(hash_bytes(changed.data(), changed.size()) != hash);
+            }
+
+            REQUIRE(hash_bytes(bytes.data(), bytes.size() - 1) != hash);
+            REQUIRE(hash_bytes(bytes.data(), bytes.size(), 1) != hash);
+        }
+    }
+}
+
+SCENARIO("Image hash does not depend on rows padding", "[hash]")
+{
+    GIVEN("Image and its copy inside a wider image")
+    {
+        auto img = cv::Mat(48, 64, CV_8UC3);
+        cv::randu(img, cv::Scalar::all(0), cv::Scalar::all(256));
+
+        auto wider = cv::Mat(48, 80, CV_8UC3, cv::Scalar::all(0));
+        img.copyTo(wider(cv::Rect{0, 0, 64, 48}));
+        const auto view = wider(cv::Rect{0, 0, 64, 48});
+
+        THEN("Their hashes are equal")
+        {
+            REQUIRE(hash_image(view) == hash_image(img));
+        }
+
+        THEN("Hash of wider image differs")
+        {
+            REQUIRE(hash_image(wider) != hash_image(img));
+        }
+    }
+}
+
+SCENARIO("Config hash depends on its params", "[hash]")
+{
+    const auto config = PepsiDetector::Config{};
+
+    REQUIRE(PepsiDetector::Config{}.hash() == config.hash());
+    REQUIRE(config.scaled(0.5).hash() != config.hash());
+
+    auto pyramid = config;
+    pyramid.pyramid = true;
+    REQUIRE(pyramid.hash() != config.hash());
+
+    REQUIRE(PepsiDetector{pyramid}.config().hash() == pyramid.hash());
+}
@@ -0,0 +1,169 @@
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "imglog.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::size_t count_files(const fs::path& directory)
+{
+    return std::distance(fs::directory_iterator(directory), fs::directory_iterator());
+}
+
+} //
+
+SCENARIO("Stages images can be dumped to a directory", "[imglog]")
+{
+    const auto directory = (fs::temp_directory_path() / "imglog_test");
+    fs::remove_all(directory);
+
+    GIVEN("Dump backend sampling every second frame")
+    {
+        auto options = imglog::DumpOptions{};
+        options.directory = directory.string();
+        options.every_nth_frame = 2;
+        imglog::enable_dump(options);
+
+        WHEN("Logging two images on each of four frames")
+        {
+            for(auto frame = 0; frame < 4; ++frame)
+            {
+                imglog::begin_frame();
+                const auto mask = cv::Mat_<uchar>(cv::Size{16, 16}, uchar{255});
+                imglog::log("Mask", mask);
+                imglog::log("Rendered", cv::Mat_<uchar>(cv::Size{16, 16}, uchar{0}));
+            }
+
+            imglog::disable();
+
+            THEN("Only images of sampled frames should be written")
+            {
+                REQUIRE(imglog::dropped() == 0);
+                REQUIRE(count_files(directory) == 4);
+                REQUIRE(fs::exists(directory / "000000_00_Mask.png"));
+                REQUIRE(fs::exists(directory / "000002_01_Rendered.png"));
+            }
+        }
+
+        imglog::disable();
+    }
+
+    fs::remove_all(directory);
+}
+
+SCENARIO("Frames begun on different threads are dumped apart", "[imglog]")
+{
+    const auto directory = (fs::temp_directory_path() / "imglog_threads_test");
+    fs::remove_all(directory);
+
+    GIVEN("Dump backend logging every frame")
+    {
+        auto options = imglog::DumpOptions{};
+        options.directory = directory.string();
+        options.queue_size = 64;
+        imglog::enable_dump(options);
+
+        WHEN("Logging two images on each of four frames on each of two threads")
+        {
+            const auto log_frames = []() {
+                for(auto frame = 0; frame < 4; ++frame)
+                {
+                    imglog::begin_frame();
+                    imglog::log("Mask", cv::Mat_<uchar>(cv::Size{16, 16}, uchar{255}));
+                    imglog::log("Rendered", cv::Mat_<uchar>(cv::Size{16, 16}, uchar{0}));
+                }
+            };
+
+            auto threads = std::vector<std::thread>();
+            threads.emplace_back(log_frames);
+            threads.emplace_back(log_frames);
+            for(auto& thread : threads)
+            {
+                thread.join();
+            }
+
+            imglog::disable();
+
+            THEN("Each frame should have its own prefix, with images numbered within it")
+            {
+                REQUIRE(imglog::dropped() == 0);
+                REQUIRE(count_files(directory) == 16);
+                for(auto frame = 0; frame < 8; ++frame)
+                {
+                    const auto prefix = "00000" + std::to_string(frame);
+                    REQUIRE(fs::exists(directory / (prefix + "_00_Mask.png")));
+                    REQUIRE(fs::exists(directory / (prefix + "_01_Rendered.png")));
+                }
+            }
+        }
+
+        imglog::disable();
+    }
+
+    fs::remove_all(directory);
+}
+
+SCENARIO("Dump backend can be disabled while images are logged on other thread", "[imglog]")
+{
+    const auto directory = (fs::temp_directory_path() / "imglog_concurrent_test");
+    fs::remove_all(directory);
+
+    GIVEN("Thread logging images to dump backend")
+    {
+        auto options = imglog::DumpOptions{};
+        options.directory = directory.string();
+        imglog::enable_dump(options);
+
+        auto stop = std::atomic<bool>{false};
+        auto logged = std::atomic<std::size_t>{0};
+        auto thread = std::thread([&stop, &logged]() {
+            const auto mask = cv::Mat_<uchar>(cv::Size{16, 16}, uchar{255});
+            while(!stop)
+            {
+                imglog::begin_frame();
+                imglog::log("Mask", mask);
+                ++logged;
+            }
+        });
+
+        WHEN("Disabling it and enabling again")
+        {
+            while(logged < 8)
+            {
+                std::this_thread::yield();
+            }
+
+            imglog::disable();
+            imglog::enable_dump(options);
+            imglog::disable();
+
+            stop = true;
+            thread.join();
+
+            THEN("Logging thread should not be affected, and images should be written")
+            {
+                REQUIRE(!imglog::enabled());
+                REQUIRE(count_files(directory) > 0);
+            }
+        }
+
+        stop = true;
+        if(thread.joinable())
+        {
+            thread.join();
+        }
+
+        imglog::disable();
+    }
+
+    fs::remove_all(directory);
+}
@@ -4,27 +4,189 @@
 
 #include "moments.hpp"
 
+namespace {
+
+/**
+ * @brief Returns blob filling rectangle with given top left corner and size
+ */
+Blob make_rect_blob(cv::Point top_left, cv::Size size)
+{
+	auto blob = Blob();
+	for(auto y = 0; y < size.height; ++y)
+	{
+		for(auto x = 0; x < size.width; ++x)
+		{
+			blob.emplace_back(top_left.x + x, top_left.y + y);
+		}
+	}
+
+	return blob;
+}
+
+/**
+ * @brief Returns asymmetric L-shaped blob, with longer arm along x
+ */
+Blob make_l_blob(cv::Point top_left)
+{
+	auto blob = make_rect_blob(top_left, cv::Size{3, 9});
+	const auto arm = make_rect_blob(top_left + cv::Point{3, 6}, cv::Size{11, 3});
+	blob.insert(blob.end(), arm.begin(), arm.end());
+	return blob;
+}
+
+Blob shift_blob(Blob blob, cv::Point offset)
+{
+	for(auto& point : blob)
+	{
+		point += offset;
+	}
+
+	return blob;
+}
+
+Blob transpose_blob(Blob blob)
+{
+	for(auto& point : blob)
+	{
+		point = cv::Point{point.y, point.x};
+	}
+
+	return blob;
+}
+
+} //
+
 SCENARIO("Spatial moments can be calculated from blob", "[calc_spatial_moments]")
 {
+	GIVEN("Blob filling rectangle 2x3 at (1, 2)")
+	{
+		const auto blob = make_rect_blob(cv::Point{1, 2}, cv::Size{2, 3});
+
+		WHEN("Calculating spatial moments")
+		{
+			const auto spatial = calc_spatial_moments(blob);
 
+			THEN("They should be sums of powers of coordinates")
+			{
+				REQUIRE(spatial.m00 == 6);
+				REQUIRE(spatial.m10 == 9);
+				REQUIRE(spatial.m01 == 18);
+				REQUIRE(spatial.m20 == 15);
+				REQUIRE(spatial.m11 == 27);
+				REQUIRE(spatial.m02 == 58);
+				REQUIRE(spatial.m30 == 27);
+				REQUIRE(spatial.m21 == 45);
+				REQUIRE(spatial.m12 == 87);
+				REQUIRE(spatial.m03 == 198);
+			}
+		}
+	}
 }
 
 SCENARIO("Centroid can be calculated from arleady calculated spatial moments", "[calc_centroid]")
 {
+	const auto blob = make_rect_blob(cv::Point{1, 2}, cv::Size{2, 3});
+	const auto centroid = calc_centroid(calc_spatial_moments(blob));
 
+	REQUIRE(centroid.x == 1.5);
+	REQUIRE(centroid.y == 3.0);
 }
 
-SCENARIO("Central moments can be calculated from blob and centroid", "[calc_central_moments]")
+SCENARIO("Central moments can be calculated exactly from blob", "[calc_central_moments]")
 {
+	GIVEN("Blob filling rectangle 2x3")
+	{
+		const auto central = calc_central_moments(make_rect_blob(cv::Point{1, 2}, cv::Size{2, 3}));
+
+		THEN("Second order moments should be exact and odd ones should be zero")
+		{
+			REQUIRE(central.mu20 == 1.5);
+			REQUIRE(central.mu02 == 4.0);
+			REQUIRE(central.mu11 == 0.0);
+			REQUIRE(central.mu30 == 0.0);
+			REQUIRE(central.mu21 == 0.0);
+			REQUIRE(central.mu12 == 0.0);
+			REQUIRE(central.mu03 == 0.0);
+		}
+	}
 
+	GIVEN("Asymmetric blob")
+	{
+		const auto blob = make_l_blob(cv::Point{10, 20});
+		const auto central = calc_central_moments(blob);
+
+		THEN("Moments should match sums of powers of coordinates relative to centroid")
+		{
+			const auto centroid = calc_centroid(calc_spatial_moments(blob));
+			auto mu20 = 0.0;
+			auto mu11 = 0.0;
+			auto mu30 = 0.0;
+			auto mu21 = 0.0;
+			for(const auto point : blob)
+			{
+				const auto dx = (point.x - centroid.x);
+				const auto dy = (point.y - centroid.y);
+				mu20 += (dx * dx);
+				mu11 += (dx * dy);
+				mu30 += (dx * dx * dx);
+				mu21 += (dx * dx * dy);
+			}
+
+			REQUIRE(central.mu20 == Approx(mu20));
+			REQUIRE(central.mu11 == Approx(mu11));
+			REQUIRE(central.mu30 == Approx(mu30));
+			REQUIRE(central.mu21 == Approx(mu21));
+		}
+
+		THEN("Moments should not depend on blob position, even far from origin")
+		{
+			const auto shifted = calc_central_moments(shift_blob(blob, cv::Point{100000, 200000}));
+
+			REQUIRE(shifted.mu20 == central.mu20);
+			REQUIRE(shifted.mu11 == central.mu11);
+			REQUIRE(shifted.mu02 == central.mu02);
+			REQUIRE(shifted.mu30 == central.mu30);
+			REQUIRE(shifted.mu21 == central.mu21);
+			REQUIRE(shifted.mu12 == central.mu12);
+			REQUIRE(shifted.mu03 == central.mu03);
+		}
+	}
 }
 
 SCENARIO("Normalized moments can be calculated from arleady calculated central moments and M00 spatial moment", "[calc_normalized_moments]")
 {
+	const auto central = CentralMoments{32.0, 0.0, 64.0, 128.0, 0.0, 0.0, -128.0};
+	const auto normalized = calc_normalized_moments(central, 4);
 
+	REQUIRE(normalized.nu20 == 2.0);
+	REQUIRE(normalized.nu02 == 4.0);
+	REQUIRE(normalized.nu11 == 0.0);
+	REQUIRE(normalized.nu30 == 4.0);
+	REQUIRE(normalized.nu03 == -4.0);
 }
 
 SCENARIO("Hu moments can be calculated from arleady calculated normalized moments", "[calc_hu_moments]")
 {
+	GIVEN("Asymmetric blob")
+	{
+		const auto blob = make_l_blob(cv::Point{0, 0});
+		const auto hu = calc_blob_hu_moments(blob);
+
+		THEN("The first two Hu moments should follow from normalized moments")
+		{
+			const auto spatial = calc_spatial_moments(blob);
+			const auto normalized = calc_normalized_moments(calc_central_moments(blob), spatial.m00);
+			const auto diff = (normalized.nu20 - normalized.nu02);
+
+			REQUIRE(hu[0] == Approx(normalized.nu20 + normalized.nu02));
+			REQUIRE(hu[1] == Approx(diff * diff + 4 * normalized.nu11 * normalized.nu11));
+		}
 
+		THEN("Hu moments should be exactly the same for blob moved and transposed")
+		{
+			REQUIRE(calc_blob_hu_moments(shift_blob(blob, cv::Point{5000, 3000})) == hu);
+			REQUIRE(calc_blob_hu_moments(transpose_blob(blob))[0] == hu[0]);
+			REQUIRE(calc_blob_hu_moments(transpose_blob(blob))[1] == hu[1]);
+		}
+	}
 }
@@ -244,3 +244,31 @@ SCENARIO("Morphological operations can be applied to binary images", "[morpho]")
 		}
 	}
 }
+
+SCENARIO("Morphological operations can be applied inside regions of interest", "[morpho]")
+{
+	const auto kernel = cv::Mat_<uchar>{cv::Size{3, 3}, 255};
+
+	GIVEN("White region surrounded by black image")
+	{
+		auto img = cv::Mat_<uchar>{cv::Size{12, 12}, 0};
+		const auto roi = cv::Rect{2, 2, 8, 8};
+		img(roi) = 255;
+
+		WHEN("Eroding region view with square 3x3 kernel")
+		{
+			const auto src = img(roi);
+			auto dst_img = cv::Mat_<uchar>{img.size(), 0};
+			auto dst = dst_img(roi);
+			erode(src, dst, kernel);
+
+			THEN("Pixels outside of view should not be taken into account")
+			{
+				auto target = cv::Mat_<uchar>{img.size(), 0};
+				target(roi) = 255;
+				REQUIRE(!src.isContinuous());
+				REQUIRE(images_equal(dst_img, target));
+			}
+		}
+	}
+}
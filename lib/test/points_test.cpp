@@ -0,0 +1,104 @@
+#include "catch2/catch.hpp"
+
+#include "points.hpp"
+
+SCENARIO("Rectangles can be expanded within image bounds", "[expand_rect]")
+{
+	const auto bounds = cv::Size{100, 80};
+
+	GIVEN("Rectangle inside an image")
+	{
+		const auto rect = Rect{20, 20, 10, 10};
+
+		WHEN("Expanding it by margin")
+		{
+			const auto expanded = expand_rect(rect, 5, bounds);
+
+			THEN("Margin should be added on each side")
+			{
+				REQUIRE(expanded == Rect{15, 15, 20, 20});
+			}
+		}
+	}
+
+	GIVEN("Rectangle near image corner")
+	{
+		const auto rect = Rect{95, 2, 5, 5};
+
+		WHEN("Expanding it by margin")
+		{
+			const auto expanded = expand_rect(rect, 10, bounds);
+
+			THEN("Result should be clipped to image bounds")
+			{
+				REQUIRE(expanded == Rect{85, 0, 15, 17});
+			}
+		}
+	}
+}
+
+SCENARIO("Rectangles can be mapped from downsampled image", "[scale_rects]")
+{
+	GIVEN("Rectangles found on image downsampled by 4")
+	{
+		const auto rects = Rects{Rect{0, 0, 1, 1}, Rect{10, 5, 20, 30}};
+
+		WHEN("Scaling them")
+		{
+			const auto scaled = scale_rects(rects, 4);
+
+			THEN("Positions and sizes should be multiplied by factor")
+			{
+				REQUIRE(scaled == Rects{Rect{0, 0, 4, 4}, Rect{40, 20, 80, 120}});
+			}
+		}
+	}
+}
+
+SCENARIO("Overlapping rectangles can be merged", "[merge_overlapping_rects]")
+{
+	GIVEN("Disjoint rectangles")
+	{
+		const auto rects = Rects{Rect{0, 0, 10, 10}, Rect{20, 20, 10, 10}};
+
+		WHEN("Merging them")
+		{
+			const auto merged = merge_overlapping_rects(rects);
+
+			THEN("They should be left unchanged")
+			{
+				REQUIRE(merged == rects);
+			}
+		}
+	}
+
+	GIVEN("Chain of overlapping rectangles")
+	{
+		const auto rects = Rects{Rect{0, 0, 10, 10}, Rect{30, 0, 10, 10}, Rect{5, 5, 30, 2}};
+
+		WHEN("Merging them")
+		{
+			const auto merged = merge_overlapping_rects(rects);
+
+			THEN("Single bounding rectangle should be returned")
+			{
+				REQUIRE(merged == Rects{Rect{0, 0, 40, 10}});
+			}
+		}
+	}
+
+	GIVEN("Empty rectangles")
+	{
+		const auto rects = Rects{Rect{}, Rect{0, 0, 10, 10}};
+
+		WHEN("Merging them")
+		{
+			const auto merged = merge_overlapping_rects(rects);
+
+			THEN("Empty rectangles should be dropped")
+			{
+				REQUIRE(merged == Rects{Rect{0, 0, 10, 10}});
+			}
+		}
+	}
+}
@@ -0,0 +1,60 @@
+#include "catch2/catch.hpp"
+
+#include "presence.hpp"
+
+SCENARIO("Colors can be counted on sparse grid of pixels", "[presence]")
+{
+	const auto blue = ColorRanges{ColorRange{{100, 75, 0}, {130, 255, 255}}};
+	const auto red = ColorRanges{ColorRange{{0, 75, 75}, {10, 255, 255}}, ColorRange{{165, 75, 75}, {180, 255, 255}}};
+
+	GIVEN("Grey image")
+	{
+		auto img = cv::Mat_<cv::Vec3b>{cv::Size{20, 10}};
+		for(auto& v : img)
+		{
+			v = cv::Vec3b{128, 128, 128};
+		}
+
+		WHEN("Counting blue and red pixels")
+		{
+			const auto counts = count_grid_colors(img, 8, nullptr, {blue, red});
+
+			THEN("None should be found")
+			{
+				REQUIRE(counts == std::vector<std::size_t>{0, 0});
+			}
+		}
+
+		WHEN("Image has red pixels only in the last row and column")
+		{
+			for(auto y = 0; y < img.rows; ++y)
+			{
+				img(y, img.cols - 1) = cv::Vec3b{0, 0, 255};
+			}
+
+			for(auto x = 0; x < img.cols; ++x)
+			{
+				img(img.rows - 1, x) = cv::Vec3b{0, 0, 255};
+			}
+
+			const auto counts = count_grid_colors(img, 8, nullptr, {blue, red});
+
+			THEN("Pixels of the last row and column should be sampled too")
+			{
+				// Grid columns are 0, 8, 16 and 19, rows are 0, 8 and 9
+				REQUIRE(counts[0] == 0);
+				REQUIRE(counts[1] == (4 + 2));
+			}
+		}
+	}
+}
+
+SCENARIO("Precheck modes can be parsed from their names", "[presence]")
+{
+	for(const auto mode : {PrecheckMode::Off, PrecheckMode::Estimate, PrecheckMode::Guarantee})
+	{
+		REQUIRE(parse_precheck_mode(get_precheck_mode_name(mode)) == mode);
+	}
+
+	REQUIRE_THROWS(parse_precheck_mode("sometimes"));
+}
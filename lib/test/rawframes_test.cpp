@@ -0,0 +1,97 @@
+#include <catch2/catch.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <filesystem>
+#include <fstream>
+
+#include <opencv2/opencv.hpp>
+
+#include "core.hpp"
+#include "rawframes.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+cv::Mat make_random_image(cv::Size size)
+{
+    auto img = cv::Mat(size, CV_8UC3);
+    cv::randu(img, cv::Scalar::all(0), cv::Scalar::all(256));
+    return img;
+}
+
+} //
+
+SCENARIO("Frames can be stored in raw container and mapped back", "[rawframes]")
+{
+    const auto path = (fs::temp_directory_path() / "rawframes_test.frames").string();
+
+    GIVEN("Frames of different sizes")
+    {
+        const auto frames = std::vector<RawFrame>{
+            RawFrame{"assets/camera/0.jpg", make_random_image(cv::Size{64, 48})},
+            RawFrame{"assets/camera/1.jpg", make_random_image(cv::Size{48, 64})},
+            RawFrame{"small", make_random_image(cv::Size{5, 3})},
+        };
+
+        WHEN("Writing them and mapping the file")
+        {
+            write_raw_frames(path, frames);
+            const auto file = RawFramesFile{path};
+
+            THEN("All frames should be read back with their names")
+            {
+                REQUIRE(file.size() == frames.size());
+                for(auto i = std::size_t{0}; i < frames.size(); ++i)
+                {
+                    const auto frame = file.frame(i);
+                    REQUIRE(file.frame_name(i) == frames[i].name);
+                    REQUIRE(frame.size() == frames[i].img.size());
+                    REQUIRE(images_equal(frame, frames[i].img));
+                }
+            }
+
+            THEN("Frames should start at aligned addresses, without copying")
+            {
+                for(auto i = std::size_t{0}; i < frames.size(); ++i)
+                {
+                    const auto frame = file.frame(i);
+                    REQUIRE(reinterpret_cast<std::uintptr_t>(frame.data) % RawFramesAlignment == 0);
+                    REQUIRE(frame.data == file.frame(i).data);
+                }
+            }
+        }
+    }
+
+    GIVEN("Raw frames file, which frames count wraps around its size")
+    {
+        write_raw_frames(path, std::vector<RawFrame>{RawFrame{"small", make_random_image(cv::Size{5, 3})}});
+        {
+            // Both index and frames sizes of that many frames are multiples of 2^64
+            const auto frames_count = (std::uint64_t{1} << 63);
+            auto ofs = std::fstream(path, std::ios::binary | std::ios::in | std::ios::out);
+            ofs.seekp(offsetof(RawFramesHeader, frames_count));
+            ofs.write(reinterpret_cast<const char*>(&frames_count), sizeof(frames_count));
+        }
+
+        THEN("Opening it should fail")
+        {
+            REQUIRE_THROWS(RawFramesFile{path});
+        }
+    }
+
+    GIVEN("File, which is not a raw frames container")
+    {
+        {
+            auto ofs = std::ofstream(path, std::ios::binary);
+            ofs << std::string(sizeof(RawFramesHeader) * 2, 'x');
+        }
+
+        THEN("Opening it should fail")
+        {
+            REQUIRE_THROWS(RawFramesFile{path});
+        }
+    }
+}
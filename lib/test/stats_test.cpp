@@ -0,0 +1,84 @@
+#include <catch2/catch.hpp>
+
+#include "stats.hpp"
+
+namespace {
+
+DetectionStats make_stats(int total_ms)
+{
+    auto stats = DetectionStats{};
+    stats.total_time = std::chrono::milliseconds{total_ms};
+    stats.stage_time(Stage::Threshold) = std::chrono::milliseconds{total_ms / 2};
+    stats.blue_blobs.found = 3;
+    stats.logos_found = 1;
+    return stats;
+}
+
+} //
+
+SCENARIO("Detection statistics can be aggregated", "[DetectionStatsAggregator]")
+{
+    GIVEN("Aggregator without statistics")
+    {
+        const auto aggregator = DetectionStatsAggregator{};
+
+        WHEN("Summarizing total time")
+        {
+            const auto summary = aggregator.summarize_total();
+
+            THEN("Summary should be zeroed")
+            {
+                REQUIRE(aggregator.count() == 0);
+                REQUIRE(summary.min == StageTime{0});
+                REQUIRE(summary.mean == StageTime{0});
+                REQUIRE(summary.p99 == StageTime{0});
+            }
+        }
+    }
+
+    GIVEN("Statistics of hundred calls, with one outlier")
+    {
+        auto aggregator = DetectionStatsAggregator{};
+        for(auto i = 0; i < 99; ++i)
+        {
+            aggregator.add(make_stats(10));
+        }
+        aggregator.add(make_stats(1010));
+
+        WHEN("Summarizing total time")
+        {
+            const auto summary = aggregator.summarize_total();
+
+            THEN("Min and p99 should skip the outlier, but mean should not")
+            {
+                REQUIRE(aggregator.count() == 100);
+                REQUIRE(summary.min == std::chrono::milliseconds{10});
+                REQUIRE(summary.p99 == std::chrono::milliseconds{10});
+                REQUIRE(summary.mean == std::chrono::milliseconds{20});
+            }
+        }
+
+        WHEN("Summarizing single stage")
+        {
+            const auto summary = aggregator.summarize_stage(Stage::Threshold);
+
+            THEN("Only that stage times should be used")
+            {
+                REQUIRE(summary.min == std::chrono::milliseconds{5});
+                REQUIRE(summary.mean == std::chrono::milliseconds{10});
+            }
+        }
+
+        WHEN("Summing statistics")
+        {
+            const auto sum = aggregator.sum();
+
+            THEN("Counters should be summed")
+            {
+                REQUIRE(sum.blue_blobs.found == 300);
+                REQUIRE(sum.logos_found == 100);
+                REQUIRE(sum.total_time == std::chrono::milliseconds{2000});
+            }
+        }
+    }
+}
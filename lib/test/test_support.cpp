@@ -0,0 +1,26 @@
+#include "test_support.hpp"
+
+#include <fstream>
+#include <stdexcept>
+
+nlohmann::json read_json_file(const std::filesystem::path& path)
+{
+    std::ifstream ifs(path);
+    if(!ifs)
+    {
+        throw std::runtime_error("Could not open JSON file: " + path.string());
+    }
+
+    nlohmann::json json;
+    if(!(ifs >> json))
+    {
+        throw std::runtime_error("Could not read JSON file: " + path.string());
+    }
+
+    return json;
+}
+
+PepsiDetector::Config read_config(const std::filesystem::path& path)
+{
+    return PepsiDetector::Config::from_json(read_json_file(path));
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <filesystem>
+
+#include <nlohmann/json.hpp>
+
+#include "PepsiDetector.hpp"
+
+/**
+ * @brief Reads JSON file, e.g. detector config or baseline of found logos
+ */
+nlohmann::json read_json_file(const std::filesystem::path& path);
+
+/**
+ * @brief Reads detector config from JSON file, as used by tests and benchmarks
+ */
+PepsiDetector::Config read_config(const std::filesystem::path& path);
@@ -0,0 +1,76 @@
+#include <catch2/catch.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <thread>
+
+#include <nlohmann/json.hpp>
+
+#include "trace.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+nlohmann::json read_trace(const fs::path& trace_file)
+{
+    auto ifs = std::ifstream(trace_file);
+    nlohmann::json json;
+    ifs >> json;
+    return json;
+}
+
+} //
+
+SCENARIO("Spans can be traced across threads", "[trace]")
+{
+    const auto trace_file = (fs::temp_directory_path() / "trace_test.json");
+
+    GIVEN("Enabled tracer")
+    {
+        trace::enable();
+
+        WHEN("Recording spans on two threads")
+        {
+            {
+                const auto outer = trace::Span{"outer"};
+                const auto inner = trace::Span{"inner"};
+            }
+
+            auto worker = std::thread([]() {
+                trace::set_thread_name("worker");
+                const auto span = trace::Span{"work"};
+            });
+            worker.join();
+
+            trace::disable();
+            {
+                const auto ignored = trace::Span{"ignored"};
+            }
+
+            trace::write(trace_file.string());
+
+            THEN("Trace should contain all spans recorded while enabled, with thread ids")
+            {
+                const auto json = read_trace(trace_file);
+                auto names = std::set<std::string>();
+                auto tids = std::set<int>();
+                for(const auto& event : json.at("traceEvents"))
+                {
+                    if(event.at("ph") == "X")
+                    {
+                        names.insert(event.at("name").get<std::string>());
+                        tids.insert(event.at("tid").get<int>());
+                        REQUIRE(event.at("dur").get<double>() >= 0.0);
+                    }
+                }
+
+                REQUIRE(names == std::set<std::string>{"outer", "inner", "work"});
+                REQUIRE(tids.size() == 2);
+            }
+        }
+    }
+
+    fs::remove(trace_file);
+}